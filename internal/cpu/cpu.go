@@ -0,0 +1,28 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package cpu implements detection of the instruction set extensions
+// supported by the cpu, which are used to select optimized code paths.
+package cpu
+
+// features supported by the cpu, which are detected during initialization
+var (
+	// HasAVX2 reports whether the cpu and the operating
+	// system support the avx2 vector instructions.
+	HasAVX2 bool
+
+	// HasFastBMI2 reports whether the cpu supports the bmi2 instructions,
+	// and doesn't implement pdep and pext in slow microcode, which is the
+	// case for amd cpus before zen 3.
+	HasFastBMI2 bool
+)
@@ -0,0 +1,46 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package cpu
+
+func init() {
+	maxID, vendor, _, _ := cpuid(0, 0)
+	if maxID < 7 {
+		return
+	}
+
+	eax, _, ecx, _ := cpuid(1, 0)
+	_, ebx, _, _ := cpuid(7, 0)
+
+	// the cpu should support avx, and the os should save the ymm registers
+	const osxsave, avx = 1 << 27, 1 << 28
+	if ecx&osxsave != 0 && ecx&avx != 0 {
+		xcr0, _ := xgetbv()
+		HasAVX2 = xcr0&0b110 == 0b110 && ebx&(1<<5) != 0
+	}
+
+	// amd cpus before zen 3 (family 0x19) have microcoded pdep and pext
+	const authenticAMD = 0x68747541 // "Auth"
+	family := (eax >> 8) & 0xf
+	if family == 0xf {
+		family += (eax >> 20) & 0xff
+	}
+
+	HasFastBMI2 = ebx&(1<<8) != 0 && (vendor != authenticAMD || family >= 0x19)
+}
+
+// cpuid executes the cpuid instruction with the given leaf and sub-leaf.
+func cpuid(eaxArg, ecxArg uint32) (eax, ebx, ecx, edx uint32)
+
+// xgetbv returns the contents of the xcr0 register.
+func xgetbv() (eax, edx uint32)
@@ -15,6 +15,7 @@ package cmd
 
 import (
 	"errors"
+	"fmt"
 	"math"
 	"strconv"
 
@@ -22,6 +23,7 @@ import (
 	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/board/piece"
 	"laptudirm.com/x/mess/pkg/search"
+	"laptudirm.com/x/mess/pkg/search/eval"
 	"laptudirm.com/x/mess/pkg/uci/cmd"
 	"laptudirm.com/x/mess/pkg/uci/flag"
 )
@@ -35,14 +37,14 @@ import (
 // sent in the same string. If one command is not sent its value should be
 // interpreted as it would not influence the search.
 //
-// searchmoves move... [not implemented]
+// searchmoves move...
 //
 //	restrict search to this moves only
 //	Example: After position startpos and go infinite searchmoves e2e4
 //	d2d4 the engine should only search the two moves e2e4 and d2d4 in
 //	the initial position.
 //
-// ponder [not implemented]
+// ponder
 //
 //	Start searching in pondering mode.
 //	Do not exit the search in ponder mode, even if it's mate!
@@ -85,7 +87,7 @@ import (
 //
 //	search x nodes only,
 //
-// mate x [not implemented]
+// mate x
 //
 //	search for a mate in x moves
 //
@@ -99,7 +101,7 @@ import (
 func NewGo(engine *context.Engine) cmd.Command {
 	schema := flag.NewSchema()
 
-	// schema.Variadic("searchmoves")
+	schema.List("searchmoves")
 	schema.Button("ponder")
 	schema.Single("wtime")
 	schema.Single("btime")
@@ -108,7 +110,7 @@ func NewGo(engine *context.Engine) cmd.Command {
 	schema.Single("movestogo")
 	schema.Single("depth")
 	schema.Single("nodes")
-	// schema.Single("mate")
+	schema.Single("mate")
 	schema.Single("movetime")
 	schema.Button("infinite")
 
@@ -126,33 +128,45 @@ func NewGo(engine *context.Engine) cmd.Command {
 				return err
 			}
 
+			// play book moves instantly, except in searches which have
+			// to wait for a stop or are restricted to some root moves
+			if !interaction.Values["ponder"].Set && !limits.Infinite && len(limits.Moves) == 0 {
+				if bookMove, found := probeBook(engine); found {
+					interaction.Replyf("bestmove %s", bookMove)
+					return nil
+				}
+			}
+
 			// ponder search
 			if interaction.Values["ponder"].Set {
 				if !engine.Options.Ponder {
 					return errors.New("go ponder: pondering is disabled")
 				}
 
-				engine.Pondering = true
+				engine.Pondering.Store(true)
 
-				// store search limits for later
+				// store search limits for the ponderhit, which switches
+				// the search to them while keeping it's state intact
 				engine.PonderLimits = limits
 
-				// for now, start an infinite search
-				limits = search.Limits{
-					Depth:    search.MaxDepth,
-					Nodes:    math.MaxInt,
-					Infinite: true,
-				}
+				// until then, search the position after the ponder move
+				// as an infinite search, which is stopped on a miss
+				limits.Infinite = true
 			}
 
 			// start searching
-			engine.Searching = true
+			engine.Searching.Store(true)
 
 			if interaction.Parallelize {
-				// command should be parallelized: new goroutine
-				go searchPosition(limits, engine, interaction)
+				// command should be parallelized: search in a new goroutine,
+				// which has started when SearchAsync returns, so that the
+				// stop and ponderhit commands can act on it immediately
+				engine.Search.SearchAsync(limits, func(pv move.Variation, _ eval.Eval, err error) {
+					reportBestMove(pv, err, engine, interaction)
+				})
 			} else {
-				searchPosition(limits, engine, interaction)
+				pv, _, err := engine.Search.Search(limits)
+				reportBestMove(pv, err, engine, interaction)
 			}
 
 			return nil
@@ -162,22 +176,36 @@ func NewGo(engine *context.Engine) cmd.Command {
 	}
 }
 
-func searchPosition(limits search.Limits, engine *context.Engine, interaction cmd.Interaction) {
+// probeBook returns a move from the opening book for the current position,
+// if the engine's own book is enabled and has a move for it.
+func probeBook(engine *context.Engine) (move.Move, bool) {
+	if !engine.Options.OwnBook || engine.Book == nil {
+		return move.Null, false
+	}
+
+	return engine.Book.Probe(engine.Search.Board())
+}
+
+// reportBestMove reports the result of a finished search to the gui.
+func reportBestMove(pv move.Variation, err error, engine *context.Engine, interaction cmd.Interaction) {
 	defer func() {
 		// set search booleans to false
 		// since the search has ended
-		engine.Searching = false
-		engine.Pondering = false
+		engine.Searching.Store(false)
+		engine.Pondering.Store(false)
 	}()
 
-	// start search
-	pv, _, err := engine.Search.Search(limits)
 	if err != nil {
 		interaction.Reply(err)
 		return
 	}
 
-	if bestMove, ponderMove := pv.Move(0), pv.Move(1); ponderMove == move.Null {
+	if search.CountersEnabled {
+		// report search counters, only collected with the stats build tag
+		interaction.Replyf("info string counters %s", engine.Search.Counters())
+	}
+
+	if bestMove, ponderMove := pv.Move(0), engine.Search.PonderMove(pv); ponderMove == move.Null {
 		// just print bestmove since pondermove is null
 		interaction.Replyf("bestmove %s", bestMove)
 	} else {
@@ -204,6 +232,33 @@ func parseSearchLimits(engine *context.Engine, values flag.Values) (search.Limit
 		limits.Nodes = n
 	}
 
+	// mate limit (default none)
+	if mate := values["mate"]; mate.Set {
+		m, err := strconv.Atoi(mate.Value.(string))
+		if err != nil || m <= 0 {
+			return limits, errors.New("go mate: invalid number of moves")
+		}
+
+		limits.Mate = m
+	}
+
+	// root move restriction (default all moves)
+	if searchMoves := values["searchmoves"]; searchMoves.Set {
+		legal := engine.Search.Board().GenerateMoves(false)
+
+	parseMoves:
+		for _, s := range searchMoves.Value.([]string) {
+			for _, m := range legal {
+				if m.String() == s {
+					limits.Moves = append(limits.Moves, m)
+					continue parseMoves
+				}
+			}
+
+			return limits, fmt.Errorf("go searchmoves: illegal move %q", s)
+		}
+	}
+
 	// check if wtime-btime controls are set
 	timeSet := false
 	if values["wtime"].Set || values["btime"].Set {
@@ -0,0 +1,104 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package cmd
+
+import (
+	"errors"
+	"strconv"
+	realtime "time"
+
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/uci/cmd"
+	"laptudirm.com/x/mess/pkg/uci/flag"
+)
+
+// Custom command perft [flags]
+//
+// The perft command counts the number of leaf nodes of the legal move tree
+// of the current position, and prints the node count of every root move
+// (divide), along with the total node count and nodes per second. It is
+// used to verify and benchmark the move generator.
+//
+// depth x
+//
+//	count the nodes of the tree of depth x, this flag is required
+//
+// threads x
+//
+//	split the root moves among x threads, defaults to the Threads option
+//
+// hash x
+//
+//	use a perft hash table of x MB, defaults to 0 (no hashing)
+func NewPerft(engine *context.Engine) cmd.Command {
+	schema := flag.NewSchema()
+
+	schema.Single("depth")
+	schema.Single("threads")
+	schema.Single("hash")
+
+	return cmd.Command{
+		Name: "perft",
+		Run: func(interaction cmd.Interaction) error {
+			if engine.Search.InProgress() {
+				// the board is being used by the search
+				return errors.New("perft: search currently in progress")
+			}
+
+			if !interaction.Values["depth"].Set {
+				return errors.New("perft: depth flag not provided")
+			}
+
+			depth, err := strconv.Atoi(interaction.Values["depth"].Value.(string))
+			if err != nil {
+				return err
+			}
+
+			config := board.PerftConfig{Threads: engine.Options.Threads}
+
+			if threads := interaction.Values["threads"]; threads.Set {
+				if config.Threads, err = strconv.Atoi(threads.Value.(string)); err != nil {
+					return err
+				}
+			}
+
+			if hash := interaction.Values["hash"]; hash.Set {
+				if config.Hash, err = strconv.Atoi(hash.Value.(string)); err != nil {
+					return err
+				}
+			}
+
+			startTime := realtime.Now()
+			divide, nodes := board.Perft(engine.Search.Board(), depth, config)
+			perftTime := realtime.Since(startTime)
+
+			// divide output
+			for _, result := range divide {
+				interaction.Replyf("%s: %d", result.Move, result.Nodes)
+			}
+
+			// report nodes and nps
+			interaction.Reply()
+			interaction.Replyf(
+				"%d nodes %d ms %.f nps",
+				nodes, perftTime.Milliseconds(), float64(nodes)/perftTime.Seconds(),
+			)
+
+			return nil
+		},
+
+		Flags: schema,
+	}
+}
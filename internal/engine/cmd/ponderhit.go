@@ -20,22 +20,26 @@ import (
 	"laptudirm.com/x/mess/pkg/uci/cmd"
 )
 
+// UCI command ponderhit
+//
+// The user has played the expected move. This will be sent if the engine
+// was told to ponder on the same move the user has played. The engine
+// should continue searching but switch from pondering to normal search.
+//
+// The search keeps it's tree, stats, and node count, while it's time is
+// managed with the limits of the go ponder command from then on. A miss
+// is handled by the gui with a stop, which ends the search quickly and
+// leaves it's entries in the tt for the next search.
 func NewPonderHit(engine *context.Engine) cmd.Command {
 	return cmd.Command{
 		Name: "ponderhit",
 		Run: func(interaction cmd.Interaction) error {
-			// check if any ponder search is ongoing
-			if !engine.Pondering {
-				return errors.New("stop: no ponder search ongoing")
-			}
-
-			for !engine.Search.InProgress() {
-				// wait for search to start before updating limits
-				// cause otherwise parallelization issues will occur
+			// check if any ponder search is ongoing, and stop pondering
+			// but continue search with updated limits
+			if !engine.Pondering.CompareAndSwap(true, false) {
+				return errors.New("ponderhit: no ponder search ongoing")
 			}
 
-			// stop pondering but continue search with updated limits
-			engine.Pondering = false // search is now normal
 			// update to previously stored limits for normal search
 			engine.Search.UpdateLimits(engine.PonderLimits)
 			return nil
@@ -28,15 +28,10 @@ func NewStop(engine *context.Engine) cmd.Command {
 		Name: "stop",
 		Run: func(interaction cmd.Interaction) error {
 			// check if any search is ongoing
-			if !engine.Searching {
+			if !engine.Searching.Load() {
 				return errors.New("stop: no search ongoing")
 			}
 
-			for !engine.Search.InProgress() {
-				// wait for search to start before stopping it
-				// cause otherwise parallelization issues will occur
-			}
-
 			// stop the search
 			engine.Search.Stop()
 			return nil
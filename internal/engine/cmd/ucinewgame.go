@@ -39,10 +39,17 @@ func NewUciNewGame(engine *context.Engine) cmd.Command {
 	return cmd.Command{
 		Name: "ucinewgame",
 		Run: func(interaction cmd.Interaction) error {
-			// new context for new game
+			if engine.Search != nil {
+				// reuse the context, along with it's hash table
+				engine.Search.NewGame()
+				return nil
+			}
+
+			// first game, create a new context
 			engine.Search = search.NewContext(func(r search.Report) {
 				interaction.Reply(r)
 			}, engine.Options.Hash)
+			engine.Search.SetThreads(engine.Options.Threads)
 			return nil
 		},
 	}
@@ -14,7 +14,12 @@
 package context
 
 import (
+	"sync/atomic"
+
+	"laptudirm.com/x/mess/pkg/formats/polyglot"
 	"laptudirm.com/x/mess/pkg/search"
+	"laptudirm.com/x/mess/pkg/search/syzygy"
+	"laptudirm.com/x/mess/pkg/search/tt"
 	"laptudirm.com/x/mess/pkg/uci"
 	"laptudirm.com/x/mess/pkg/uci/option"
 )
@@ -25,11 +30,18 @@ type Engine struct {
 	// engine's uci client
 	Client uci.Client
 
-	// current search context
+	// current search context, the flags are also updated by the
+	// goroutine of an asynchronous search, so they are atomic
 	Search    *search.Context
-	Searching bool
+	Searching atomic.Bool
+
+	// tablebase probed by the search, nil if not available
+	Tablebase *syzygy.Tablebase
 
-	Pondering    bool
+	// opening book used with OwnBook, nil if not available
+	Book *polyglot.Book
+
+	Pondering    atomic.Bool
 	PonderLimits search.Limits
 
 	// uci options
@@ -40,6 +52,18 @@ type Engine struct {
 // options contains the values of the UCI options supported by the engine.
 type options struct {
 	Ponder  bool // name Ponder type check
+	OwnBook bool // name OwnBook type check
 	Hash    int  // name Hash type spin
 	Threads int  // name Threads type spin
+	MultiPV int  // name MultiPV type spin
+
+	HashAllocation tt.Allocation // name HashAllocation type combo
+
+	EvalFile string // name EvalFile type string
+	BookFile string // name BookFile type string
+
+	SyzygyPath       string // name SyzygyPath type string
+	SyzygyProbeLimit int    // name SyzygyProbeLimit type spin
+
+	InfoInterval int // name InfoInterval type spin
 }
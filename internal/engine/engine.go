@@ -32,6 +32,7 @@ func NewClient() (uci.Client, error) {
 	engine.Client = uci.NewClient()
 	engine.Client.AddCommand(cmd.NewD(engine))
 	engine.Client.AddCommand(cmd.NewGo(engine))
+	engine.Client.AddCommand(cmd.NewPerft(engine))
 	engine.Client.AddCommand(cmd.NewUci(engine))
 	engine.Client.AddCommand(cmd.NewStop(engine))
 	engine.Client.AddCommand(cmd.NewBench(engine))
@@ -47,8 +48,16 @@ func NewClient() (uci.Client, error) {
 
 	// add uci options to engine
 	engine.OptionSchema = option.NewSchema()
+	engine.OptionSchema.AddOption("BookFile", options.NewBookFile(engine))
+	engine.OptionSchema.AddOption("EvalFile", options.NewEvalFile(engine))
 	engine.OptionSchema.AddOption("Hash", options.NewHash(engine))
+	engine.OptionSchema.AddOption("HashAllocation", options.NewHashAllocation(engine))
+	engine.OptionSchema.AddOption("InfoInterval", options.NewInfoInterval(engine))
+	engine.OptionSchema.AddOption("MultiPV", options.NewMultiPV(engine))
+	engine.OptionSchema.AddOption("OwnBook", options.NewOwnBook(engine))
 	engine.OptionSchema.AddOption("Ponder", options.NewPonder(engine))
+	engine.OptionSchema.AddOption("SyzygyPath", options.NewSyzygyPath(engine))
+	engine.OptionSchema.AddOption("SyzygyProbeLimit", options.NewSyzygyProbeLimit(engine))
 	engine.OptionSchema.AddOption("Threads", options.NewThreads(engine))
 
 	// initialize options
@@ -0,0 +1,56 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/formats/polyglot"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// NoBookFile is the value of BookFile which represents no opening book.
+const NoBookFile = "<empty>"
+
+// UCI option BookFile, type string
+//
+// The path to the polyglot opening book used when OwnBook is enabled. The
+// book moves are played instantly, without searching the position.
+func NewBookFile(engine *context.Engine) option.Option {
+	return &option.String{
+		Default: NoBookFile,
+
+		Storage: func(path string) error {
+			var book *polyglot.Book
+			if path == "" {
+				path = NoBookFile
+			}
+
+			if path != NoBookFile {
+				var err error
+				if book, err = polyglot.Open(path); err != nil {
+					return err
+				}
+			}
+
+			// release the previous book, which is no longer used
+			if engine.Book != nil {
+				engine.Book.Close()
+			}
+
+			engine.Options.BookFile = path
+			engine.Book = book
+			return nil
+		},
+	}
+}
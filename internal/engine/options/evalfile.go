@@ -0,0 +1,52 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+	"laptudirm.com/x/mess/pkg/search/eval/nnue"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// NoEvalFile is the value of EvalFile which represents no network file.
+const NoEvalFile = "<empty>"
+
+// UCI option EvalFile, type string
+//
+// The path to the nnue network file used for evaluation. The classical
+// evaluation function is used if no network file is provided.
+func NewEvalFile(engine *context.Engine) option.Option {
+	return &option.String{
+		Default: NoEvalFile,
+
+		Storage: func(path string) error {
+			if path == NoEvalFile || path == "" {
+				// use the classical evaluation function
+				engine.Options.EvalFile = NoEvalFile
+				engine.Search.SetEvaluator(classical.New)
+				return nil
+			}
+
+			network, err := nnue.Load(path)
+			if err != nil {
+				return err
+			}
+
+			engine.Options.EvalFile = path
+			engine.Search.SetEvaluator(network.NewEvaluator)
+			return nil
+		},
+	}
+}
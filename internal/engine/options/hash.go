@@ -14,6 +14,8 @@
 package options
 
 import (
+	"errors"
+
 	"laptudirm.com/x/mess/internal/engine/context"
 	"laptudirm.com/x/mess/pkg/uci/option"
 )
@@ -32,12 +34,15 @@ func NewHash(engine *context.Engine) option.Option {
 		// use stockfish value to suppress cutechess warnings
 		Max: 33554432,
 		Storage: func(hash int) error {
+			if engine.Search.InProgress() {
+				// the hash table is being used by the search
+				return errors.New("hash: search currently in progress")
+			}
+
 			engine.Options.Hash = hash
 
 			// resize hash table
-			engine.Search.ResizeTT(hash)
-
-			return nil
+			return engine.Search.ResizeTT(hash)
 		},
 	}
 }
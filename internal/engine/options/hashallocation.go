@@ -0,0 +1,52 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"errors"
+
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/search/tt"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// UCI option HashAllocation, type combo
+//
+// The method used to allocate the memory of the hash table. HugePages
+// backs the table with transparent huge pages, while Interleaved also
+// spreads the huge pages across all the NUMA nodes of the machine. Both
+// are only supported on linux, and fall back to Heap on other systems.
+func NewHashAllocation(engine *context.Engine) option.Option {
+	return &option.Combo{
+		Default: tt.HeapAllocation.String(),
+		Vars:    tt.Allocations,
+
+		Storage: func(name string) error {
+			if engine.Search.InProgress() {
+				// the hash table is being used by the search
+				return errors.New("hashallocation: search currently in progress")
+			}
+
+			allocation, err := tt.NewAllocation(name)
+			if err != nil {
+				return err
+			}
+
+			engine.Options.HashAllocation = allocation
+
+			// reallocate hash table
+			return engine.Search.SetTTAllocation(allocation)
+		},
+	}
+}
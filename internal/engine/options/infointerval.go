@@ -0,0 +1,42 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"time"
+
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/search"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// UCI option InfoInterval, type spin
+//
+// The minimum number of milliseconds between two progress info lines,
+// which contain the currmove and the nodes searched, sent while the engine
+// is searching an iteration. A value of 0 disables the progress lines.
+func NewInfoInterval(engine *context.Engine) option.Option {
+	return &option.Spin{
+		Default: 0,
+		Min:     0, Max: 60000,
+
+		Storage: func(interval int) error {
+			engine.Options.InfoInterval = interval
+			engine.Search.SetProgressReporter(func(progress search.Progress) {
+				engine.Client.Println(progress)
+			}, time.Duration(interval)*time.Millisecond)
+			return nil
+		},
+	}
+}
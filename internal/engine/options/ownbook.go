@@ -0,0 +1,34 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// UCI option OwnBook, type check
+//
+// This means that the engine has its own book which is accessed by the
+// engine itself. If this is set, the engine takes care of the opening book
+// and the GUI will never execute a move out of its book for the engine.
+func NewOwnBook(engine *context.Engine) option.Option {
+	return &option.Check{
+		Default: false,
+		Storage: func(ownBook bool) error {
+			engine.Options.OwnBook = ownBook
+			return nil
+		},
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"errors"
+
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/search/syzygy"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// NoSyzygyPath is the value of SyzygyPath which represents no tablebase.
+const NoSyzygyPath = "<empty>"
+
+// UCI option SyzygyPath, type string
+//
+// The list of directories containing the syzygy tablebase files, separated
+// by ':' on unix and ';' on windows. The tablebase isn't probed if no path
+// is provided.
+func NewSyzygyPath(engine *context.Engine) option.Option {
+	return &option.String{
+		Default: NoSyzygyPath,
+
+		Storage: func(path string) error {
+			if engine.Search.InProgress() {
+				// the tablebase is being probed by the search
+				return errors.New("syzygypath: search currently in progress")
+			}
+
+			var tb *syzygy.Tablebase
+			if path == "" {
+				path = NoSyzygyPath
+			}
+
+			if path != NoSyzygyPath {
+				var err error
+				if tb, err = syzygy.Open(path); err != nil {
+					return err
+				}
+			}
+
+			// release the previous tablebase, which is no longer probed
+			if engine.Tablebase != nil {
+				engine.Tablebase.Close()
+			}
+
+			engine.Options.SyzygyPath = path
+			engine.Tablebase = tb
+			engine.Search.SetTablebase(tb)
+			return nil
+		},
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package options
+
+import (
+	"errors"
+
+	"laptudirm.com/x/mess/internal/engine/context"
+	"laptudirm.com/x/mess/pkg/search/syzygy"
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+// UCI option SyzygyProbeLimit, type spin
+//
+// The maximum number of pieces, including the kings, of the positions
+// which are probed in the syzygy tablebase.
+func NewSyzygyProbeLimit(engine *context.Engine) option.Option {
+	return &option.Spin{
+		Default: syzygy.MaxPieces,
+		Min:     0, Max: syzygy.MaxPieces,
+
+		Storage: func(pieces int) error {
+			if engine.Search.InProgress() {
+				// the limit is being used by the search
+				return errors.New("syzygyprobelimit: search currently in progress")
+			}
+
+			engine.Options.SyzygyProbeLimit = pieces
+			engine.Search.SetTBProbeLimit(pieces)
+			return nil
+		},
+	}
+}
@@ -14,6 +14,8 @@
 package options
 
 import (
+	"errors"
+
 	"laptudirm.com/x/mess/internal/engine/context"
 	"laptudirm.com/x/mess/pkg/uci/option"
 )
@@ -23,12 +25,17 @@ import (
 // The number of threads the engine should use while searching.
 func NewThreads(engine *context.Engine) option.Option {
 	return &option.Spin{
-		// multi-threading not implemented, so fix value at 1
 		Default: 1,
-		Min:     1, Max: 1,
+		Min:     1, Max: 1024,
 
 		Storage: func(threads int) error {
+			if engine.Search.InProgress() {
+				// the helper threads are being used by the search
+				return errors.New("threads: search currently in progress")
+			}
+
 			engine.Options.Threads = threads
+			engine.Search.SetThreads(threads)
 			return nil
 		},
 	}
@@ -17,6 +17,8 @@ package main
 
 import (
 	_ "embed"
+	"encoding/binary"
+	"os"
 
 	"laptudirm.com/x/mess/internal/generator"
 	"laptudirm.com/x/mess/pkg/board/bitboard"
@@ -30,8 +32,11 @@ type attackStruct struct {
 	Knight [square.N]bitboard.Board
 	Pawn   [piece.ColorN][square.N]bitboard.Board
 
-	Rook   magic.Table
-	Bishop magic.Table
+	// magics of the sliding pieces, which index into a shared table of
+	// SlidersN attack sets, which is stored separately in a binary blob
+	Rook     [square.N]magic.Magic
+	Bishop   [square.N]magic.Magic
+	SlidersN int
 }
 
 //go:embed .gotemplate
@@ -50,8 +55,29 @@ func main() {
 	}
 
 	// initialize magic lookup tables for sliding pieces
-	a.Rook = *magic.NewTable(4096, rook)
-	a.Bishop = *magic.NewTable(512, bishop)
+	rookTable := magic.NewTable(magic.RookMoves)
+	bishopTable := magic.NewTable(magic.BishopMoves)
+
+	// both the tables are stored in a single contiguous array, with
+	// the bishop attack sets following the rook attack sets
+	a.Rook = rookTable.Magics
+	a.Bishop = bishopTable.Magics
+	for s := square.A8; s <= square.H1; s++ {
+		a.Bishop[s].Offset += uint32(len(rookTable.Table))
+	}
+
+	sliders := append(rookTable.Table, bishopTable.Table...)
+	a.SlidersN = len(sliders)
 
 	generator.Generate("tables", template, a)
+
+	// write the slider attack sets as little-endian uint64s
+	blob := make([]byte, 0, 8*len(sliders))
+	for _, attacks := range sliders {
+		blob = binary.LittleEndian.AppendUint64(blob, uint64(attacks))
+	}
+
+	if err := os.WriteFile("sliders.bin", blob, 0644); err != nil {
+		panic(err)
+	}
 }
@@ -0,0 +1,67 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package main
+
+import (
+	_ "embed"
+
+	"laptudirm.com/x/mess/internal/generator"
+)
+
+// sideStruct contains the side to move dependent parts of a move generator
+// specialized for that side, as they are written in the generated code.
+type sideStruct struct {
+	// names of the side to move and the other side
+	Us, Them string
+
+	// bitboard shifts towards the other side and towards the own side
+	Up, Down string
+
+	// offsets which give the squares one and two ranks "below" a square
+	// when added to it, where "below" is towards the own side
+	Below, TwoBelow string
+
+	// rank where the pieces start, rank where the pawns get promoted, rank
+	// at which pawns can en passant, and rank from which a single push is
+	// the same as a double push from home
+	HomeRank, PromotionRank, EnPassantRank, DoublePushRank int
+}
+
+type movegenStruct struct {
+	Sides []sideStruct
+}
+
+//go:embed .gotemplate
+var template string
+
+func main() {
+	movegen := movegenStruct{
+		Sides: []sideStruct{
+			{
+				Us: "White", Them: "Black",
+				Up: "North", Down: "South",
+				Below: "+ 8", TwoBelow: "+ 16",
+				HomeRank: 1, PromotionRank: 8, EnPassantRank: 5, DoublePushRank: 3,
+			},
+			{
+				Us: "Black", Them: "White",
+				Up: "South", Down: "North",
+				Below: "- 8", TwoBelow: "- 16",
+				HomeRank: 8, PromotionRank: 1, EnPassantRank: 4, DoublePushRank: 6,
+			},
+		},
+	}
+
+	generator.Generate("sideMoves", template, movegen)
+}
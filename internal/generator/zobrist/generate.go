@@ -29,6 +29,7 @@ type zobristStruct struct {
 	EnPassant   [square.FileN]zobrist.Key
 	Castling    [castling.N]zobrist.Key
 	SideToMove  zobrist.Key
+	PawnSquare  [piece.ColorN][square.N]zobrist.Key
 }
 
 //go:embed .gotemplate
@@ -60,5 +61,12 @@ func main() {
 	// black to move
 	z.SideToMove = zobrist.Key(rng.Uint64())
 
+	// pawn square numbers for the pawn hash
+	for c := piece.White; c <= piece.Black; c++ {
+		for s := square.A8; s <= square.H1; s++ {
+			z.PawnSquare[c][s] = zobrist.Key(rng.Uint64())
+		}
+	}
+
 	generator.Generate("keys", template, z)
 }
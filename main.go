@@ -39,8 +39,11 @@ func run() error {
 		return err
 	}
 
+	// make sure all the output is written before exiting
+	defer client.Flush()
+
 	// engine header with name, version, and author
-	fmt.Printf("Mess %s by Rak Laptudirm\n", build.Version)
+	client.Printf("Mess %s by Rak Laptudirm\n", build.Version)
 
 	switch args := os.Args[1:]; {
 	case len(args) == 0:
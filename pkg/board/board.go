@@ -77,6 +77,9 @@ type Board struct {
 	// zobrist hash of current position
 	Hash zobrist.Key
 
+	// zobrist hash of the pawn structure of current position
+	PawnHash zobrist.Key
+
 	// 8x8 mailbox board representation
 	Position mailbox.Board
 
@@ -98,8 +101,48 @@ type Board struct {
 	FullMoves int
 	DrawClock int
 
-	// game history
-	History [move.MaxN]BoardState
+	// game history, indexed by ply; the board owns it's history, which
+	// is grown on demand by MakeMove, and only the states before Plys are
+	// live, the rest are reused buffer space
+	history []BoardState
+}
+
+// Copy copies the position and game history of the src board into b.
+// The efficiently updatable of b isn't changed, but it is reset and
+// refilled with the new position. b's move generation state is reset to
+// refer to b instead of src. Only the live history is copied, into b's
+// own history buffer, which is reused if it is large enough.
+func (b *Board) Copy(src *Board) {
+	eu := b.efficientlyUpdatable
+	history := b.history
+
+	*b = *src
+
+	b.history = append(history[:0], src.history[:src.Plys]...)
+	b.moveGenState = moveGenState{Board: b}
+	b.SetEfficientlyUpdatable(eu)
+}
+
+// Clone returns a new board with a copy of the position and the live game
+// history of b. The new board has a dummy efficiently updatable, which can
+// be changed with SetEfficientlyUpdatable if needed.
+func (b *Board) Clone() *Board {
+	clone := New()
+	clone.Copy(b)
+	return clone
+}
+
+// SetEfficientlyUpdatable changes the efficiently updatable of the board.
+// The efficiently updatable is reset and filled with the current position.
+func (b *Board) SetEfficientlyUpdatable(eu EfficientlyUpdatable) {
+	b.efficientlyUpdatable = eu
+
+	eu.Reset()
+	for s := square.A8; s <= square.H1; s++ {
+		if p := b.Position[s]; p != piece.NoPiece {
+			eu.FillSquare(s, p)
+		}
+	}
 }
 
 // BoardState contains the irreversible position data of a given board
@@ -116,6 +159,13 @@ type BoardState struct {
 
 	// zobrist key is reversible but is stored for repetition detection
 	Hash zobrist.Key
+
+	// pawn hash is stored so that it can be restored by UnmakeMove
+	PawnHash zobrist.Key
+
+	// cached check and pin information of the position, which is
+	// kept by MakeMove so that it is still valid after UnmakeMove
+	checks checkInfo
 }
 
 // String converts a Board into a human readable string.
@@ -138,7 +188,7 @@ func (b *Board) IsRepetition() bool {
 	depth := util.Max(0, b.Plys-b.DrawClock)
 
 	for i := b.Plys - 2; i >= depth; i -= 2 {
-		if b.History[i].Hash == b.Hash {
+		if b.history[i].Hash == b.Hash {
 			return true
 		}
 	}
@@ -152,7 +202,7 @@ func (b *Board) IsThreefoldRepetition() bool {
 
 	repetitions := 1 // current position is a repetition
 	for i := b.Plys - 2; i >= depth; i -= 2 {
-		if b.History[i].Hash == b.Hash {
+		if b.history[i].Hash == b.Hash {
 			repetitions++
 			if repetitions >= 3 {
 				return true
@@ -205,13 +255,13 @@ func (b *Board) ClearSquare(s square.Square) {
 		return
 	}
 
-	b.ColorBBs[p.Color()].Unset(s)
-
-	// remove piece from other records
-	b.PieceBBs[p.Type()].Unset(s)       // piece bitboard
-	b.Position[s] = piece.NoPiece       // mailbox board
+	b.removePiece(s, p)
 	b.Hash ^= zobrist.PieceSquare[p][s] // zobrist hash
 
+	if p.Type() == piece.Pawn {
+		b.PawnHash ^= zobrist.PawnSquare[p.Color()][s] // pawn hash
+	}
+
 	b.efficientlyUpdatable.ClearSquare(s, p)
 }
 
@@ -219,20 +269,41 @@ func (b *Board) ClearSquare(s square.Square) {
 // make sure that the provided square is unoccupied, otherwise the
 // incrementally updating the position will give wrong results.
 func (b *Board) FillSquare(s square.Square, p piece.Piece) {
-	c := p.Color()
-	t := p.Type()
-
-	b.ColorBBs[c].Set(s)
-
-	b.PieceBBs[t].Set(s)                // piece bitboard
-	b.Position[s] = p                   // mailbox board
+	b.placePiece(s, p)
 	b.Hash ^= zobrist.PieceSquare[p][s] // zobrist hash
 
+	if p.Type() == piece.Pawn {
+		b.PawnHash ^= zobrist.PawnSquare[p.Color()][s] // pawn hash
+	}
+
 	b.efficientlyUpdatable.FillSquare(s, p)
 }
 
+// removePiece removes the given piece from the given square of the board
+// representations. Unlike ClearSquare, the zobrist hashes and the efficiently
+// updatable are not updated, which is used by UnmakeMove to restore them.
+func (b *Board) removePiece(s square.Square, p piece.Piece) {
+	b.ColorBBs[p.Color()].Unset(s) // color bitboard
+	b.PieceBBs[p.Type()].Unset(s)  // piece bitboard
+	b.Position[s] = piece.NoPiece  // mailbox board
+}
+
+// placePiece places the given piece on the given square of the board
+// representations. Unlike FillSquare, the zobrist hashes and the efficiently
+// updatable are not updated, which is used by UnmakeMove to restore them.
+func (b *Board) placePiece(s square.Square, p piece.Piece) {
+	b.ColorBBs[p.Color()].Set(s) // color bitboard
+	b.PieceBBs[p.Type()].Set(s)  // piece bitboard
+	b.Position[s] = p            // mailbox board
+}
+
 // IsInCheck checks if the side with the given color is in check.
 func (b *Board) IsInCheck(c piece.Color) bool {
+	if c == b.SideToMove {
+		// use the cached check information
+		return b.checks().checkN > 0
+	}
+
 	return b.IsAttacked(b.KingBB(c).FirstOne(), c.Other())
 }
 
@@ -298,12 +369,25 @@ func (b *Board) NonPawnMaterial(c piece.Color) bitboard.Board {
 		b.PieceBBs[piece.Rook] | b.PieceBBs[piece.Queen]) & b.ColorBBs[c]
 }
 
+// EfficientlyUpdatable represents a type, usually an evaluation function,
+// which is efficiently updated by the board as pieces are added to and
+// removed from squares. The updated state is stacked: Push is called at
+// the start of every MakeMove, and Pop by UnmakeMove, which restores the
+// state of the previous position without any further square updates.
 type EfficientlyUpdatable interface {
 	FillSquare(square.Square, piece.Piece)
 	ClearSquare(square.Square, piece.Piece)
+
+	// state stack functions
+	Push()  // push a copy of the current state
+	Pop()   // restore the previous state
+	Reset() // reset to an empty board state
 }
 
 type dummyEU struct{}
 
 func (eu *dummyEU) FillSquare(square.Square, piece.Piece)  {}
 func (eu *dummyEU) ClearSquare(square.Square, piece.Piece) {}
+func (eu *dummyEU) Push()                                  {}
+func (eu *dummyEU) Pop()                                   {}
+func (eu *dummyEU) Reset()                                 {}
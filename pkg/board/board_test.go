@@ -0,0 +1,110 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package board_test
+
+import (
+	"testing"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+)
+
+func TestClone(t *testing.T) {
+	b := board.New(board.FEN(board.StartFEN))
+	for _, m := range []string{"g1f3", "g8f6", "f3g1", "f6g8"} {
+		b.MakeMove(b.NewMoveFromString(m))
+	}
+
+	clone := b.Clone()
+	if !clone.IsRepetition() {
+		t.Fatal("clone: repetition not detected")
+	}
+
+	// the clone should have it's own history
+	clone.MakeMove(clone.NewMoveFromString("e2e4"))
+	if !b.IsRepetition() {
+		t.Fatal("board: history changed by clone")
+	}
+
+	// the clone should be able to unmake the copied moves
+	for i := 0; i < 5; i++ {
+		clone.UnmakeMove()
+	}
+
+	if clone.FEN() != board.StartFEN || clone.Hash != b.Hash {
+		t.Fatalf("clone: got %s after unmaking, want %s", clone.FEN(), board.StartFEN)
+	}
+}
+
+// treeTests are the positions whose move trees are used to test functions
+// which predict the effects of a move without playing it.
+var treeTests = []string{
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+}
+
+func TestKeyAfter(t *testing.T) {
+	for _, test := range treeTests {
+		b := board.New(board.FEN(fen.FromString(test)))
+		testKeyAfter(t, b, 3)
+	}
+}
+
+// testKeyAfter compares KeyAfter with the hash after playing the move, for
+// all the moves and null moves in the tree of the given depth.
+func testKeyAfter(t *testing.T, b *board.Board, depth int) {
+	if depth == 0 {
+		return
+	}
+
+	for _, m := range append(b.GenerateMoves(false), move.Null) {
+		key := b.KeyAfter(m)
+
+		b.MakeMove(m)
+		if key != b.Hash {
+			b.UnmakeMove()
+			t.Fatalf("%s: key after %s is %#x, want %#x", b.FEN(), m, key, b.Hash)
+		}
+
+		if m != move.Null {
+			testKeyAfter(t, b, depth-1)
+		}
+
+		b.UnmakeMove()
+	}
+}
+
+func BenchmarkMakeMove(b *testing.B) {
+	boards := benchBoards()
+
+	moves := make([][]move.Move, len(boards))
+	for i, chessboard := range boards {
+		moves[i] = chessboard.GenerateMoves(false)
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for j, chessboard := range boards {
+			for _, m := range moves[j] {
+				chessboard.MakeMove(m)
+				chessboard.UnmakeMove()
+			}
+		}
+	}
+}
@@ -0,0 +1,263 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package board
+
+import (
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move/attacks"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+)
+
+// checkInfo contains the check and pin information of a position, from the
+// perspective of it's side to move. It is stored in the position's history
+// entry, and each of it's parts is calculated lazily, only once for every
+// position, so that the search and the move generator share it. UnmakeMove returns to a history entry which still stores
+// the info of the position, so it doesn't need to be calculated again.
+//
+// The parts are keyed by the hash of the position they were calculated for,
+// so stale info from a previous use of the history entry is never used.
+type checkInfo struct {
+	// check information
+	checksKey zobrist.Key
+	checkers  bitboard.Board
+	checkN    int            // number of checkers [0, 2]
+	checkMask bitboard.Board // see docs for calculateChecks
+
+	// pin information, along with the squares seen by the enemy
+	pinsKey     zobrist.Key
+	pinnedD     bitboard.Board
+	pinnedHV    bitboard.Board
+	seenByEnemy bitboard.Board
+}
+
+// info returns the check info entry of the current position.
+func (b *Board) info() *checkInfo {
+	if b.Plys >= len(b.history) {
+		// history is full, grow it and use all of it's capacity
+		b.history = append(b.history, BoardState{})
+		b.history = b.history[:cap(b.history)]
+	}
+
+	return &b.history[b.Plys].checks
+}
+
+// checks returns the check info of the current position, with it's check
+// information calculated.
+func (b *Board) checks() *checkInfo {
+	info := b.info()
+	if info.checksKey != b.Hash {
+		b.calculateChecks(info)
+		info.checksKey = b.Hash
+	}
+
+	return info
+}
+
+// pins returns the check info of the current position, with it's check and
+// pin information calculated.
+func (b *Board) pins() *checkInfo {
+	info := b.checks()
+	if info.pinsKey != b.Hash {
+		b.calculatePins(info)
+		info.seenByEnemy = b.seenSquares(b.SideToMove.Other())
+		info.pinsKey = b.Hash
+	}
+
+	return info
+}
+
+// calculateChecks calculates the check-mask of the current board state,
+// along with the checkers and their number.
+//
+// A checker is an enemy piece which is directly checking the king. The
+// number of checkers can be a maximum of two (double check).
+//
+// The check-mask is defined as all the squares to which if a friendly
+// piece is moved to will block all checks. This is defined as empty for
+// double check, the checking piece and, if the checker is a sliding piece,
+// the squares between the king and the checker. The bitboard is universe
+// if the king is not in check.
+func (b *Board) calculateChecks(info *checkInfo) {
+	us, them := b.SideToMove, b.SideToMove.Other()
+	occupied := b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]
+
+	info.checkN = 0
+	info.checkMask = bitboard.Empty
+
+	kingSq := b.KingBB(us).FirstOne()
+
+	pawns := b.PawnsBB(them) & attacks.Pawn[us][kingSq]
+	knights := b.KnightsBB(them) & attacks.Knight[kingSq]
+	bishops := (b.BishopsBB(them) | b.QueensBB(them)) & attacks.Bishop(kingSq, occupied)
+	rooks := (b.RooksBB(them) | b.QueensBB(them)) & attacks.Rook(kingSq, occupied)
+
+	info.checkers = pawns | knights | bishops | rooks
+
+	// a pawn and a knight cannot be checking the king at the same time as
+	// they are not sliding pieces thus discovered attacks are impossible
+	switch {
+	case pawns != bitboard.Empty:
+		info.checkMask |= pawns
+		info.checkN++
+
+	case knights != bitboard.Empty:
+		info.checkMask |= knights
+		info.checkN++
+	}
+
+	if bishops != bitboard.Empty {
+		bishopSq := bishops.FirstOne()
+		info.checkMask |= bitboard.Between[kingSq][bishopSq] | bitboard.Square(bishopSq)
+		info.checkN++
+	}
+
+	// 2 is the largest possible value for checkN so short circuit if thats reached
+	if info.checkN < 2 && rooks != bitboard.Empty {
+		if info.checkN == 0 && rooks.Count() > 1 {
+			// double check, don't set the check-mask
+			info.checkN++
+		} else {
+			rookSq := rooks.FirstOne()
+			info.checkMask |= bitboard.Between[kingSq][rookSq] | bitboard.Square(rookSq)
+			info.checkN++
+		}
+	}
+
+	if info.checkN == 0 {
+		// king is not in check so check-mask is universe
+		info.checkMask = bitboard.Universe
+	}
+}
+
+// calculatePins calculates the diagonal and the horizontal and vertical
+// pin-masks. A pin-mask is defined as the mask containing all attack rays
+// of pieces pinning a piece in a given direction.
+func (b *Board) calculatePins(info *checkInfo) {
+	us, them := b.SideToMove, b.SideToMove.Other()
+	kingSq := b.KingBB(us).FirstOne()
+
+	friends := b.ColorBBs[us]
+	enemies := b.ColorBBs[them]
+
+	info.pinnedD = bitboard.Empty
+	info.pinnedHV = bitboard.Empty
+
+	// consider enemy rooks and queens which are attacking or would attack the king if not for intervening pieces
+	// the king is considered as a rook for this and it's attack sets & with rooks and queens gives the bitboard
+	for rooks := (b.RooksBB(them) | b.QueensBB(them)) & attacks.Rook(kingSq, enemies); rooks != bitboard.Empty; {
+		rook := rooks.Pop()
+		possiblePin := bitboard.Between[kingSq][rook] | bitboard.Square(rook)
+
+		// if there is only one friendly piece blocking the ray, it is pinned
+		if (possiblePin & friends).Count() == 1 {
+			info.pinnedHV |= possiblePin
+		}
+	}
+
+	// consider enemy bishops and queens which are attacking or would attack the king if not for intervening pieces
+	// the king is considered as a bishop for this and it's attack sets & with bishops and queens gives the bitboard
+	for bishops := (b.BishopsBB(them) | b.QueensBB(them)) & attacks.Bishop(kingSq, enemies); bishops != bitboard.Empty; {
+		bishop := bishops.Pop()
+		possiblePin := bitboard.Between[kingSq][bishop] | bitboard.Square(bishop)
+
+		// if there is only one friendly piece blocking the ray, it is pinned
+		if (possiblePin & friends).Count() == 1 {
+			info.pinnedD |= possiblePin
+		}
+	}
+}
+
+// seenSquares returns a bitboard containing all the squares that are
+// seen(attacked) by pieces of the given color. The enemy king is not
+// considered as a sliding ray blocker by seenSquares since it has to
+// move away from the attack exposing the blocked squares.
+func (b *Board) seenSquares(by piece.Color) bitboard.Board {
+	pawns := b.PawnsBB(by)
+	knights := b.KnightsBB(by)
+	bishops := b.BishopsBB(by)
+	rooks := b.RooksBB(by)
+	queens := b.QueensBB(by)
+	kingSq := b.KingBB(by).FirstOne()
+
+	// don't consider the enemy king as a blocker
+	blockers := (b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]) &^ b.KingBB(by.Other())
+
+	seen := attacks.PawnsLeft(pawns, by) | attacks.PawnsRight(pawns, by)
+
+	for knights != bitboard.Empty {
+		from := knights.Pop()
+		seen |= attacks.Knight[from]
+	}
+
+	for bishops != bitboard.Empty {
+		from := bishops.Pop()
+		seen |= attacks.Bishop(from, blockers)
+	}
+
+	for rooks != bitboard.Empty {
+		from := rooks.Pop()
+		seen |= attacks.Rook(from, blockers)
+	}
+
+	for queens != bitboard.Empty {
+		from := queens.Pop()
+		seen |= attacks.Queen(from, blockers)
+	}
+
+	seen |= attacks.King[kingSq]
+
+	return seen
+}
+
+// Checkers returns a bitboard of the enemy pieces checking the king of
+// the side to move.
+func (b *Board) Checkers() bitboard.Board {
+	return b.checks().checkers
+}
+
+// Pinned returns a bitboard of the pieces of the given color which are
+// pinned to their king.
+func (b *Board) Pinned(c piece.Color) bitboard.Board {
+	if c != b.SideToMove {
+		// only the side to move's pins are stored in the check info
+		return b.pinnedTo(c)
+	}
+
+	info := b.pins()
+	return (info.pinnedD | info.pinnedHV) & b.ColorBBs[c]
+}
+
+// pinnedTo calculates the pieces of the given color which are the only
+// blocker between an enemy slider and their king.
+func (b *Board) pinnedTo(c piece.Color) bitboard.Board {
+	them := c.Other()
+	occupied := b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]
+	kingSq := b.KingBB(c).FirstOne()
+
+	// enemy sliders which would attack the king on an empty board
+	snipers := (b.BishopsBB(them)|b.QueensBB(them))&attacks.Bishop(kingSq, bitboard.Empty) |
+		(b.RooksBB(them)|b.QueensBB(them))&attacks.Rook(kingSq, bitboard.Empty)
+
+	pinned := bitboard.Empty
+	for snipers != bitboard.Empty {
+		sniper := snipers.Pop()
+		blockers := bitboard.Between[kingSq][sniper] & occupied
+		if blockers.Count() == 1 {
+			pinned |= blockers & b.ColorBBs[c]
+		}
+	}
+
+	return pinned
+}
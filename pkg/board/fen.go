@@ -34,9 +34,13 @@ func (board *Board) UpdateWithFEN(fen fen.String) {
 		board.ClearSquare(s)
 	}
 
+	// the position is replaced, so the stacked state is discarded
+	board.efficientlyUpdatable.Reset()
+
 	// reset some stuff
 	board.Plys = 0
 	board.Hash = 0
+	board.PawnHash = 0
 
 	// side to move
 	board.SideToMove = piece.NewColor(fen[1])
@@ -27,13 +27,26 @@ import (
 
 // MakeMove plays the given legal move on the Board.
 func (b *Board) MakeMove(m move.Move) {
-	// add current state to history
-	b.History[b.Plys].Move = m
-	b.History[b.Plys].CastlingRights = b.CastlingRights
-	b.History[b.Plys].CapturedPiece = piece.NoPiece
-	b.History[b.Plys].EnPassantTarget = b.EnPassantTarget
-	b.History[b.Plys].DrawClock = b.DrawClock
-	b.History[b.Plys].Hash = b.Hash
+	if b.Plys == len(b.history) {
+		// history is full, grow it and use all of it's capacity
+		b.history = append(b.history, BoardState{})
+		b.history = b.history[:cap(b.history)]
+	}
+
+	// add current state to history, keeping the position's check info
+	state := &b.history[b.Plys]
+	state.Move = m
+	state.CapturedPiece = piece.NoPiece
+
+	state.CastlingRights = b.CastlingRights
+	state.EnPassantTarget = b.EnPassantTarget
+	state.DrawClock = b.DrawClock
+
+	state.Hash = b.Hash
+	state.PawnHash = b.PawnHash
+
+	// save the efficiently updated state
+	b.efficientlyUpdatable.Push()
 
 	// update the half-move clock
 	// it records the number of plys since the last pawn push or capture
@@ -102,9 +115,9 @@ func (b *Board) MakeMove(m move.Move) {
 		fallthrough
 
 	case isCapture:
-		b.History[b.Plys].CapturedPiece = b.Position[captureSq] // put captured piece in history
-		b.DrawClock = 0                                         // reset draw clock since capture
-		b.ClearSquare(captureSq)                                // clear the captured square
+		state.CapturedPiece = b.Position[captureSq] // put captured piece in history
+		b.DrawClock = 0                             // reset draw clock since capture
+		b.ClearSquare(captureSq)                    // clear the captured square
 	}
 
 	// move the piece
@@ -143,6 +156,65 @@ func (b *Board) makeNullMove() {
 	b.Hash ^= zobrist.SideToMove // switch in zobrist hash
 }
 
+// KeyAfter returns the zobrist hash of the position after the given legal
+// move is played, without playing it, by toggling the keys that MakeMove
+// would. It is used to prefetch the transposition table entry of the new
+// position before the move is made.
+func (b *Board) KeyAfter(m move.Move) zobrist.Key {
+	key := b.Hash ^ zobrist.SideToMove
+
+	// the en passant target is always reset
+	if b.EnPassantTarget != square.None {
+		key ^= zobrist.EnPassant[b.EnPassantTarget.File()]
+	}
+
+	if m == move.Null {
+		return key
+	}
+
+	sourceSq := m.Source()
+	targetSq := m.Target()
+	fromPiece := m.FromPiece()
+	pieceType := fromPiece.Type()
+
+	// move the piece
+	key ^= zobrist.PieceSquare[fromPiece][sourceSq]
+	key ^= zobrist.PieceSquare[m.ToPiece()][targetSq]
+
+	switch {
+	case pieceType == piece.Pawn && util.Abs(targetSq-sourceSq) == 16:
+		// the en passant target is only set if an enemy pawn can capture it
+		target := (sourceSq + targetSq) / 2
+		if b.PawnsBB(b.SideToMove.Other())&attacks.Pawn[b.SideToMove][target] != 0 {
+			key ^= zobrist.EnPassant[target.File()]
+		}
+
+	case pieceType == piece.King && util.Abs(targetSq-sourceSq) == 2:
+		// castle the rook
+		rookInfo := castling.Rooks[targetSq]
+		key ^= zobrist.PieceSquare[rookInfo.RookType][rookInfo.From]
+		key ^= zobrist.PieceSquare[rookInfo.RookType][rookInfo.To]
+
+	case pieceType == piece.Pawn && targetSq == b.EnPassantTarget:
+		// the captured pawn is below the en passant target
+		captureSq := targetSq + 8
+		if b.SideToMove == piece.Black {
+			captureSq = targetSq - 8
+		}
+
+		key ^= zobrist.PieceSquare[b.Position[captureSq]][captureSq]
+
+	case m.IsCapture():
+		key ^= zobrist.PieceSquare[b.Position[targetSq]][targetSq]
+	}
+
+	// update the castling rights
+	rights := b.CastlingRights &^ castling.RightUpdates[sourceSq] &^ castling.RightUpdates[targetSq]
+	key ^= zobrist.Castling[b.CastlingRights] ^ zobrist.Castling[rights]
+
+	return key
+}
+
 // UnmakeMove unmakes the last move played on the Board.
 func (b *Board) UnmakeMove() {
 	if b.SideToMove = b.SideToMove.Other(); b.SideToMove == piece.Black {
@@ -151,17 +223,24 @@ func (b *Board) UnmakeMove() {
 
 	b.Plys--
 
-	b.EnPassantTarget = b.History[b.Plys].EnPassantTarget
-	b.DrawClock = b.History[b.Plys].DrawClock
-	b.CastlingRights = b.History[b.Plys].CastlingRights
+	state := &b.history[b.Plys]
+
+	b.EnPassantTarget = state.EnPassantTarget
+	b.DrawClock = state.DrawClock
+	b.CastlingRights = state.CastlingRights
 
-	m := b.History[b.Plys].Move
+	m := state.Move
+
+	// restore the efficiently updated state
+	b.efficientlyUpdatable.Pop()
+
+	// use the hashes stored in history
+	b.Hash = state.Hash
+	b.PawnHash = state.PawnHash
 
 	// parse move
 
 	if m == move.Null {
-		// use the hash stored in history
-		b.Hash = b.History[b.Plys].Hash
 		return
 	}
 
@@ -170,22 +249,25 @@ func (b *Board) UnmakeMove() {
 	captureSq := targetSq
 	fromPiece := m.FromPiece()
 	pieceType := fromPiece.Type()
-	capturedPiece := b.History[b.Plys].CapturedPiece
+	capturedPiece := state.CapturedPiece
 
 	isCastling := pieceType == piece.King && util.Abs(targetSq-sourceSq) == 2
 	isEnPassant := pieceType == piece.Pawn && targetSq == b.EnPassantTarget
 	isCapture := m.IsCapture()
 
+	// the hashes and the efficiently updatable are already restored, so only
+	// the board representations need to be updated
+
 	// un-move the piece
-	b.ClearSquare(targetSq)
-	b.FillSquare(sourceSq, fromPiece)
+	b.removePiece(targetSq, b.Position[targetSq])
+	b.placePiece(sourceSq, fromPiece)
 
 	switch {
 	case isCastling:
 		// un-castle the rook
 		rookInfo := castling.Rooks[targetSq]
-		b.ClearSquare(rookInfo.To)
-		b.FillSquare(rookInfo.From, rookInfo.RookType)
+		b.removePiece(rookInfo.To, rookInfo.RookType)
+		b.placePiece(rookInfo.From, rookInfo.RookType)
 
 	case isEnPassant:
 		// capture square is different from target square during en passant
@@ -198,11 +280,8 @@ func (b *Board) UnmakeMove() {
 
 	case isCapture:
 		// put the captured piece back
-		b.FillSquare(captureSq, capturedPiece)
+		b.placePiece(captureSq, capturedPiece)
 	}
-
-	// use the hash stored in history
-	b.Hash = b.History[b.Plys].Hash
 }
 
 // NewMove returns a new move.Move representing moving a piece from `from`
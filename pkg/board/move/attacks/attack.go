@@ -65,13 +65,13 @@ func PawnsRight(pawns bitboard.Board, color piece.Color) bitboard.Board {
 // Bishop returns the attack set for a bishop on the given square and with
 // the given blocker set(occupied squares).
 func Bishop(s square.Square, blockers bitboard.Board) bitboard.Board {
-	return bishopTable.Probe(s, blockers)
+	return probe(&bishopMagics[s], blockers)
 }
 
 // Rook returns the attack set for a rook on the given square and with
 // the given blocker set(occupied squares).
 func Rook(s square.Square, blockers bitboard.Board) bitboard.Board {
-	return rookTable.Probe(s, blockers)
+	return probe(&rookMagics[s], blockers)
 }
 
 // Queen returns the attack set for a queen on the given square and with
@@ -0,0 +1,92 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package attacks
+
+import (
+	"strings"
+	"testing"
+
+	"laptudirm.com/x/mess/internal/bench"
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move/attacks/magic"
+	"laptudirm.com/x/mess/pkg/board/square"
+)
+
+func TestSliders(t *testing.T) {
+	var rand util.PRNG
+	rand.Seed(1)
+
+	for i := 0; i < 10000; i++ {
+		blockers := bitboard.Board(rand.Uint64() & rand.Uint64())
+
+		for s := square.A8; s <= square.H1; s++ {
+			bishop := magic.BishopMoves(s, blockers, false)
+			rook := magic.RookMoves(s, blockers, false)
+
+			if attacks := Bishop(s, blockers); attacks != bishop {
+				t.Fatalf("bishop %s %#x: got %#x, want %#x", s, blockers, attacks, bishop)
+			}
+
+			if attacks := Rook(s, blockers); attacks != rook {
+				t.Fatalf("rook %s %#x: got %#x, want %#x", s, blockers, attacks, rook)
+			}
+		}
+	}
+}
+
+func BenchmarkRook(b *testing.B) {
+	benchmarkSlider(b, Rook)
+}
+
+func BenchmarkBishop(b *testing.B) {
+	benchmarkSlider(b, Bishop)
+}
+
+func benchmarkSlider(b *testing.B, slider func(square.Square, bitboard.Board) bitboard.Board) {
+	blockers := make([]bitboard.Board, len(bench.FENs))
+	for i, fen := range bench.FENs {
+		blockers[i] = occupancy(fen)
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, occupied := range blockers {
+			for s := square.A8; s <= square.H1; s++ {
+				slider(s, occupied)
+			}
+		}
+	}
+}
+
+// occupancy returns the occupied squares of the given fen's position. The
+// board package can't be used to parse it, since it imports attacks.
+func occupancy(fen string) bitboard.Board {
+	var occupied bitboard.Board
+
+	s := square.A8
+	for _, char := range strings.Fields(fen)[0] {
+		switch {
+		case char == '/':
+			// next rank
+		case char >= '1' && char <= '8':
+			s += square.Square(char - '0') // empty squares
+		default:
+			occupied.Set(s)
+			s++
+		}
+	}
+
+	return occupied
+}
@@ -22,6 +22,10 @@
 // a magic number such that mask * magic >> bits is a perfect contagious
 // hash function. It is simplest to calculate this by generating random
 // magic numbers and checking if they work.
+//
+// The tables use the "fancy" magic layout, where the attack sets of every
+// square are stored contiguously in a single array, and each square only
+// takes up as many entries as it has blocker permutations.
 package magic
 
 import (
@@ -36,7 +40,7 @@ var magicSeeds = [8]uint64{255, 16645, 15100, 12281, 32803, 55013, 10316, 728}
 
 // NewTable generates a new Magic Hash Table from the given moveFunc. It
 // automatically generates the magics and thus is a slow function.
-func NewTable(maskN int, moveFunc MoveFunc) *Table {
+func NewTable(moveFunc MoveFunc) *Table {
 	var t Table
 
 	// populate table
@@ -53,6 +57,11 @@ func NewTable(maskN int, moveFunc MoveFunc) *Table {
 
 		// calculate number of permutations of the blocker mask
 		permutationsN := 1 << bitCount // 2^bitCount
+
+		// the square's attack sets are stored after the previous square's
+		magic.Offset = uint32(len(t.Table))
+		t.Table = append(t.Table, make([]bitboard.Board, permutationsN)...)
+		table := t.Table[magic.Offset:]
 		permutations := make([]bitboard.Board, permutationsN)
 
 		// initialize blocker mask
@@ -72,8 +81,8 @@ func NewTable(maskN int, moveFunc MoveFunc) *Table {
 	searchingMagic:
 		for { // loop until a valid magic is found
 
-			// initialize table entry
-			t.Table[s] = make([]bitboard.Board, maskN)
+			// initialize table entries
+			clear(table)
 
 			// generate a magic candidate
 			magic.Number = rand.SparseUint64()
@@ -86,14 +95,14 @@ func NewTable(maskN int, moveFunc MoveFunc) *Table {
 				index := magic.Index(blockers)          // permutation index
 				attacks := moveFunc(s, blockers, false) // permutation attack set
 
-				if t.Table[s][index] != bitboard.Empty && t.Table[s][index] != attacks {
+				if table[index] != bitboard.Empty && table[index] != attacks {
 					// the calculated index is not empty and the attack sets are not
 					// equal: we have a hash collision. Continue searching the magic
 					continue searchingMagic
 				}
 
 				// no hash collision: store the entry
-				t.Table[s][index] = attacks
+				table[index] = attacks
 			}
 
 			// all permutations were successfully stored without hash collisions,
@@ -107,14 +116,15 @@ func NewTable(maskN int, moveFunc MoveFunc) *Table {
 
 // Table represents a magic hash table.
 type Table struct {
-	Magics [square.N]Magic            // list of magics for each square
-	Table  [square.N][]bitboard.Board // the underlying move-list table
+	Magics [square.N]Magic  // list of magics for each square
+	Table  []bitboard.Board // the underlying move-list table
 }
 
 // Probe probes the magic hash table for the move bitboard given the
 // piece square and blocker mask. It returns the move bitboard.
 func (t *Table) Probe(s square.Square, blockerMask bitboard.Board) bitboard.Board {
-	return t.Table[s][t.Magics[s].Index(blockerMask)]
+	magic := &t.Magics[s]
+	return t.Table[uint64(magic.Offset)+magic.Index(blockerMask)]
 }
 
 // Magic represents a single magic entry. Each magic entry is used to
@@ -123,9 +133,11 @@ type Magic struct {
 	Number      uint64         // magic multiplication number
 	BlockerMask bitboard.Board // mask of relevant blockers
 	Shift       byte           // 64 - no of blocker permutations
+	Offset      uint32         // offset of the square's attack sets
 }
 
-// Index calculates the index of the given blocker mask given it's magic.
+// Index calculates the index of the given blocker mask given it's magic,
+// relative to the offset of the magic's attack sets.
 func (magic Magic) Index(blockerMask bitboard.Board) uint64 {
 	blockerMask &= magic.BlockerMask // remove irrelevant blockers
 	return (uint64(blockerMask) * magic.Number) >> magic.Shift
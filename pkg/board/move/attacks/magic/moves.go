@@ -11,14 +11,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-package main
+package magic
 
 import (
 	"laptudirm.com/x/mess/pkg/board/bitboard"
 	"laptudirm.com/x/mess/pkg/board/square"
 )
 
-func bishop(s square.Square, occ bitboard.Board, isMask bool) bitboard.Board {
+// BishopMoves is the MoveFunc of a bishop.
+func BishopMoves(s square.Square, occ bitboard.Board, isMask bool) bitboard.Board {
 	diagonalMask := bitboard.Diagonals[s.Diagonal()]
 	diagonalAttack := bitboard.Hyperbola(s, occ, diagonalMask)
 
@@ -33,7 +34,8 @@ func bishop(s square.Square, occ bitboard.Board, isMask bool) bitboard.Board {
 	return attacks
 }
 
-func rook(s square.Square, occ bitboard.Board, isMask bool) bitboard.Board {
+// RookMoves is the MoveFunc of a rook.
+func RookMoves(s square.Square, occ bitboard.Board, isMask bool) bitboard.Board {
 	fileMask := bitboard.Files[s.File()]
 	fileAttacks := bitboard.Hyperbola(s, occ, fileMask)
 
@@ -0,0 +1,36 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//go:build !pext || !amd64
+
+package attacks
+
+// usePEXT is always false when the pext backend is not built, so that the
+// compiler can remove it's code paths and inline the magic table probes.
+const usePEXT = false
+
+// pext is a software implementation of the pext instruction, which
+// extracts the bits of x selected by mask into the contiguous low bits
+// of the result. It is unused since usePEXT is always false.
+func pext(x, mask uint64) uint64 {
+	var result uint64
+	for bit := uint64(1); mask != 0; bit <<= 1 {
+		if x&mask&-mask != 0 {
+			result |= bit
+		}
+
+		mask &= mask - 1
+	}
+
+	return result
+}
@@ -0,0 +1,27 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//go:build pext
+
+package attacks
+
+import "laptudirm.com/x/mess/internal/cpu"
+
+// usePEXT reports whether the slider tables are indexed with the pext
+// instruction instead of magic multiplication, which is the case on cpus
+// which support fast bmi2. It is set before the tables are loaded.
+var usePEXT = cpu.HasFastBMI2
+
+// pext executes the pext instruction, which extracts the bits of x
+// selected by mask into the contiguous low bits of the result.
+func pext(x, mask uint64) uint64
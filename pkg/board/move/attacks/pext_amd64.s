@@ -0,0 +1,24 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//go:build pext
+
+#include "textflag.h"
+
+// func pext(x, mask uint64) uint64
+TEXT ·pext(SB), NOSPLIT, $0-24
+	MOVQ  x+0(FP), AX
+	MOVQ  mask+8(FP), CX
+	PEXTQ CX, AX, AX
+	MOVQ  AX, ret+16(FP)
+	RET
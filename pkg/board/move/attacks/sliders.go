@@ -0,0 +1,86 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package attacks
+
+import (
+	"encoding/binary"
+	"unsafe"
+
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move/attacks/magic"
+)
+
+// sliders contains the attack sets of both the sliding pieces, indexed
+// by the offset of the square's magic and the index of the blocker set.
+// It points directly into the embedded blob whenever possible, so that
+// the table doesn't need to be decoded and is paged in lazily.
+var sliders *[slidersN]bitboard.Board
+
+func init() {
+	if len(slidersBlob) != 8*slidersN {
+		panic("attacks: slider blob size doesn't match table size")
+	}
+
+	blob := unsafe.Pointer(unsafe.StringData(slidersBlob))
+	isLittleEndian := binary.NativeEndian.Uint16([]byte{1, 0}) == 1
+
+	if !usePEXT && isLittleEndian && uintptr(blob)%8 == 0 {
+		// the blob is already in the table's memory layout
+		sliders = (*[slidersN]bitboard.Board)(blob)
+		return
+	}
+
+	// decode the blob into a new table
+	data := []byte(slidersBlob)
+	sliders = new([slidersN]bitboard.Board)
+	for i := range sliders {
+		sliders[i] = bitboard.Board(binary.LittleEndian.Uint64(data[8*i:]))
+	}
+
+	if usePEXT {
+		reorderPEXT()
+	}
+}
+
+// probe probes the shared slider table for the attack set of the square
+// with the given magic entry and the given blocker set.
+func probe(m *magic.Magic, blockers bitboard.Board) bitboard.Board {
+	if usePEXT {
+		return sliders[uint64(m.Offset)+pext(uint64(blockers), uint64(m.BlockerMask))]
+	}
+
+	return sliders[uint64(m.Offset)+m.Index(blockers)]
+}
+
+// reorderPEXT reorders the slider tables so that the attack sets of every
+// square are indexed by the pext of the blocker set with the blocker mask,
+// instead of by it's magic index.
+func reorderPEXT() {
+	var buffer [1 << 12]bitboard.Board
+
+	for _, magics := range []*[64]magic.Magic{&rookMagics, &bishopMagics} {
+		for _, m := range magics {
+			// the carry-rippler trick enumerates the subsets of the
+			// mask in increasing order, which is the pext index order
+			var blockers bitboard.Board
+			index := 0
+			for ; blockers != bitboard.Empty || index == 0; index++ {
+				buffer[index] = sliders[uint64(m.Offset)+m.Index(blockers)]
+				blockers = (blockers - m.BlockerMask) & m.BlockerMask
+			}
+
+			copy(sliders[m.Offset:], buffer[:index])
+		}
+	}
+}
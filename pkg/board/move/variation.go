@@ -43,6 +43,12 @@ func (v *Variation) Update(pMove Move, line Variation) {
 	v.moves = append(v.moves, line.moves...)
 }
 
+// Set sets the variation to a copy of the given variation. The variation's
+// own buffer is reused, so the two variations don't share their moves.
+func (v *Variation) Set(line Variation) {
+	v.moves = append(v.moves[:0], line.moves...)
+}
+
 // String converts the variation into a human readable string.
 func (v Variation) String() string {
 	str := fmt.Sprintf("%v", v.moves)
@@ -13,6 +13,8 @@
 
 package board
 
+//go:generate go run laptudirm.com/x/mess/internal/generator/movegen
+
 import (
 	"laptudirm.com/x/mess/pkg/board/bitboard"
 	"laptudirm.com/x/mess/pkg/board/move"
@@ -26,60 +28,222 @@ import (
 // the current position.
 func (b *Board) GenerateMoves(tacticalOnly bool) []move.Move {
 	// initialize movegen state
-	b.moveGenState.Init(tacticalOnly)
-
-	// append moves to movelist
-	if b.moveGenState.CheckN < 2 {
-		// moves of other pieces are only possible
-		// if the king is not in double check
-		b.moveGenState.appendPawnMoves()
-		b.moveGenState.appendKnightMoves()
-		b.moveGenState.appendBishopMoves()
-		b.moveGenState.appendRookMoves()
-		b.moveGenState.appendQueenMoves()
+	b.moveGenState.Init()
+
+	// 31 is the average number of chess moves in a position
+	// source: https://chess.stackexchange.com/a/24325/33336
+	list := make([]move.Move, 0, 31)
+
+	if tacticalOnly {
+		return b.moveGenState.generate(tacticalMoves, list)
 	}
 
-	// king moves are always possible
-	b.moveGenState.appendKingMoves()
+	return b.moveGenState.generate(allMoves, list)
+}
+
+// MoveGenerator is a legal move generator which generates the moves of a
+// position in stages: tactical moves (captures and promotions), and quiet
+// moves. The moves are appended to the provided lists, so no allocations
+// are done if the lists have enough capacity. An initialized generator is
+// valid as long as the board is in the same position.
+type MoveGenerator struct {
+	state moveGenState
+}
+
+// InitGenerator initializes the given move generator for the current
+// position of the board.
+func (b *Board) InitGenerator(generator *MoveGenerator) {
+	generator.state.Board = b
+	generator.state.Init()
+}
 
-	return b.moveGenState.MoveList
+// AppendTacticals appends all the legal captures and promotions in the
+// generator's position to the given list, and returns the extended list.
+func (generator *MoveGenerator) AppendTacticals(list []move.Move) []move.Move {
+	return generator.state.generate(tacticalMoves, list)
 }
 
-func (s *moveGenState) appendKingMoves() {
-	kingSq := s.Kings[s.SideToMove]
+// AppendQuiets appends all the legal moves in the generator's position
+// which are not captures or promotions to the given list, and returns the
+// extended list.
+func (generator *MoveGenerator) AppendQuiets(list []move.Move) []move.Move {
+	return generator.state.generate(quietMoves, list)
+}
 
-	// king can't move to squares occupied by a friend or sen by an enemy
-	kingMoves := attacks.King[kingSq] & s.KingTarget
-	s.serializeMoves(s.King, kingSq, kingMoves)
+// IsLegal reports whether the given move is legal in the generator's
+// position. It is used to verify moves which don't come from the move
+// generator, like moves from the transposition table or killer moves.
+func (generator *MoveGenerator) IsLegal(m move.Move) bool {
+	return generator.state.isLegal(m)
+}
 
-	if !s.TacticalOnly && s.CheckN == 0 {
-		// castling can only occur if king is not in check
-		s.appendCastlingMoves()
+// generate appends the moves of the given type in the current position to
+// the given move list. The state should already be initialized.
+func (s *moveGenState) generate(mode moveGenMode, list []move.Move) []move.Move {
+	s.SetMode(mode, list)
+
+	// use the move generator specialized for the side to move, which is
+	// generated by internal/generator/movegen into sideMoves.go
+	if s.Us == piece.White {
+		s.appendWhiteMoves()
+	} else {
+		s.appendBlackMoves()
 	}
+
+	return s.MoveList
 }
 
-func (s *moveGenState) appendKnightMoves() {
-	// knights pinned in any direction can't move
-	for knights := s.KnightsBB(s.SideToMove) &^ (s.PinnedD | s.PinnedHV); knights != bitboard.Empty; {
-		from := knights.Pop()
-		knightMoves := attacks.Knight[from] & s.Target
-		s.serializeMoves(s.Knight, from, knightMoves)
+// isLegal reports whether the given move is legal in the current position.
+// The move needs to be well formed, i.e. created with move.New. En passant
+// captures are never reported as legal, and are left to the generator.
+func (s *moveGenState) isLegal(m move.Move) bool {
+	source, target := m.Source(), m.Target()
+	fromPiece := m.FromPiece()
+
+	switch {
+	case m == move.Null,
+		fromPiece.Color() != s.Us || s.Position[source] != fromPiece,
+		s.Friends.IsSet(target),
+		m.IsCapture() != s.Enemies.IsSet(target):
+		// moved piece is not ours, target is occupied by our own piece, or
+		// the capture flag doesn't match; this also rules out en passant
+		return false
+
+	case fromPiece.Type() == piece.King:
+		if target-source == 2 || source-target == 2 {
+			// castling move, which is illegal while in check
+			return s.CheckN == 0 && (source == square.E1 || source == square.E8) && s.isCastlingLegal(target)
+		}
+
+		return (attacks.King[source] &^ s.SeenByEnemy).IsSet(target)
+
+	case s.CheckN >= 2, !s.CheckMask.IsSet(target):
+		// only king moves are possible while in double check, while
+		// other moves have to block or capture the checker
+		return false
+
+	case fromPiece.Type() == piece.Pawn:
+		isPromotion := s.PromotionRankBB.IsSet(target)
+		if isPromotion != m.IsPromotion() || (isPromotion && !s.isPromotionValid(m.ToPiece())) {
+			return false
+		}
+
+		if m.IsCapture() {
+			// pawns pinned horizontally or vertically can't capture, while
+			// diagonally pinned pawns can only capture along the pin
+			return attacks.Pawn[s.Us][source].IsSet(target) &&
+				!s.PinnedHV.IsSet(source) &&
+				(!s.PinnedD.IsSet(source) || s.PinnedD.IsSet(target))
+		}
+
+		// pawns pinned diagonally can't push, while horizontally or
+		// vertically pinned pawns can only push along the pin
+		if s.PinnedD.IsSet(source) || (s.PinnedHV.IsSet(source) && !s.PinnedHV.IsSet(target)) {
+			return false
+		}
+
+		switch source {
+		case target + s.Down:
+			// single push
+			return !s.Occupied.IsSet(target)
+		case target + 2*s.Down:
+			// double push
+			middle := target + s.Down
+			return s.DoublePushRankBB.IsSet(middle) && (s.Occupied&(bitboard.Square(middle)|bitboard.Square(target))) == bitboard.Empty
+		default:
+			return false
+		}
+
+	case m.IsPromotion():
+		// only pawns can be promoted
+		return false
 	}
+
+	// moves of the other pieces are their attacks, restricted by pins
+	var moves bitboard.Board
+	switch fromPiece.Type() {
+	case piece.Knight:
+		// pinned knights can't move
+		if !(s.PinnedD | s.PinnedHV).IsSet(source) {
+			moves = attacks.Knight[source]
+		}
+	case piece.Bishop:
+		moves = s.bishopMovesFrom(source)
+	case piece.Rook:
+		moves = s.rookMovesFrom(source)
+	case piece.Queen:
+		moves = s.bishopMovesFrom(source) | s.rookMovesFrom(source)
+	}
+
+	return moves.IsSet(target)
 }
 
-func (s *moveGenState) appendBishopMoves() {
-	s.appendBishopTypeMoves(s.Bishop, s.BishopsBB(s.SideToMove))
+// bishopMovesFrom returns the diagonal moves of a piece on the given square
+// which are allowed by the pin-masks. The check-mask isn't considered.
+func (s *moveGenState) bishopMovesFrom(source square.Square) bitboard.Board {
+	switch {
+	case s.PinnedHV.IsSet(source):
+		// can't move diagonally when pinned horizontally or vertically
+		return bitboard.Empty
+	case s.PinnedD.IsSet(source):
+		// pinned bishops can only move in their pin-mask
+		return attacks.Bishop(source, s.Occupied) & s.PinnedD
+	default:
+		return attacks.Bishop(source, s.Occupied)
+	}
 }
 
-func (s *moveGenState) appendRookMoves() {
-	s.appendRookTypeMoves(s.Rook, s.RooksBB(s.SideToMove))
+// rookMovesFrom returns the horizontal and vertical moves of a piece on
+// the given square which are allowed by the pin-masks. The check-mask
+// isn't considered.
+func (s *moveGenState) rookMovesFrom(source square.Square) bitboard.Board {
+	switch {
+	case s.PinnedD.IsSet(source):
+		// can't move straight when pinned diagonally
+		return bitboard.Empty
+	case s.PinnedHV.IsSet(source):
+		// pinned rooks can only move in their pin-mask
+		return attacks.Rook(source, s.Occupied) & s.PinnedHV
+	default:
+		return attacks.Rook(source, s.Occupied)
+	}
 }
 
-func (s *moveGenState) appendQueenMoves() {
-	queens := s.QueensBB(s.SideToMove)
+// isCastlingLegal reports whether castling to the given target square is
+// legal. The king must not be in check while calling this function.
+func (s *moveGenState) isCastlingLegal(target square.Square) bool {
+	switch target {
+	case square.G1:
+		return s.Us == piece.White && s.CastlingRights&castling.WhiteK != 0 &&
+			(s.Occupied|s.SeenByEnemy)&bitboard.F1G1 == bitboard.Empty
+	case square.C1:
+		return s.Us == piece.White && s.CastlingRights&castling.WhiteQ != 0 &&
+			s.Occupied&bitboard.B1C1D1 == bitboard.Empty &&
+			s.SeenByEnemy&bitboard.C1D1 == bitboard.Empty
+	case square.G8:
+		return s.Us == piece.Black && s.CastlingRights&castling.BlackK != 0 &&
+			(s.Occupied|s.SeenByEnemy)&bitboard.F8G8 == bitboard.Empty
+	case square.C8:
+		return s.Us == piece.Black && s.CastlingRights&castling.BlackQ != 0 &&
+			s.Occupied&bitboard.B8C8D8 == bitboard.Empty &&
+			s.SeenByEnemy&bitboard.C8D8 == bitboard.Empty
+	default:
+		return false
+	}
+}
 
-	s.appendBishopTypeMoves(s.Queen, queens)
-	s.appendRookTypeMoves(s.Queen, queens)
+// isPromotionValid reports whether a pawn can be promoted to the given piece.
+func (s *moveGenState) isPromotionValid(p piece.Piece) bool {
+	if p.Color() != s.Us {
+		return false
+	}
+
+	switch p.Type() {
+	case piece.Knight, piece.Bishop, piece.Rook, piece.Queen:
+		return true
+	default:
+		return false
+	}
 }
 
 // appendBishopTypeMoves appends the moves of any pieces which moves like a bishop.
@@ -122,178 +286,6 @@ func (s *moveGenState) appendRookTypeMoves(rook piece.Piece, rooks bitboard.Boar
 	}
 }
 
-func (s *moveGenState) appendPawnMoves() {
-	s.appendPawnCaptures()
-
-	pushTarget := s.CheckMask &^ s.Occupied
-
-	// pawns that are pinned diagonally or blocked can't push
-	pawnsThatPush := s.PawnsBB(s.SideToMove) &^ s.PinnedD &^ s.Occupied.Down(s.Us)
-
-	pinnedPawnsThatPush := pawnsThatPush & s.PinnedHV
-	unpinnedPawnsThatPush := pawnsThatPush &^ s.PinnedHV
-
-	pinnedPawnPushesSingle := attacks.PawnPush(pinnedPawnsThatPush, s.SideToMove) & s.PinnedHV
-	unpinnedPawnPushesSingle := attacks.PawnPush(unpinnedPawnsThatPush, s.SideToMove)
-
-	pawnPushesSingle := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & pushTarget
-
-	// pawn pushes which result in promotions
-	for promotionPawnPushes := pawnPushesSingle & s.PromotionRankBB; promotionPawnPushes != bitboard.Empty; {
-		to := promotionPawnPushes.Pop()
-		from := to + s.Down
-		s.appendPromotions(move.New(from, to, s.Pawn, false), s.SideToMove)
-	}
-
-	if s.TacticalOnly {
-		// don't append quiet moves
-		return
-	}
-
-	// pawn pushes that don't result in promotions
-	for simplePawnPushes := pawnPushesSingle &^ s.PromotionRankBB; simplePawnPushes != bitboard.Empty; {
-		to := simplePawnPushes.Pop()
-		from := to + s.Down
-		s.AppendMoves(move.New(from, to, s.Pawn, false))
-	}
-
-	// double push is the same as a single push on the single pushed pawns
-	// pawnPushes single is not used since pawn pushes which don't block
-	// checks but whose double pushes do block them are removed
-	pawnPushesDouble := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & s.DoublePushRankBB
-	pawnPushesDouble = attacks.PawnPush(pawnPushesDouble, s.Us) & pushTarget
-
-	// double pawn pushes
-	for pawnPushesDouble != bitboard.Empty {
-		to := pawnPushesDouble.Pop()
-		from := to + s.Down + s.Down
-		s.AppendMoves(move.New(from, to, s.Pawn, false))
-	}
-}
-
-func (s *moveGenState) appendPawnCaptures() {
-	const left = -1
-	const right = 1
-
-	captureTarget := s.Enemies & s.CheckMask
-
-	// pawns that aren't pinned horizantally or vertically
-	// can freely move in diagonal directions
-	pawnsThatAttack := s.PawnsBB(s.SideToMove) &^ s.PinnedHV
-
-	unpinnedPawnsThatAttack := pawnsThatAttack &^ s.PinnedD
-	pinnedPawnsThatAttack := pawnsThatAttack & s.PinnedD
-
-	pawnAttacksL := attacks.PawnsLeft(unpinnedPawnsThatAttack, s.SideToMove) & captureTarget
-	pawnAttacksL |= attacks.PawnsLeft(pinnedPawnsThatAttack, s.SideToMove) & captureTarget & s.PinnedD
-
-	pawnAttacksR := attacks.PawnsRight(unpinnedPawnsThatAttack, s.SideToMove) & captureTarget
-	pawnAttacksR |= attacks.PawnsRight(pinnedPawnsThatAttack, s.SideToMove) & captureTarget & s.PinnedD
-
-	simplePawnAttacksL := pawnAttacksL &^ s.PromotionRankBB
-	simplePawnAttacksR := pawnAttacksR &^ s.PromotionRankBB
-
-	for simplePawnAttacksL != bitboard.Empty {
-		to := simplePawnAttacksL.Pop()
-		from := to + s.Down + right
-		s.AppendMoves(move.New(from, to, s.Pawn, true))
-	}
-
-	for simplePawnAttacksR != bitboard.Empty {
-		to := simplePawnAttacksR.Pop()
-		from := to + s.Down + left
-		s.AppendMoves(move.New(from, to, s.Pawn, true))
-	}
-
-	promotionPawnAttacksL := pawnAttacksL & s.PromotionRankBB
-	promotionPawnAttacksR := pawnAttacksR & s.PromotionRankBB
-
-	for promotionPawnAttacksL != bitboard.Empty {
-		to := promotionPawnAttacksL.Pop()
-		from := to + s.Down + right
-		s.appendPromotions(move.New(from, to, s.Pawn, true), s.SideToMove)
-	}
-
-	for promotionPawnAttacksR != bitboard.Empty {
-		to := promotionPawnAttacksR.Pop()
-		from := to + s.Down + left
-		s.appendPromotions(move.New(from, to, s.Pawn, true), s.SideToMove)
-	}
-
-	// append en passant capture
-	if s.EnPassantTarget != square.None {
-		epPawn := s.EnPassantTarget + s.Down
-
-		epMask := bitboard.Square(s.EnPassantTarget) | bitboard.Square(epPawn)
-		// check if en-passant leaves king in check
-		// this does not account for the double rook pin
-		if s.CheckMask&epMask == 0 {
-			return
-		}
-
-		kingSq := s.Kings[s.SideToMove]
-		kingMask := bitboard.Square(kingSq) & s.EnPassantRankBB
-
-		enemyRooksQueens := (s.RooksBB(s.Them) | s.QueensBB(s.Them)) & s.EnPassantRankBB
-
-		// if king and enemy horizontal sliding piece are on ep rank
-		// a horizontal rook pin may be possible so more checks
-		isPossiblePin := kingMask != bitboard.Empty && enemyRooksQueens != bitboard.Empty
-
-		for fromBB := attacks.Pawn[s.Them][s.EnPassantTarget] & pawnsThatAttack; fromBB != bitboard.Empty; {
-			from := fromBB.Pop()
-
-			// pawn is pinned in other direction
-			if s.PinnedD.IsSet(from) && !s.PinnedD.IsSet(s.EnPassantTarget) {
-				continue
-			}
-
-			// check for horizontal rook pin
-			// remove the ep pawn and the enemy pawn from the blocker mask
-			// and check if a rook ray from the king hits any rook or queen
-			pawnsMask := bitboard.Square(from) | bitboard.Square(epPawn)
-			if isPossiblePin && attacks.Rook(kingSq, s.Occupied&^pawnsMask)&enemyRooksQueens != 0 {
-				break
-			}
-
-			s.AppendMoves(move.New(from, s.EnPassantTarget, s.Pawn, true))
-		}
-	}
-}
-
-func (s *moveGenState) appendCastlingMoves() {
-	// for each castling move the following things are checked:
-	// 1. if castling that side is legal (king and rook haven't moved)
-	// 2. if pieces are occupying the space between the king and rook
-	// 3. if the squares that the king moves through are seen by the enemy
-	// if all the conditions are satisfied then castling that side is legal
-
-	switch s.SideToMove {
-	case piece.White:
-		if s.CastlingRights&castling.WhiteK != 0 &&
-			(s.Occupied|s.SeenByEnemy)&bitboard.F1G1 == bitboard.Empty {
-			s.AppendMoves(move.New(square.E1, square.G1, piece.WhiteKing, false))
-		}
-
-		if s.CastlingRights&castling.WhiteQ != 0 &&
-			s.Occupied&bitboard.B1C1D1 == bitboard.Empty &&
-			s.SeenByEnemy&bitboard.C1D1 == bitboard.Empty {
-			s.AppendMoves(move.New(square.E1, square.C1, piece.WhiteKing, false))
-		}
-	case piece.Black:
-		if s.CastlingRights&castling.BlackK != 0 &&
-			(s.Occupied|s.SeenByEnemy)&bitboard.F8G8 == bitboard.Empty {
-			s.AppendMoves(move.New(square.E8, square.G8, piece.BlackKing, false))
-		}
-
-		if s.CastlingRights&castling.BlackQ != 0 &&
-			s.Occupied&bitboard.B8C8D8 == bitboard.Empty &&
-			s.SeenByEnemy&bitboard.C8D8 == bitboard.Empty {
-			s.AppendMoves(move.New(square.E8, square.C8, piece.BlackKing, false))
-		}
-	}
-}
-
 // serializeMoves serialized the given move bitboard into the movelist.
 func (s *moveGenState) serializeMoves(p piece.Piece, from square.Square, moves bitboard.Board) {
 	// append captures
@@ -302,7 +294,7 @@ func (s *moveGenState) serializeMoves(p piece.Piece, from square.Square, moves b
 		s.AppendMoves(move.New(from, to, p, true))
 	}
 
-	if s.TacticalOnly {
+	if s.Mode == tacticalMoves {
 		// don't serialize quiet moves
 		return
 	}
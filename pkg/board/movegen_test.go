@@ -0,0 +1,123 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package board_test
+
+import (
+	"strings"
+	"testing"
+
+	"laptudirm.com/x/mess/internal/bench"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+)
+
+func TestMoveGenerator(t *testing.T) {
+	for _, test := range strings.Split(strings.TrimSpace(perftTests), "\n") {
+		fenString, _, _ := strings.Cut(test, " ; ")
+		b := board.New(board.FEN(fen.FromString(fenString)))
+		testMoveGenerator(t, b, 4, nil)
+	}
+}
+
+// testMoveGenerator checks the staged move generator against GenerateMoves
+// in every position of the tree of the given depth. The moves which were
+// legal in the ancestors of each position are used as candidates for
+// testing IsLegal on moves which weren't generated in the position.
+func testMoveGenerator(t *testing.T, b *board.Board, depth int, candidates []move.Move) {
+	var generator board.MoveGenerator
+	b.InitGenerator(&generator)
+
+	tacticals := generator.AppendTacticals(nil)
+	quiets := generator.AppendQuiets(nil)
+	moves := b.GenerateMoves(false)
+
+	legal := make(map[move.Move]bool, len(moves))
+	for _, m := range moves {
+		legal[m] = true
+	}
+
+	if len(tacticals)+len(quiets) != len(moves) {
+		t.Fatalf("%s: %d tacticals and %d quiets, %d moves", b.FEN(), len(tacticals), len(quiets), len(moves))
+	}
+
+	for _, m := range append(tacticals, quiets...) {
+		if !legal[m] {
+			t.Fatalf("%s: staged move %s not generated", b.FEN(), m)
+		}
+
+		if m.IsQuiet() == contains(tacticals, m) {
+			t.Fatalf("%s: move %s generated in the wrong stage", b.FEN(), m)
+		}
+	}
+
+	for _, m := range append(candidates, moves...) {
+		// en passant captures are left to the generator
+		want := legal[m] && !m.IsEnPassant(b.EnPassantTarget)
+		if generator.IsLegal(m) != want {
+			t.Fatalf("%s: IsLegal(%s) = %v", b.FEN(), m, !want)
+		}
+	}
+
+	if depth == 1 {
+		return
+	}
+
+	candidates = append(candidates, moves...)
+	for _, m := range moves {
+		b.MakeMove(m)
+		testMoveGenerator(t, b, depth-1, candidates)
+		b.UnmakeMove()
+	}
+}
+
+func contains(moves []move.Move, m move.Move) bool {
+	for _, move := range moves {
+		if move == m {
+			return true
+		}
+	}
+
+	return false
+}
+
+func BenchmarkGenerateMoves(b *testing.B) {
+	benchmarkGenerateMoves(b, false)
+}
+
+func BenchmarkGenerateTacticals(b *testing.B) {
+	benchmarkGenerateMoves(b, true)
+}
+
+func benchmarkGenerateMoves(b *testing.B, tacticalOnly bool) {
+	boards := benchBoards()
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, chessboard := range boards {
+			chessboard.GenerateMoves(tacticalOnly)
+		}
+	}
+}
+
+// benchBoards returns boards of all the bench positions.
+func benchBoards() []*board.Board {
+	boards := make([]*board.Board, len(bench.FENs))
+	for i, fenString := range bench.FENs {
+		boards[i] = board.New(board.FEN(fen.FromString(fenString)))
+	}
+
+	return boards
+}
@@ -13,44 +13,163 @@
 
 package board
 
-import "fmt"
+import (
+	"math/bits"
+	"sync"
+	"sync/atomic"
 
-func Perft(b *Board, depth int) int {
-	if depth == 0 {
-		return 1
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+)
+
+// PerftConfig contains the configuration of a perft run.
+type PerftConfig struct {
+	// number of goroutines the root moves are split among
+	Threads int
+
+	// size of the perft hash table in MB, 0 disables hashing
+	Hash int
+}
+
+// Divide contains the perft result of a single root move.
+type Divide struct {
+	Move  move.Move
+	Nodes int
+}
+
+// Perft counts the number of leaf nodes of the legal move tree of the given
+// depth, from the board's position. The node counts of each root move are
+// returned in the order they were generated in, along with the total. The
+// root moves are split among the configured number of goroutines, each of
+// which uses it's own copy of the board, so the board itself isn't changed.
+// https://www.chessprogramming.org/Perft
+func Perft(b *Board, depth int, config PerftConfig) ([]Divide, int) {
+	if depth <= 0 {
+		return nil, 1
 	}
 
-	var nodes int
 	moves := b.GenerateMoves(false)
+	divide := make([]Divide, len(moves))
 
-	for _, move := range moves {
-		b.MakeMove(move)
-		newNodes := perft(b, depth-1)
-		fmt.Printf("%s: %d\n", move, newNodes)
-		nodes += newNodes
-		b.UnmakeMove()
+	table := newPerftTable(config.Hash)
+
+	var next atomic.Int64 // index of the next root move to be counted
+	var workers sync.WaitGroup
+
+	for thread := 0; thread < max(config.Threads, 1); thread++ {
+		workers.Add(1)
+		go func() {
+			defer workers.Done()
+
+			// each worker has it's own board
+			worker := b.Clone()
+
+			for i := int(next.Add(1) - 1); i < len(moves); i = int(next.Add(1) - 1) {
+				worker.MakeMove(moves[i])
+				divide[i] = Divide{
+					Move:  moves[i],
+					Nodes: worker.perft(depth-1, table),
+				}
+				worker.UnmakeMove()
+			}
+		}()
 	}
 
-	return nodes
-}
+	workers.Wait()
 
-func perft(b *Board, depth int) int {
+	nodes := 0
+	for _, result := range divide {
+		nodes += result.Nodes
+	}
 
+	return divide, nodes
+}
+
+// perft returns the number of leaf nodes of the legal move tree of the given
+// depth from the current position. The given hash table may be nil.
+func (b *Board) perft(depth int, table *perftTable) int {
 	switch depth {
 	case 0:
 		return 1
 	case 1:
+		// bulk counting
 		return len(b.GenerateMoves(false))
-	default:
-		var nodes int
-		moves := b.GenerateMoves(false)
-
-		for _, move := range moves {
-			b.MakeMove(move)
-			nodes += perft(b, depth-1)
-			b.UnmakeMove()
-		}
+	}
 
+	if nodes, hit := table.probe(b.Hash, depth); hit {
 		return nodes
 	}
+
+	var nodes int
+	for _, move := range b.GenerateMoves(false) {
+		b.MakeMove(move)
+		nodes += b.perft(depth-1, table)
+		b.UnmakeMove()
+	}
+
+	table.store(b.Hash, depth, nodes)
+	return nodes
+}
+
+// perftTable is a lock-free hash table which stores the node counts of
+// positions at a given depth. An entry's key is xor-ed with it's data, so
+// that entries which were torn by concurrent writes are never probed.
+type perftTable struct {
+	entries []perftEntry
+}
+
+// perftEntry is an entry of the perft hash table. Data contains the node
+// count shifted left by 8 bits, with the depth in the low 8 bits.
+type perftEntry struct {
+	key, data atomic.Uint64
+}
+
+// newPerftTable creates a new perft hash table of the given size in MB. A
+// nil table, which doesn't store anything, is returned for zero sizes.
+func newPerftTable(mbs int) *perftTable {
+	size := mbs * 1024 * 1024 / 16 // 16 bytes per entry
+	if size <= 0 {
+		return nil
+	}
+
+	return &perftTable{entries: make([]perftEntry, size)}
+}
+
+// probe returns the node count of the given position at the given depth.
+func (table *perftTable) probe(hash zobrist.Key, depth int) (int, bool) {
+	if table == nil {
+		return 0, false
+	}
+
+	entry := table.fetch(hash)
+
+	data := entry.data.Load()
+	key := entry.key.Load()
+
+	if key^data != uint64(hash) || data&0xff != uint64(depth) {
+		return 0, false
+	}
+
+	return int(data >> 8), true
+}
+
+// store stores the node count of the given position at the given depth.
+func (table *perftTable) store(hash zobrist.Key, depth, nodes int) {
+	if table == nil {
+		return
+	}
+
+	entry := table.fetch(hash)
+
+	data := uint64(nodes)<<8 | uint64(depth)
+	entry.data.Store(data)
+	entry.key.Store(uint64(hash) ^ data)
+}
+
+// fetch returns the entry of the given hash.
+func (table *perftTable) fetch(hash zobrist.Key) *perftEntry {
+	// fast indexing function from Daniel Lemire's blog post
+	// https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
+	index, _ := bits.Mul(uint(hash), uint(len(table.entries)))
+	return &table.entries[index]
 }
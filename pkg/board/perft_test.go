@@ -2,6 +2,7 @@ package board_test
 
 import (
 	"fmt"
+	"runtime"
 	"strconv"
 	"strings"
 	"testing"
@@ -167,7 +168,10 @@ func TestPerft(t *testing.T) {
 	for _, test := range tests {
 		t.Run(fmt.Sprintf("perft(%d) of %s", test.depth, test.fen), func(*testing.T) {
 			bo := board.New(board.FEN(test.fen))
-			result := board.Perft(bo, test.depth)
+			_, result := board.Perft(bo, test.depth, board.PerftConfig{
+				Threads: runtime.NumCPU(),
+				Hash:    16,
+			})
 			if result != test.perft {
 				t.Errorf("perft(%d) of %s: got %d instead of %d\n", test.depth, test.fen, result, test.perft)
 			}
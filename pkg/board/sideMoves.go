@@ -0,0 +1,458 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Code generated by go generate; DO NOT EDIT THE CONTENTS OF THIS FILE
+// The source code for the generator can be found at generator/movegen
+
+package board
+
+import (
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/move/attacks"
+	"laptudirm.com/x/mess/pkg/board/move/castling"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+)
+
+// appendWhiteMoves appends the moves of the current mode to the
+// movelist, with White to move.
+func (s *moveGenState) appendWhiteMoves() {
+	if s.CheckN < 2 {
+		// moves of other pieces are only possible
+		// if the king is not in double check
+		s.appendWhitePawnMoves()
+		s.appendWhiteKnightMoves()
+		s.appendWhiteBishopMoves()
+		s.appendWhiteRookMoves()
+		s.appendWhiteQueenMoves()
+	}
+
+	// king moves are always possible
+	s.appendWhiteKingMoves()
+}
+
+func (s *moveGenState) appendWhiteKingMoves() {
+	kingSq := s.Kings[piece.White]
+
+	// king can't move to squares occupied by a friend or sen by an enemy
+	kingMoves := attacks.King[kingSq] & s.KingTarget
+	s.serializeMoves(piece.WhiteKing, kingSq, kingMoves)
+
+	if s.Mode != tacticalMoves && s.CheckN == 0 {
+		// castling can only occur if king is not in check
+		s.appendWhiteCastlingMoves()
+	}
+}
+
+func (s *moveGenState) appendWhiteKnightMoves() {
+	// knights pinned in any direction can't move
+	for knights := s.KnightsBB(piece.White) &^ (s.PinnedD | s.PinnedHV); knights != bitboard.Empty; {
+		from := knights.Pop()
+		knightMoves := attacks.Knight[from] & s.Target
+		s.serializeMoves(piece.WhiteKnight, from, knightMoves)
+	}
+}
+
+func (s *moveGenState) appendWhiteBishopMoves() {
+	s.appendBishopTypeMoves(piece.WhiteBishop, s.BishopsBB(piece.White))
+}
+
+func (s *moveGenState) appendWhiteRookMoves() {
+	s.appendRookTypeMoves(piece.WhiteRook, s.RooksBB(piece.White))
+}
+
+func (s *moveGenState) appendWhiteQueenMoves() {
+	queens := s.QueensBB(piece.White)
+
+	s.appendBishopTypeMoves(piece.WhiteQueen, queens)
+	s.appendRookTypeMoves(piece.WhiteQueen, queens)
+}
+
+func (s *moveGenState) appendWhitePawnMoves() {
+	if s.Mode != quietMoves {
+		s.appendWhitePawnCaptures()
+	}
+
+	pushTarget := s.CheckMask &^ s.Occupied
+
+	// pawns that are pinned diagonally or blocked can't push
+	pawnsThatPush := s.PawnsBB(piece.White) &^ s.PinnedD &^ s.Occupied.South()
+
+	pinnedPawnsThatPush := pawnsThatPush & s.PinnedHV
+	unpinnedPawnsThatPush := pawnsThatPush &^ s.PinnedHV
+
+	pinnedPawnPushesSingle := pinnedPawnsThatPush.North() & s.PinnedHV
+	unpinnedPawnPushesSingle := unpinnedPawnsThatPush.North()
+
+	pawnPushesSingle := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & pushTarget
+
+	if s.Mode != quietMoves {
+		// pawn pushes which result in promotions
+		for promotionPawnPushes := pawnPushesSingle & bitboard.Rank8; promotionPawnPushes != bitboard.Empty; {
+			to := promotionPawnPushes.Pop()
+			from := to + 8
+			s.appendPromotions(move.New(from, to, piece.WhitePawn, false), piece.White)
+		}
+	}
+
+	if s.Mode == tacticalMoves {
+		// don't append quiet moves
+		return
+	}
+
+	// pawn pushes that don't result in promotions
+	for simplePawnPushes := pawnPushesSingle &^ bitboard.Rank8; simplePawnPushes != bitboard.Empty; {
+		to := simplePawnPushes.Pop()
+		from := to + 8
+		s.AppendMoves(move.New(from, to, piece.WhitePawn, false))
+	}
+
+	// double push is the same as a single push on the single pushed pawns
+	// pawnPushes single is not used since pawn pushes which don't block
+	// checks but whose double pushes do block them are removed
+	pawnPushesDouble := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & bitboard.Rank3
+	pawnPushesDouble = pawnPushesDouble.North() & pushTarget
+
+	// double pawn pushes
+	for pawnPushesDouble != bitboard.Empty {
+		to := pawnPushesDouble.Pop()
+		from := to + 16
+		s.AppendMoves(move.New(from, to, piece.WhitePawn, false))
+	}
+}
+
+func (s *moveGenState) appendWhitePawnCaptures() {
+	const left = -1
+	const right = 1
+
+	captureTarget := s.Enemies & s.CheckMask
+
+	// pawns that aren't pinned horizantally or vertically
+	// can freely move in diagonal directions
+	pawnsThatAttack := s.PawnsBB(piece.White) &^ s.PinnedHV
+
+	unpinnedPawnsThatAttack := pawnsThatAttack &^ s.PinnedD
+	pinnedPawnsThatAttack := pawnsThatAttack & s.PinnedD
+
+	pawnAttacksL := unpinnedPawnsThatAttack.North().West() & captureTarget
+	pawnAttacksL |= pinnedPawnsThatAttack.North().West() & captureTarget & s.PinnedD
+
+	pawnAttacksR := unpinnedPawnsThatAttack.North().East() & captureTarget
+	pawnAttacksR |= pinnedPawnsThatAttack.North().East() & captureTarget & s.PinnedD
+
+	simplePawnAttacksL := pawnAttacksL &^ bitboard.Rank8
+	simplePawnAttacksR := pawnAttacksR &^ bitboard.Rank8
+
+	for simplePawnAttacksL != bitboard.Empty {
+		to := simplePawnAttacksL.Pop()
+		from := to + 8 + right
+		s.AppendMoves(move.New(from, to, piece.WhitePawn, true))
+	}
+
+	for simplePawnAttacksR != bitboard.Empty {
+		to := simplePawnAttacksR.Pop()
+		from := to + 8 + left
+		s.AppendMoves(move.New(from, to, piece.WhitePawn, true))
+	}
+
+	promotionPawnAttacksL := pawnAttacksL & bitboard.Rank8
+	promotionPawnAttacksR := pawnAttacksR & bitboard.Rank8
+
+	for promotionPawnAttacksL != bitboard.Empty {
+		to := promotionPawnAttacksL.Pop()
+		from := to + 8 + right
+		s.appendPromotions(move.New(from, to, piece.WhitePawn, true), piece.White)
+	}
+
+	for promotionPawnAttacksR != bitboard.Empty {
+		to := promotionPawnAttacksR.Pop()
+		from := to + 8 + left
+		s.appendPromotions(move.New(from, to, piece.WhitePawn, true), piece.White)
+	}
+
+	// append en passant capture
+	if s.EnPassantTarget != square.None {
+		epPawn := s.EnPassantTarget + 8
+
+		epMask := bitboard.Square(s.EnPassantTarget) | bitboard.Square(epPawn)
+		// check if en-passant leaves king in check
+		// this does not account for the double rook pin
+		if s.CheckMask&epMask == 0 {
+			return
+		}
+
+		kingSq := s.Kings[piece.White]
+		kingMask := bitboard.Square(kingSq) & bitboard.Rank5
+
+		enemyRooksQueens := (s.RooksBB(piece.Black) | s.QueensBB(piece.Black)) & bitboard.Rank5
+
+		// if king and enemy horizontal sliding piece are on ep rank
+		// a horizontal rook pin may be possible so more checks
+		isPossiblePin := kingMask != bitboard.Empty && enemyRooksQueens != bitboard.Empty
+
+		for fromBB := attacks.Pawn[piece.Black][s.EnPassantTarget] & pawnsThatAttack; fromBB != bitboard.Empty; {
+			from := fromBB.Pop()
+
+			// pawn is pinned in other direction
+			if s.PinnedD.IsSet(from) && !s.PinnedD.IsSet(s.EnPassantTarget) {
+				continue
+			}
+
+			// check for horizontal rook pin
+			// remove the ep pawn and the enemy pawn from the blocker mask
+			// and check if a rook ray from the king hits any rook or queen
+			pawnsMask := bitboard.Square(from) | bitboard.Square(epPawn)
+			if isPossiblePin && attacks.Rook(kingSq, s.Occupied&^pawnsMask)&enemyRooksQueens != 0 {
+				break
+			}
+
+			s.AppendMoves(move.New(from, s.EnPassantTarget, piece.WhitePawn, true))
+		}
+	}
+}
+
+func (s *moveGenState) appendWhiteCastlingMoves() {
+	// for each castling move the following things are checked:
+	// 1. if castling that side is legal (king and rook haven't moved)
+	// 2. if pieces are occupying the space between the king and rook
+	// 3. if the squares that the king moves through are seen by the enemy
+	// if all the conditions are satisfied then castling that side is legal
+
+	if s.CastlingRights&castling.WhiteK != 0 &&
+		(s.Occupied|s.SeenByEnemy)&bitboard.F1G1 == bitboard.Empty {
+		s.AppendMoves(move.New(square.E1, square.G1, piece.WhiteKing, false))
+	}
+
+	if s.CastlingRights&castling.WhiteQ != 0 &&
+		s.Occupied&bitboard.B1C1D1 == bitboard.Empty &&
+		s.SeenByEnemy&bitboard.C1D1 == bitboard.Empty {
+		s.AppendMoves(move.New(square.E1, square.C1, piece.WhiteKing, false))
+	}
+}
+
+// appendBlackMoves appends the moves of the current mode to the
+// movelist, with Black to move.
+func (s *moveGenState) appendBlackMoves() {
+	if s.CheckN < 2 {
+		// moves of other pieces are only possible
+		// if the king is not in double check
+		s.appendBlackPawnMoves()
+		s.appendBlackKnightMoves()
+		s.appendBlackBishopMoves()
+		s.appendBlackRookMoves()
+		s.appendBlackQueenMoves()
+	}
+
+	// king moves are always possible
+	s.appendBlackKingMoves()
+}
+
+func (s *moveGenState) appendBlackKingMoves() {
+	kingSq := s.Kings[piece.Black]
+
+	// king can't move to squares occupied by a friend or sen by an enemy
+	kingMoves := attacks.King[kingSq] & s.KingTarget
+	s.serializeMoves(piece.BlackKing, kingSq, kingMoves)
+
+	if s.Mode != tacticalMoves && s.CheckN == 0 {
+		// castling can only occur if king is not in check
+		s.appendBlackCastlingMoves()
+	}
+}
+
+func (s *moveGenState) appendBlackKnightMoves() {
+	// knights pinned in any direction can't move
+	for knights := s.KnightsBB(piece.Black) &^ (s.PinnedD | s.PinnedHV); knights != bitboard.Empty; {
+		from := knights.Pop()
+		knightMoves := attacks.Knight[from] & s.Target
+		s.serializeMoves(piece.BlackKnight, from, knightMoves)
+	}
+}
+
+func (s *moveGenState) appendBlackBishopMoves() {
+	s.appendBishopTypeMoves(piece.BlackBishop, s.BishopsBB(piece.Black))
+}
+
+func (s *moveGenState) appendBlackRookMoves() {
+	s.appendRookTypeMoves(piece.BlackRook, s.RooksBB(piece.Black))
+}
+
+func (s *moveGenState) appendBlackQueenMoves() {
+	queens := s.QueensBB(piece.Black)
+
+	s.appendBishopTypeMoves(piece.BlackQueen, queens)
+	s.appendRookTypeMoves(piece.BlackQueen, queens)
+}
+
+func (s *moveGenState) appendBlackPawnMoves() {
+	if s.Mode != quietMoves {
+		s.appendBlackPawnCaptures()
+	}
+
+	pushTarget := s.CheckMask &^ s.Occupied
+
+	// pawns that are pinned diagonally or blocked can't push
+	pawnsThatPush := s.PawnsBB(piece.Black) &^ s.PinnedD &^ s.Occupied.North()
+
+	pinnedPawnsThatPush := pawnsThatPush & s.PinnedHV
+	unpinnedPawnsThatPush := pawnsThatPush &^ s.PinnedHV
+
+	pinnedPawnPushesSingle := pinnedPawnsThatPush.South() & s.PinnedHV
+	unpinnedPawnPushesSingle := unpinnedPawnsThatPush.South()
+
+	pawnPushesSingle := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & pushTarget
+
+	if s.Mode != quietMoves {
+		// pawn pushes which result in promotions
+		for promotionPawnPushes := pawnPushesSingle & bitboard.Rank1; promotionPawnPushes != bitboard.Empty; {
+			to := promotionPawnPushes.Pop()
+			from := to - 8
+			s.appendPromotions(move.New(from, to, piece.BlackPawn, false), piece.Black)
+		}
+	}
+
+	if s.Mode == tacticalMoves {
+		// don't append quiet moves
+		return
+	}
+
+	// pawn pushes that don't result in promotions
+	for simplePawnPushes := pawnPushesSingle &^ bitboard.Rank1; simplePawnPushes != bitboard.Empty; {
+		to := simplePawnPushes.Pop()
+		from := to - 8
+		s.AppendMoves(move.New(from, to, piece.BlackPawn, false))
+	}
+
+	// double push is the same as a single push on the single pushed pawns
+	// pawnPushes single is not used since pawn pushes which don't block
+	// checks but whose double pushes do block them are removed
+	pawnPushesDouble := (pinnedPawnPushesSingle | unpinnedPawnPushesSingle) & bitboard.Rank6
+	pawnPushesDouble = pawnPushesDouble.South() & pushTarget
+
+	// double pawn pushes
+	for pawnPushesDouble != bitboard.Empty {
+		to := pawnPushesDouble.Pop()
+		from := to - 16
+		s.AppendMoves(move.New(from, to, piece.BlackPawn, false))
+	}
+}
+
+func (s *moveGenState) appendBlackPawnCaptures() {
+	const left = -1
+	const right = 1
+
+	captureTarget := s.Enemies & s.CheckMask
+
+	// pawns that aren't pinned horizantally or vertically
+	// can freely move in diagonal directions
+	pawnsThatAttack := s.PawnsBB(piece.Black) &^ s.PinnedHV
+
+	unpinnedPawnsThatAttack := pawnsThatAttack &^ s.PinnedD
+	pinnedPawnsThatAttack := pawnsThatAttack & s.PinnedD
+
+	pawnAttacksL := unpinnedPawnsThatAttack.South().West() & captureTarget
+	pawnAttacksL |= pinnedPawnsThatAttack.South().West() & captureTarget & s.PinnedD
+
+	pawnAttacksR := unpinnedPawnsThatAttack.South().East() & captureTarget
+	pawnAttacksR |= pinnedPawnsThatAttack.South().East() & captureTarget & s.PinnedD
+
+	simplePawnAttacksL := pawnAttacksL &^ bitboard.Rank1
+	simplePawnAttacksR := pawnAttacksR &^ bitboard.Rank1
+
+	for simplePawnAttacksL != bitboard.Empty {
+		to := simplePawnAttacksL.Pop()
+		from := to - 8 + right
+		s.AppendMoves(move.New(from, to, piece.BlackPawn, true))
+	}
+
+	for simplePawnAttacksR != bitboard.Empty {
+		to := simplePawnAttacksR.Pop()
+		from := to - 8 + left
+		s.AppendMoves(move.New(from, to, piece.BlackPawn, true))
+	}
+
+	promotionPawnAttacksL := pawnAttacksL & bitboard.Rank1
+	promotionPawnAttacksR := pawnAttacksR & bitboard.Rank1
+
+	for promotionPawnAttacksL != bitboard.Empty {
+		to := promotionPawnAttacksL.Pop()
+		from := to - 8 + right
+		s.appendPromotions(move.New(from, to, piece.BlackPawn, true), piece.Black)
+	}
+
+	for promotionPawnAttacksR != bitboard.Empty {
+		to := promotionPawnAttacksR.Pop()
+		from := to - 8 + left
+		s.appendPromotions(move.New(from, to, piece.BlackPawn, true), piece.Black)
+	}
+
+	// append en passant capture
+	if s.EnPassantTarget != square.None {
+		epPawn := s.EnPassantTarget - 8
+
+		epMask := bitboard.Square(s.EnPassantTarget) | bitboard.Square(epPawn)
+		// check if en-passant leaves king in check
+		// this does not account for the double rook pin
+		if s.CheckMask&epMask == 0 {
+			return
+		}
+
+		kingSq := s.Kings[piece.Black]
+		kingMask := bitboard.Square(kingSq) & bitboard.Rank4
+
+		enemyRooksQueens := (s.RooksBB(piece.White) | s.QueensBB(piece.White)) & bitboard.Rank4
+
+		// if king and enemy horizontal sliding piece are on ep rank
+		// a horizontal rook pin may be possible so more checks
+		isPossiblePin := kingMask != bitboard.Empty && enemyRooksQueens != bitboard.Empty
+
+		for fromBB := attacks.Pawn[piece.White][s.EnPassantTarget] & pawnsThatAttack; fromBB != bitboard.Empty; {
+			from := fromBB.Pop()
+
+			// pawn is pinned in other direction
+			if s.PinnedD.IsSet(from) && !s.PinnedD.IsSet(s.EnPassantTarget) {
+				continue
+			}
+
+			// check for horizontal rook pin
+			// remove the ep pawn and the enemy pawn from the blocker mask
+			// and check if a rook ray from the king hits any rook or queen
+			pawnsMask := bitboard.Square(from) | bitboard.Square(epPawn)
+			if isPossiblePin && attacks.Rook(kingSq, s.Occupied&^pawnsMask)&enemyRooksQueens != 0 {
+				break
+			}
+
+			s.AppendMoves(move.New(from, s.EnPassantTarget, piece.BlackPawn, true))
+		}
+	}
+}
+
+func (s *moveGenState) appendBlackCastlingMoves() {
+	// for each castling move the following things are checked:
+	// 1. if castling that side is legal (king and rook haven't moved)
+	// 2. if pieces are occupying the space between the king and rook
+	// 3. if the squares that the king moves through are seen by the enemy
+	// if all the conditions are satisfied then castling that side is legal
+
+	if s.CastlingRights&castling.BlackK != 0 &&
+		(s.Occupied|s.SeenByEnemy)&bitboard.F8G8 == bitboard.Empty {
+		s.AppendMoves(move.New(square.E8, square.G8, piece.BlackKing, false))
+	}
+
+	if s.CastlingRights&castling.BlackQ != 0 &&
+		s.Occupied&bitboard.B8C8D8 == bitboard.Empty &&
+		s.SeenByEnemy&bitboard.C8D8 == bitboard.Empty {
+		s.AppendMoves(move.New(square.E8, square.C8, piece.BlackKing, false))
+	}
+}
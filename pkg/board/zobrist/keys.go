@@ -48,3 +48,10 @@ var Castling = [16]Key{ 0x4d28598573750b10, 0xdfe34de8892603ad, 0x177ab8314c2b20
 // SideToMove represents the zobrist key for when the side to move is
 // black. There is no zobrist key for when the side to move is white.
 var SideToMove Key = 0x5ec3a196160b9a06
+
+// PawnSquare contains the zobrist keys used by the pawn hash for pawns of
+// each color on every square. It can be indexed by PawnSquare[color][square].
+var PawnSquare = [2][64]Key{
+	{ 0x337c18b0cd0e86a7, 0xff6c046e606225e9, 0x80eeedae5078b96d, 0x0c68b1d7a0f28741, 0x198708d693a2f95d, 0xa45de59cdbe02f53, 0x0dd0847a69a5e100, 0x4b2b7e3330f04e0f, 0xd345b8677b52bd29, 0xc780b7300e06f99c, 0xe26f01ca2dcc6ad5, 0x07d5e5230efa0a94, 0xf715be9f448d202a, 0x047b9bc8e5e93a6c, 0x37fb7f315290946f, 0x485216112261879a, 0x57f5694440b69194, 0xcc17e94419cd5e66, 0x35a72f6204f1e515, 0xad259335d66f9135, 0x88ecb9148350f54f, 0xe8eac7472cdd1ef4, 0xdd9006177e43634e, 0xcffacbb2cf8871b2, 0x57129e16e6ebbed2, 0x0d4fbfe0f3ff53d6, 0xb6a5d13cb272a381, 0x1844eb3dad1fb815, 0xd19c59c2f548b26c, 0x05b701c6f95994c8, 0x8168ac79b73e5339, 0x5e6441ba667717cf, 0x30524dd8a3f15b1f, 0xde4210144fc49def, 0x23edc36e393ef382, 0x84ab668582956820, 0x5ac9bb40236ced10, 0x3ac66174a4749d5e, 0xd574181c61bf7174, 0xff45cbfae7e44e00, 0xa4cd93fd9d7b84cb, 0x9b43c37e2e2a424f, 0x24c3ef82a0245bfb, 0x04261b9c1558ff68, 0xbbf588a0a4ca2f25, 0x370934be3f09bc06, 0xe7d2b6e21846b7c8, 0x5d733d10c6fc0ae2, 0x0a61c5af590bf8fd, 0x101dabdba44db996, 0xca90cb9c7522ef74, 0xe22bbb910a9b0fa4, 0x74490da8f6c18b8b, 0x596053edef9696c7, 0x90c519f9eab1b4b7, 0xb14ca4b3a96c242a, 0xf8f747b85412ff7b, 0xc45dc8aa25fb2ced, 0x0fccf5442225073a, 0x21a3deafd1935fdb, 0x9afcbda25182a759, 0x4bb6cfaecad4ba12, 0x1b05d6ab76571103, 0x3195afe0749b353f,  },
+	{ 0x93bd2b1df3051e76, 0xc4e5f09c130a8223, 0xe66503b8539e13b0, 0x05bc376d40354196, 0x76adaac7287f419d, 0xc30c26cb0a72ccfd, 0x44f80c3c40006e45, 0xf909ad202f6d3c3d, 0x5897ebed4786a733, 0x138487d8cc8ced82, 0x746662dee008a3ff, 0xcd9d52b9734cf73c, 0xfd9992434adbcc3a, 0x24b415387de38722, 0xa33dca7d9e9979a6, 0xa11648e4c9a1c81a, 0xf1b33ff160c3ae03, 0x09b1be92741027d4, 0x39b716e33a41e108, 0x590ae65f181da83e, 0xc4266e02393baca6, 0xfc35c213679eebd8, 0xa5c016dcbb251f72, 0xaf5dcd98413db6ee, 0x9892dbc9c76da4ff, 0x4e0d1ae6c89d4d34, 0x36eaaf669e8bb79b, 0xb68dbae1d389b9b8, 0xc35c3ace3369780d, 0xea3b5be3f8aea714, 0x71decf6b17074309, 0x302faba9085dcc42, 0xf0e3f376989e399b, 0xb108a9758eacec25, 0x727eb1cb24ccf968, 0x63885b27156fa619, 0x76b82af7c2b70ec9, 0x5cb5ffd1361c9e40, 0xd3d4afcdf86fd53b, 0x11965c666194d619, 0x62b5919281fca61a, 0x6a007f676e6d50d9, 0x4b530cbdec95897c, 0x33f736fa1a32ad4d, 0x3d37edf39de14494, 0x0a42541e917a25f4, 0x90375637e058ed6a, 0xaf99bca511db0a49, 0x1b85c23862139aaa, 0xec7632c26b8fa08b, 0xecc1d23fa19ffa76, 0xec4cdb6d435bf4f3, 0x995958bf0a91c22d, 0x9e855ade20c63360, 0x54cb1d7094e60868, 0xea6925f655fcfa07, 0x3e42b3831420f9fc, 0xeab004617a1804bd, 0x4e2b3c1dedf9fbab, 0x3518b4c0a1458f98, 0x86dbad2bdf55d44b, 0x030048fe9b7da75a, 0x3085c65d3e3e112f, 0xb976697de8dec3ea,  },
+}
@@ -0,0 +1,89 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package packed
+
+import (
+	"fmt"
+	"io"
+	"os"
+	"unsafe"
+)
+
+// File represents an opened file of records. The records are read only,
+// and are not valid after the file is closed.
+type File struct {
+	Records []Record
+
+	data []byte // underlying memory mapping
+}
+
+// Open opens the given file of records. The file is memory-mapped where
+// it is supported, so that it's records are loaded lazily by the kernel,
+// and is read into memory otherwise.
+func Open(name string) (*File, error) {
+	f, err := os.Open(name)
+	if err != nil {
+		return nil, err
+	}
+
+	defer f.Close()
+
+	info, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+
+	size := info.Size()
+	if size%RecordSize != 0 {
+		return nil, fmt.Errorf("packed: size of %s is not a multiple of %d", name, RecordSize)
+	}
+
+	if size == 0 {
+		// nothing to map
+		return &File{}, nil
+	}
+
+	data, err := mapFile(f, int(size))
+	if err != nil {
+		return nil, err
+	}
+
+	return &File{
+		Records: unsafe.Slice((*Record)(unsafe.Pointer(&data[0])), len(data)/RecordSize),
+		data:    data,
+	}, nil
+}
+
+// Close closes the file, and releases it's records.
+func (file *File) Close() error {
+	data := file.data
+	file.Records, file.data = nil, nil
+
+	if data == nil {
+		return nil
+	}
+
+	return unmapFile(data)
+}
+
+// Write writes the given records to the given writer. Records are plain
+// byte arrays, so the whole slice is written in a single call.
+func Write(w io.Writer, records []Record) error {
+	if len(records) == 0 {
+		return nil
+	}
+
+	_, err := w.Write(unsafe.Slice(&records[0][0], len(records)*RecordSize))
+	return err
+}
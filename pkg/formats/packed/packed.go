@@ -0,0 +1,162 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package packed implements a compact binary format for storing scored
+// positions, used for the engine's training data. Every position is
+// stored as a fixed size Record, so that a file of records can be read
+// by simply memory-mapping it.
+//
+// A record is laid out as follows, with multi-byte fields little-endian:
+//
+//	bytes  0-7   occupancy bitboard
+//	bytes  8-23  pieces, a nibble each, in the order of the occupancy's
+//	             set bits, starting from the lower nibbles
+//	bytes 24-25  score in centipawns, from white's perspective
+//	byte  26     game result (bits 0-1) and side to move (bit 2)
+//	byte  27     en passant target, 64 if there is none
+//	byte  28     castling rights
+//	byte  29     draw clock
+//	bytes 30-31  full move number
+package packed
+
+import (
+	"encoding/binary"
+	"math"
+	"strconv"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/mailbox"
+	"laptudirm.com/x/mess/pkg/board/move/castling"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+)
+
+// RecordSize is the size of a Record in bytes.
+const RecordSize = 32
+
+// Record represents a single scored position. It is a plain array of
+// bytes, so a slice of records can be directly read from or written to
+// a file without any conversions.
+type Record [RecordSize]byte
+
+// Result represents the result of the game a position is from.
+type Result uint8
+
+// constants representing the game results
+const (
+	BlackWin Result = iota
+	Draw
+	WhiteWin
+)
+
+// noEnPassant is the stored en passant target if there is none.
+const noEnPassant = square.N
+
+// NewRecord packs the position of the given board, along with it's white
+// relative score and it's game's result, into a Record. The score is
+// clamped to the range of a 16-bit integer.
+func NewRecord(b *board.Board, score int, result Result) Record {
+	var record Record
+
+	occupied := b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]
+	binary.LittleEndian.PutUint64(record[0:8], uint64(occupied))
+
+	// pack the pieces, a nibble each; a legal position has at
+	// most 32 pieces so they always fit in the 16 bytes
+	for i := 0; occupied != bitboard.Empty && i < 32; i++ {
+		p := b.Position[occupied.Pop()]
+		record[8+i/2] |= byte(p) << (4 * (i % 2))
+	}
+
+	score = util.Clamp(score, math.MinInt16, math.MaxInt16)
+	binary.LittleEndian.PutUint16(record[24:26], uint16(int16(score)))
+
+	record[26] = byte(result) | byte(b.SideToMove)<<2
+
+	record[27] = noEnPassant
+	if b.EnPassantTarget != square.None {
+		record[27] = byte(b.EnPassantTarget)
+	}
+
+	record[28] = byte(b.CastlingRights)
+	record[29] = byte(util.Min(b.DrawClock, math.MaxUint8))
+	binary.LittleEndian.PutUint16(record[30:32], uint16(util.Min(b.FullMoves, math.MaxUint16)))
+
+	return record
+}
+
+// SetResult sets the result of the position's game, which is usually only
+// known after the record has been created.
+func (record *Record) SetResult(result Result) {
+	record[26] = record[26]&^0b11 | byte(result)
+}
+
+// Occupancy returns the bitboard of the occupied squares of the position.
+func (record *Record) Occupancy() bitboard.Board {
+	return bitboard.Board(binary.LittleEndian.Uint64(record[0:8]))
+}
+
+// Mailbox unpacks the pieces of the position into a mailbox board.
+func (record *Record) Mailbox() mailbox.Board {
+	var position mailbox.Board
+
+	occupied := record.Occupancy()
+	for i := 0; occupied != bitboard.Empty && i < 32; i++ {
+		position[occupied.Pop()] = piece.Piece(record[8+i/2]>>(4*(i%2))) & 0xf
+	}
+
+	return position
+}
+
+// Score returns the white relative score of the position in centipawns.
+func (record *Record) Score() int {
+	return int(int16(binary.LittleEndian.Uint16(record[24:26])))
+}
+
+// Result returns the result of the position's game.
+func (record *Record) Result() Result {
+	return Result(record[26] & 0b11)
+}
+
+// SideToMove returns the side to move in the position.
+func (record *Record) SideToMove() piece.Color {
+	return piece.Color(record[26] >> 2 & 1)
+}
+
+// FEN returns the fen string of the position.
+func (record *Record) FEN() fen.String {
+	position := record.Mailbox()
+
+	enPassant := square.None
+	if record[27] != noEnPassant {
+		enPassant = square.Square(record[27])
+	}
+
+	return fen.String{
+		position.FEN(),
+		record.SideToMove().String(),
+		castling.Rights(record[28]).String(),
+		enPassant.String(),
+		strconv.Itoa(int(record[29])),
+		strconv.Itoa(int(binary.LittleEndian.Uint16(record[30:32]))),
+	}
+}
+
+// Score returns the result as a score from white's perspective, where a
+// win is 1, a draw is 0.5 and a loss is 0.
+func (result Result) Score() float32 {
+	return float32(result) / 2
+}
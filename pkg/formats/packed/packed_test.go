@@ -0,0 +1,84 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package packed_test
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/formats/packed"
+)
+
+func TestRecord(t *testing.T) {
+	tests := []struct {
+		fen    string
+		score  int
+		result packed.Result
+	}{
+		{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 25, packed.Draw},
+		{"rnbqkbnr/ppp2ppp/8/2Ppp3/8/8/PP1PPPPP/RNBQKBNR w KQkq d6 0 3", -120, packed.BlackWin},
+		{"rn3rk1/pbp1qpp1/1p5p/3p4/3P4/3BPN2/PP3PPP/R2Q1RK1 b - - 3 12", 1 << 20, packed.WhiteWin},
+		{"8/5k2/1p4p1/p1pK3p/P2n1P1P/6P1/1P6/4R3 b - - 14 263", -7, packed.Draw},
+	}
+
+	records := make([]packed.Record, len(tests))
+	for i, test := range tests {
+		b := board.New(board.FEN(fen.FromString(test.fen)))
+		records[i] = packed.NewRecord(b, test.score, test.result)
+	}
+
+	// write the records to a file and read them back
+	name := filepath.Join(t.TempDir(), "data.packed")
+	f, err := os.Create(name)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if err := packed.Write(f, records); err != nil {
+		t.Fatal(err)
+	}
+
+	if err := f.Close(); err != nil {
+		t.Fatal(err)
+	}
+
+	file, err := packed.Open(name)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	defer file.Close()
+
+	if len(file.Records) != len(tests) {
+		t.Fatalf("read %d records, want %d", len(file.Records), len(tests))
+	}
+
+	for i, test := range tests {
+		record := &file.Records[i]
+
+		if fen := record.FEN().String(); fen != test.fen {
+			t.Errorf("test %d: wrong fen\n%s\n%s", i, test.fen, fen)
+		}
+
+		// scores are clamped to 16 bits
+		score := util.Min(test.score, 32767)
+		if record.Score() != score || record.Result() != test.result {
+			t.Errorf("test %d: got score %d result %d, want %d %d", i, record.Score(), record.Result(), score, test.result)
+		}
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package polyglot
+
+import (
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move/attacks"
+	"laptudirm.com/x/mess/pkg/board/move/castling"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+)
+
+// offsets of the different types of keys in random
+const (
+	randomPiece     = 0
+	randomCastling  = randomPiece + 12*square.N
+	randomEnPassant = randomCastling + 4
+	randomTurn      = randomEnPassant + 8
+	randomN         = randomTurn + 1
+)
+
+// castlingKeys are the castling rights in the order of their keys.
+var castlingKeys = [...]castling.Rights{
+	castling.WhiteK, castling.WhiteQ, castling.BlackK, castling.BlackQ,
+}
+
+// Hash calculates the polyglot hash of the given position. It is a zobrist
+// hash like the position's own, but with the keys used by polyglot books,
+// so it is calculated from scratch only when a book is probed.
+func Hash(b *board.Board) zobrist.Key {
+	var hash zobrist.Key
+
+	for s := square.Square(0); s < square.N; s++ {
+		if p := b.Position[s]; p != piece.NoPiece {
+			// polyglot orders the pieces black pawn, white pawn, black
+			// knight, and so on, and the squares from a1 instead of a8
+			kind := 2*int(p.Type()-piece.Pawn) + int(1-p.Color())
+			hash ^= random[randomPiece+square.N*kind+int(s^56)]
+		}
+	}
+
+	for i, rights := range castlingKeys {
+		if b.CastlingRights&rights != 0 {
+			hash ^= random[randomCastling+i]
+		}
+	}
+
+	// the en passant key is only used if a pawn can capture en passant
+	if ep := b.EnPassantTarget; ep != square.None &&
+		b.PawnsBB(b.SideToMove)&attacks.Pawn[b.SideToMove.Other()][ep] != 0 {
+		hash ^= random[randomEnPassant+int(ep.File())]
+	}
+
+	if b.SideToMove == piece.White {
+		hash ^= random[randomTurn]
+	}
+
+	return hash
+}
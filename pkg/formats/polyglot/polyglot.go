@@ -0,0 +1,215 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package polyglot implements a reader for opening books in the polyglot
+// format, which are files of 16 byte big-endian entries sorted by the
+// polyglot hash of their positions.
+// http://hgm.nubati.net/book_format.html
+package polyglot
+
+import (
+	"encoding/binary"
+	"fmt"
+	"io"
+	"math/rand"
+	"os"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+)
+
+// EntrySize is the size of a book entry in bytes.
+const EntrySize = 16
+
+// Entry represents a single entry of an opening book, which is a move
+// that can be played in the position with the entry's hash.
+type Entry struct {
+	Hash   zobrist.Key // polyglot hash of the position
+	Move   uint16      // move in the polyglot encoding
+	Weight uint16      // relative probability of playing the move
+	Learn  uint32      // learning data, unused
+}
+
+// Book represents an opened polyglot opening book. The book is read only,
+// and is not valid after it is closed.
+type Book struct {
+	data []byte // underlying memory mapping
+}
+
+// Open opens the given polyglot book. The file is memory-mapped where it
+// is supported, so that it's entries are loaded lazily by the kernel, and
+// is read into memory otherwise.
+func Open(name string) (*Book, error) {
+	f, err := os.Open(name)
+	if err != nil {
+		return nil, err
+	}
+
+	defer f.Close()
+
+	info, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+
+	size := info.Size()
+	if size%EntrySize != 0 {
+		return nil, fmt.Errorf("polyglot: size of %s is not a multiple of %d", name, EntrySize)
+	}
+
+	if size == 0 {
+		// nothing to map
+		return &Book{}, nil
+	}
+
+	data, err := mapFile(f, int(size))
+	if err != nil {
+		return nil, err
+	}
+
+	return &Book{data: data}, nil
+}
+
+// Close closes the book, and releases it's entries.
+func (book *Book) Close() error {
+	data := book.data
+	book.data = nil
+
+	if data == nil {
+		return nil
+	}
+
+	return unmapFile(data)
+}
+
+// Len returns the number of entries in the book.
+func (book *Book) Len() int {
+	return len(book.data) / EntrySize
+}
+
+// Entry returns the book entry at the given index, which is decoded from
+// the memory mapping without copying the rest of the book.
+func (book *Book) Entry(i int) Entry {
+	data := book.data[i*EntrySize : (i+1)*EntrySize]
+	return Entry{
+		Hash:   book.hash(i),
+		Move:   binary.BigEndian.Uint16(data[8:]),
+		Weight: binary.BigEndian.Uint16(data[10:]),
+		Learn:  binary.BigEndian.Uint32(data[12:]),
+	}
+}
+
+// hash returns the hash of the book entry at the given index.
+func (book *Book) hash(i int) zobrist.Key {
+	return zobrist.Key(binary.BigEndian.Uint64(book.data[i*EntrySize:]))
+}
+
+// Probe returns a move from the book for the given position, chosen at
+// random with a probability proportional to it's weight. The reported
+// boolean is false if the book doesn't have a legal move for the position.
+// Positions which are not in the book are looked up without allocating.
+func (book *Book) Probe(b *board.Board) (move.Move, bool) {
+	hash := Hash(b)
+
+	// binary search for the first entry of the position
+	first, last := 0, book.Len()
+	for first < last {
+		mid := int(uint(first+last) >> 1)
+		if book.hash(mid) < hash {
+			first = mid + 1
+		} else {
+			last = mid
+		}
+	}
+
+	// find the total weight of the position's entries
+	total, end := 0, first
+	for ; end < book.Len() && book.hash(end) == hash; end++ {
+		total += int(book.Entry(end).Weight)
+	}
+
+	if total == 0 {
+		// no entries, or none of them should be played
+		return move.Null, false
+	}
+
+	// pick an entry with a probability proportional to it's weight
+	pick := rand.Intn(total)
+	for i := first; i < end; i++ {
+		entry := book.Entry(i)
+		if pick -= int(entry.Weight); pick < 0 {
+			return decodeMove(b, entry.Move)
+		}
+	}
+
+	return move.Null, false
+}
+
+// decodeMove finds the legal move in the given position which matches the
+// given polyglot move. The reported boolean is false if the move is not
+// legal, which can happen due to hash collisions.
+func decodeMove(b *board.Board, m uint16) (move.Move, bool) {
+	// polyglot squares are numbered from a1, while ours are from a8
+	target := square.Square(m&0x3f) ^ 56
+	source := square.Square((m>>6)&0x3f) ^ 56
+	promotion := piece.Type((m >> 12) & 0x7)
+	if promotion != piece.NoType {
+		promotion++ // polyglot doesn't have a pawn type
+	}
+
+	// castling moves are encoded as the king capturing it's rook
+	if b.Position[source].Type() == piece.King {
+		switch {
+		case source == square.E1 && target == square.H1:
+			target = square.G1
+		case source == square.E1 && target == square.A1:
+			target = square.C1
+		case source == square.E8 && target == square.H8:
+			target = square.G8
+		case source == square.E8 && target == square.A8:
+			target = square.C8
+		}
+	}
+
+	for _, legal := range b.GenerateMoves(false) {
+		legalPromotion := piece.NoType
+		if legal.IsPromotion() {
+			legalPromotion = legal.ToPiece().Type()
+		}
+
+		if legal.Source() == source && legal.Target() == target && legalPromotion == promotion {
+			return legal, true
+		}
+	}
+
+	return move.Null, false
+}
+
+// Write writes the given entries to the given writer, in the order they
+// are provided. Books should be sorted by the entries' hashes.
+func Write(w io.Writer, entries []Entry) error {
+	data := make([]byte, len(entries)*EntrySize)
+	for i, entry := range entries {
+		e := data[i*EntrySize:]
+		binary.BigEndian.PutUint64(e, uint64(entry.Hash))
+		binary.BigEndian.PutUint16(e[8:], entry.Move)
+		binary.BigEndian.PutUint16(e[10:], entry.Weight)
+		binary.BigEndian.PutUint32(e[12:], entry.Learn)
+	}
+
+	_, err := w.Write(data)
+	return err
+}
@@ -0,0 +1,124 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package polyglot_test
+
+import (
+	"os"
+	"path/filepath"
+	"sort"
+	"testing"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/formats/polyglot"
+)
+
+func TestHash(t *testing.T) {
+	// test vectors from the polyglot book format's specification
+	tests := []struct {
+		fen  string
+		hash zobrist.Key
+	}{
+		{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9c},
+		{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196},
+		{"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0},
+		{"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4},
+		{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78},
+		{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1},
+		{"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9},
+		{"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637},
+		{"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560},
+	}
+
+	for _, test := range tests {
+		b := board.New(board.FEN(fen.FromString(test.fen)))
+		if hash := polyglot.Hash(b); hash != test.hash {
+			t.Errorf("%s: expected %#016x, got %#016x", test.fen, test.hash, hash)
+		}
+	}
+}
+
+// encode encodes the given move in the polyglot format.
+func encode(from, to string) uint16 {
+	square := func(s string) uint16 {
+		return uint16(s[1]-'1')*8 + uint16(s[0]-'a')
+	}
+
+	return square(from)<<6 | square(to)
+}
+
+func TestProbe(t *testing.T) {
+	start := board.New(board.FEN(board.StartFEN))
+	castle := board.New(board.FEN(fen.FromString("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1")))
+
+	entries := []polyglot.Entry{
+		{Hash: polyglot.Hash(start), Move: encode("e2", "e4"), Weight: 3},
+		{Hash: polyglot.Hash(start), Move: encode("d2", "d4"), Weight: 1},
+		{Hash: polyglot.Hash(start), Move: encode("a2", "a4"), Weight: 0},
+		{Hash: polyglot.Hash(castle), Move: encode("e1", "h1"), Weight: 1},
+	}
+
+	sort.Slice(entries, func(i, j int) bool {
+		return entries[i].Hash < entries[j].Hash
+	})
+
+	name := filepath.Join(t.TempDir(), "book.bin")
+	f, err := os.Create(name)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if err := polyglot.Write(f, entries); err != nil {
+		t.Fatal(err)
+	}
+
+	if err := f.Close(); err != nil {
+		t.Fatal(err)
+	}
+
+	book, err := polyglot.Open(name)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	defer book.Close()
+
+	if book.Len() != len(entries) {
+		t.Fatalf("expected %d entries, got %d", len(entries), book.Len())
+	}
+
+	for i := 0; i < 100; i++ {
+		m, found := book.Probe(start)
+		if !found || (m.String() != "e2e4" && m.String() != "d2d4") {
+			t.Fatalf("startpos: got book move %s %v", m, found)
+		}
+	}
+
+	if m, found := book.Probe(castle); !found || m.String() != "e1g1" {
+		t.Errorf("castling: expected book move e1g1, got %s %v", m, found)
+	}
+
+	// positions which are not in the book shouldn't allocate
+	missing := board.New(board.FEN(fen.FromString("8/8/8/4k3/8/8/8/4K3 w - - 0 1")))
+	allocs := testing.AllocsPerRun(100, func() {
+		if _, found := book.Probe(missing); found {
+			t.Error("missing: unexpected book move")
+		}
+	})
+
+	if allocs != 0 {
+		t.Errorf("missing: expected no allocations, got %.f", allocs)
+	}
+}
@@ -15,7 +15,6 @@ package search
 
 import (
 	"laptudirm.com/x/mess/internal/util"
-	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/search/eval"
 )
 
@@ -26,7 +25,7 @@ import (
 // bounds. Because the window is narrower, more beta cutoffs are achieved,
 // and the search takes a shorter time. The drawback is that if the true
 // score is outside this window, then a costly re-search must be made.
-func (search *Context) aspirationWindow(depth int, prevEval eval.Eval) (eval.Eval, move.Variation) {
+func (search *Context) aspirationWindow(depth int, prevEval eval.Eval) eval.Eval {
 	// default values for alpha and beta
 	alpha := eval.Eval(-eval.Inf)
 	beta := eval.Eval(eval.Inf)
@@ -48,11 +47,10 @@ func (search *Context) aspirationWindow(depth int, prevEval eval.Eval) (eval.Eva
 			// some search limit has been breached
 			// the return value doesn't matter since this search's result
 			// will be trashed and the previous iteration's pv will be used
-			return 0, move.Variation{}
+			return 0
 		}
 
-		var pv move.Variation
-		result := search.negamax(0, depth, alpha, beta, &pv)
+		result := search.negamax(0, depth, alpha, beta)
 
 		switch {
 		// result <= alpha: search failed low
@@ -75,8 +73,8 @@ func (search *Context) aspirationWindow(depth int, prevEval eval.Eval) (eval.Eva
 
 		// exact score is inside bounds
 		default:
-			// return exact score
-			return result, pv
+			// return exact score, the pv is in the root frame
+			return result
 		}
 
 		// score out of bounds, research needed
@@ -25,10 +25,43 @@ func (search *Context) String() string {
 	return search.board.String()
 }
 
-// UpdatePosition updates the search board with the given fen.
+// UpdatePosition updates the search board with the given fen. The tt is
+// not cleared, so that the entries from the previous searches of the game,
+// including those of a ponder search, are reused by the next search.
 func (search *Context) UpdatePosition(fen fen.String) {
 	search.board.UpdateWithFEN(fen)
-	search.tt.Clear()
+}
+
+// PonderMove returns the move which is expected to be played in reply to
+// the given pv's best move. It is the pv's second move, if it has one, or
+// the tt move of the position after the best move. A null move is returned
+// if neither are available. It should not be called during a search.
+func (search *Context) PonderMove(pv move.Variation) move.Move {
+	if ponderMove := pv.Move(1); ponderMove != move.Null {
+		return ponderMove
+	}
+
+	bestMove := pv.Move(0)
+	if bestMove == move.Null {
+		return move.Null
+	}
+
+	search.board.MakeMove(bestMove)
+	defer search.board.UnmakeMove()
+
+	entry, hit := search.tt.Probe(search.board.Hash)
+	if !hit {
+		return move.Null
+	}
+
+	// the tt move may be from a hash collision, so check it's legality
+	var generator board.MoveGenerator
+	search.board.InitGenerator(&generator)
+	if !generator.IsLegal(entry.Move) {
+		return move.Null
+	}
+
+	return entry.Move
 }
 
 func (search *Context) Board() *board.Board {
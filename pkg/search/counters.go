@@ -0,0 +1,137 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"encoding/json"
+	"fmt"
+	"strings"
+)
+
+// Counter is a detailed search statistic, which counts how often some
+// event, like a pruning technique firing, happens during a search. The
+// counters are only collected if the engine is built with the stats build
+// tag, since incrementing them in the hot paths of the search isn't free.
+type Counter int
+
+// constants representing the search counters
+const (
+	CounterMainNodes      Counter = iota // negamax calls
+	CounterQNodes                        // quiescence search calls
+	CounterTTCutoffs                     // negamax tt cutoffs
+	CounterTBCutoffs                     // negamax tablebase cutoffs
+	CounterRFP                           // reverse futility prunes
+	CounterRazorTries                    // razoring qsearches
+	CounterRazorPrunes                   // razoring prunes
+	CounterNMPTries                      // null move searches
+	CounterNMPCutoffs                    // null move cutoffs
+	CounterLMP                           // late move prunes
+	CounterSEEQuiet                      // quiet see prunes
+	CounterSEENoisy                      // noisy see prunes
+	CounterLMRSearches                   // reduced searches
+	CounterLMRResearches                 // reduced searches which failed high
+	CounterPVSResearches                 // null window searches re-searched
+	CounterFailHighs                     // negamax beta cutoffs
+	CounterFirstFailHighs                // beta cutoffs on the first move
+	CounterStandPats                     // qsearch stand pat cutoffs
+	CounterN
+)
+
+// counterNames are the names of the counters, used while printing them.
+var counterNames = [CounterN]string{
+	CounterMainNodes:      "main",
+	CounterQNodes:         "qnodes",
+	CounterTTCutoffs:      "ttcut",
+	CounterTBCutoffs:      "tbcut",
+	CounterRFP:            "rfp",
+	CounterRazorTries:     "razortry",
+	CounterRazorPrunes:    "razor",
+	CounterNMPTries:       "nmptry",
+	CounterNMPCutoffs:     "nmp",
+	CounterLMP:            "lmp",
+	CounterSEEQuiet:       "seequiet",
+	CounterSEENoisy:       "seenoisy",
+	CounterLMRSearches:    "lmr",
+	CounterLMRResearches:  "lmrre",
+	CounterPVSResearches:  "pvsre",
+	CounterFailHighs:      "failhigh",
+	CounterFirstFailHighs: "firstfh",
+	CounterStandPats:      "standpat",
+}
+
+// Counters contains the values of all the search counters.
+type Counters [CounterN]int
+
+// count increments the given counter of the current thread. It is a no-op
+// which the compiler removes if the counters are not enabled.
+func (search *Context) count(counter Counter) {
+	if CountersEnabled {
+		search.stats.Counters[counter]++
+	}
+}
+
+// Counters returns the sum of the counters of all the threads, over the
+// last search. It should not be called while a search is in progress.
+func (search *Context) Counters() Counters {
+	counters := search.stats.Counters
+	for _, helper := range search.helpers {
+		counters.Add(helper.stats.Counters)
+	}
+
+	return counters
+}
+
+// Add adds the given counters to the current ones.
+func (counters *Counters) Add(other Counters) {
+	for i := range counters {
+		counters[i] += other[i]
+	}
+}
+
+// String converts the counters into a list of their names and values,
+// followed by the first move cutoff and qsearch node ratios.
+func (counters Counters) String() string {
+	var str strings.Builder
+	for counter, value := range counters {
+		fmt.Fprintf(&str, "%s %d ", counterNames[counter], value)
+	}
+
+	fmt.Fprintf(
+		&str, "firstfh%% %.1f qnodes%% %.1f",
+		100*ratio(counters[CounterFirstFailHighs], counters[CounterFailHighs]),
+		100*ratio(counters[CounterQNodes], counters[CounterMainNodes]+counters[CounterQNodes]),
+	)
+
+	return str.String()
+}
+
+// MarshalJSON converts the counters into a json object which maps each of
+// the counter's names to it's value.
+func (counters Counters) MarshalJSON() ([]byte, error) {
+	values := make(map[string]int, CounterN)
+	for counter, value := range counters {
+		values[counterNames[counter]] = value
+	}
+
+	return json.Marshal(values)
+}
+
+// ratio returns a/b, or zero if b is zero.
+func ratio(a, b int) float64 {
+	if b == 0 {
+		return 0
+	}
+
+	return float64(a) / float64(b)
+}
@@ -30,13 +30,32 @@ func (search *Context) iterativeDeepening() (move.Variation, eval.Eval) {
 	// also populate the transposition table with scores and pv moves which makes
 	// iterative deepening to a depth faster that directly searching that depth.
 	for search.stats.Depth = 1; search.stats.Depth <= search.limits.Depth; search.stats.Depth++ {
+		if search.skipDepth(search.stats.Depth) {
+			// depth staggered for this helper thread
+			continue
+		}
 
 		// the new pv isn't directly stored into the pv variable since it will
 		// pollute the correct pv if the next search is incomplete. Instead the
 		// old pv is overwritten only if the search is found to be complete.
-		score, pv := search.aspirationWindow(search.stats.Depth, search.pvScore)
+		//
+		// In multipv mode the lines are searched one after the other, where
+		// each line excludes the first moves of the lines searched before it.
+		for search.pvIndex = 0; search.pvIndex < len(search.lines); search.pvIndex++ {
+			line := &search.lines[search.pvIndex]
+			line.score = search.aspirationWindow(search.stats.Depth, line.score)
+
+			if search.stopped.Load() {
+				break
+			}
+
+			line.pv.Set(search.stack[0].pv)
+		}
+
+		// the exclusions only apply to the root lines loop
+		search.pvIndex = 0
 
-		if search.stopped {
+		if search.stopped.Load() {
 			// don't use the new pv if search was stopped since the
 			// search is probably unfinished
 
@@ -47,20 +66,43 @@ func (search *Context) iterativeDeepening() (move.Variation, eval.Eval) {
 		}
 
 		// search successfully completed, so update pv
-		search.pv = pv
-		search.pvScore = score
+		search.sortLines()
+		search.pv.Set(search.lines[0].pv)
+		search.pvScore = search.lines[0].score
+
+		if !search.isMainThread() {
+			// helper threads don't report or manage time
+			continue
+		}
 
 		// print some info for the GUI
-		search.reporter(search.GenerateReport())
+		search.report()
 
-		if search.time != nil && search.time.OptimisticExpired() {
+		if search.mateFound() {
+			// a short enough mate has been proven
 			break
 		}
+
+		// install the limits from a ponderhit, if any
+		search.installLimits()
+
+		if search.time != nil {
+			// scale the deadline with the iteration's results
+			search.time.UpdateDeadline()
+			if search.time.OptimisticExpired() {
+				break
+			}
+		}
 	}
 
-	if search.stats.Depth < search.limits.Depth && search.limits.Infinite {
-		for search.limits.Infinite && !search.shouldStop() {
-			// if in infinite mode, wait for stop
+	if search.isMainThread() {
+		// if in infinite mode, wait for a stop or for the limits to be
+		// updated by a ponderhit, both of which signal the main thread,
+		// even if the depth limit has been reached or a mate found
+		search.installLimits()
+		for search.limits.Infinite && !search.stopped.Load() {
+			<-search.signal
+			search.installLimits()
 		}
 	}
 
@@ -17,6 +17,7 @@ import (
 	"laptudirm.com/x/mess/internal/util"
 	"laptudirm.com/x/mess/pkg/board"
 	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/board/move/attacks"
 	"laptudirm.com/x/mess/pkg/board/piece"
 	"laptudirm.com/x/mess/pkg/board/square"
@@ -31,8 +32,13 @@ type EfficientlyUpdatable struct {
 	// the board to evaluate
 	Board *board.Board
 
-	// the game phase to lerp between middle and end game
-	phase eval.Eval
+	// stack of efficiently updated terms, one for each ply, which grows
+	// along with the board's history in games longer than move.MaxN
+	accumulators []accumulator
+	current      int // index of the current position's terms
+
+	// cache of the pawn structure evaluations
+	pawns pawnTable
 
 	// occupancy bitboards
 	occupied      bitboard.Board
@@ -55,6 +61,28 @@ type EfficientlyUpdatable struct {
 	attacked    [piece.ColorN]bitboard.Board // squares attacked
 	attackedBy2 [piece.ColorN]bitboard.Board // squares attacked twice
 	attackedBy  [piece.ColorN][piece.TypeN]bitboard.Board
+
+	// trace of the current evaluation, only used while tracing
+	trace *Trace
+}
+
+// New creates a new classical evaluation function which evaluates the given
+// board. It's signature matches eval.NewFunc.
+func New(b *board.Board) eval.EfficientlyUpdatable {
+	return &EfficientlyUpdatable{
+		Board:        b,
+		accumulators: make([]accumulator, move.MaxN+1),
+	}
+}
+
+// accumulator contains the evaluation terms which are linear in the pieces
+// on the board, and can thus be efficiently updated.
+type accumulator struct {
+	// psqt (and material) evaluation of each side's pieces
+	psqt [piece.ColorN]Score
+
+	// the game phase to lerp between middle and end game
+	phase eval.Eval
 }
 
 // compile time check that OTSePUE implements eval.EfficientlyUpdatable
@@ -62,10 +90,40 @@ var _ eval.EfficientlyUpdatable = (*EfficientlyUpdatable)(nil)
 
 // FillSquare adds the given piece to the given square of a chessboard.
 func (classical *EfficientlyUpdatable) FillSquare(s square.Square, p piece.Piece) {
+	accumulator := &classical.accumulators[classical.current]
+	accumulator.psqt[p.Color()] += table[p][s]
+	accumulator.phase += phaseInc[p.Type()]
 }
 
 // ClearSquare removes the given piece from the given square.
 func (classical *EfficientlyUpdatable) ClearSquare(s square.Square, p piece.Piece) {
+	accumulator := &classical.accumulators[classical.current]
+	accumulator.psqt[p.Color()] -= table[p][s]
+	accumulator.phase -= phaseInc[p.Type()]
+}
+
+// Push pushes a copy of the current efficiently updated terms into the
+// stack, so that the current terms can be restored later with Pop.
+func (classical *EfficientlyUpdatable) Push() {
+	if classical.current+1 == len(classical.accumulators) {
+		// stack is full, grow it and use all of it's capacity
+		classical.accumulators = append(classical.accumulators, accumulator{})
+		classical.accumulators = classical.accumulators[:cap(classical.accumulators)]
+	}
+
+	classical.accumulators[classical.current+1] = classical.accumulators[classical.current]
+	classical.current++
+}
+
+// Pop restores the efficiently updated terms of the previous position.
+func (classical *EfficientlyUpdatable) Pop() {
+	classical.current--
+}
+
+// Reset resets the efficiently updated terms to those of an empty board.
+func (classical *EfficientlyUpdatable) Reset() {
+	classical.current = 0
+	classical.accumulators[0] = accumulator{}
 }
 
 // Tempo is the bonus given to the side to move for
@@ -77,11 +135,19 @@ var Tempo eval.Eval = 20
 func (classical *EfficientlyUpdatable) Accumulate(stm piece.Color) eval.Eval {
 	xtm := stm.Other()
 
+	// probe the pawn hash table
+	pawns := classical.probePawns()
+
 	// initialize various tables
-	classical.initialize()
+	classical.initialize(pawns)
+
+	accumulator := &classical.accumulators[classical.current]
+
+	// efficiently updated terms
+	score := accumulator.psqt[stm] - accumulator.psqt[xtm] // psqt and material
 
 	// piece evaluation terms
-	score := classical.evaluatePawns(stm) - classical.evaluatePawns(xtm)   // pawns and structure
+	score += pawns.score[stm] - pawns.score[xtm]                           // pawn structure
 	score += classical.evaluatePieces(stm) - classical.evaluatePieces(xtm) // major and minor pieces
 	score += classical.evaluateKing(stm) - classical.evaluateKing(xtm)     // king and king-safety
 
@@ -91,7 +157,7 @@ func (classical *EfficientlyUpdatable) Accumulate(stm piece.Color) eval.Eval {
 	// linearly interpolate between the end game and middle game
 	// evaluations using phase/startposPhase as the contribution
 	// of the middle game to the final evaluation
-	phase := util.Min(classical.phase, startposPhase)
+	phase := util.Min(accumulator.phase, startposPhase)
 	return Tempo + util.Lerp(score.EG(), score.MG(), phase, startposPhase)
 }
 
@@ -107,30 +173,22 @@ var PawnStacked = [2][square.FileN]Score{
 	},
 }
 
-// evaluatePawns returns the static evaluation of our pawns.
+// evaluatePawns returns the static evaluation of our pawn structure. The
+// evaluation should only depend on the pawns, as it is cached with the
+// pawn hash of the position.
 func (classical *EfficientlyUpdatable) evaluatePawns(us piece.Color) Score {
 	myPawns := classical.Board.PawnsBB(us)
 	theirPawns := classical.Board.PawnsBB(us.Other())
 
-	pawnPiece := piece.New(piece.Pawn, us) // piece representing one of our pawns
-	tempPawns := myPawns                   // bitboard to temporarily store our pawns
+	tempPawns := myPawns // bitboard to temporarily store our pawns
 
 	score := Score(0)
 
-	// update attack bitboards with pawn attacks
-	classical.attackedBy2[us] |= classical.pawnAttacks[us] & classical.attacked[us]
-	classical.attacked[us] |= classical.pawnAttacks[us]
-	classical.attackedBy[us][piece.Pawn] = classical.pawnAttacks[us]
-
 	// evaluate every pawn
 	for tempPawns != bitboard.Empty {
 		// get next pawn
 		pawn := tempPawns.Pop()
 
-		// add psqt evaluation
-		score += table[pawnPiece][pawn]
-		classical.phase += phaseInc[piece.Pawn]
-
 		neighbors := bitboard.AdjacentFiles[pawn.File()] & myPawns
 		stoppers := bitboard.PassedPawnMask[us][pawn] & theirPawns
 		threats := attacks.Pawn[us][pawn] & theirPawns
@@ -142,6 +200,7 @@ func (classical *EfficientlyUpdatable) evaluatePawns(us piece.Color) Score {
 			canUnstack := (stoppers != bitboard.Empty && (threats|neighbors) != bitboard.Empty) ||
 				stoppers&^bitboard.ForwardFileMask[us][pawn] != bitboard.Empty
 			score += PawnStacked[util.Btoi[int](canUnstack)][pawn.File()]
+			classical.traceTerm(TracePawnStacked+util.Btoi[int](canUnstack)*square.FileN+int(pawn.File()), us)
 		}
 	}
 
@@ -202,10 +261,6 @@ func (classical *EfficientlyUpdatable) evaluatePieces(us piece.Color) Score {
 		pc := classical.Board.Position[sq]
 		pt := pc.Type()
 
-		// add psqt evaluation
-		score += table[pc][sq]
-		classical.phase += phaseInc[pt]
-
 		// specialized evaluation terms for various pieces
 		switch pt {
 		case piece.Rook:
@@ -216,9 +271,11 @@ func (classical *EfficientlyUpdatable) evaluatePieces(us piece.Color) Score {
 			// no pawns on rook file: open file
 			case classical.Board.PieceBBs[piece.Pawn] & file:
 				score += RookFullOpenFile
+				classical.traceTerm(TraceRookOpen+1, us)
 			// no friendly pawns on rook file: semi-open file
 			case classical.Board.PawnsBB(us) & file:
 				score += RookSemiOpenFile
+				classical.traceTerm(TraceRookOpen, us)
 			}
 		}
 
@@ -233,6 +290,7 @@ func (classical *EfficientlyUpdatable) evaluatePieces(us piece.Color) Score {
 		// add mobility evaluation
 		count := (attacks & classical.mobilityAreas[us]).Count()
 		score += Mobility[pt][count]
+		classical.traceTerm(traceMobility[pt]+count, us)
 
 		// update data for king attackers
 		kingAttacks := attacks & classical.kingAreas[them] & ^classical.pawnAttacksBy2[them]
@@ -281,12 +339,8 @@ func (classical *EfficientlyUpdatable) evaluateKing(us piece.Color) Score {
 
 	score := Score(0)
 
-	kingPiece := piece.New(piece.King, us)
 	king := (classical.Board.KingBB(us)).FirstOne()
 
-	// psqt evaluation of the king
-	score += table[kingPiece][king]
-
 	// defenders of king including pawns and minor pieces
 	defenders := classical.Board.PawnsBB(us) |
 		classical.Board.KnightsBB(us) |
@@ -295,6 +349,7 @@ func (classical *EfficientlyUpdatable) evaluateKing(us piece.Color) Score {
 	// king defenders evaluation
 	defenders &= classical.kingAreas[us]
 	score += KingDefenders[defenders.Count()]
+	classical.traceTerm(TraceDefenders+defenders.Count(), us)
 
 	// do safety evaluation if we have two attackers, or one
 	// attacker with the potential for an enemy queen to join
@@ -351,10 +406,13 @@ func (classical *EfficientlyUpdatable) evaluateKing(us piece.Color) Score {
 		mg, eg := safety.MG(), safety.EG()
 
 		// convert safety to score with non-linear function
-		score += S(
+		safetyScore := S(
 			-mg*util.Min(0, mg)/720,
 			util.Min(0, eg)/20,
 		)
+
+		score += safetyScore
+		classical.traceNonlinear(us, safetyScore)
 	}
 
 	// calculate the attacks of the king
@@ -432,53 +490,62 @@ func (classical *EfficientlyUpdatable) evaluateThreats(us piece.Color) Score {
 	// penalty for pawns which can't be traded off and are poorly defended
 	poorlySupportedPawns := pawns & ^attacksByPawns & poorlyDefended
 	score += Score(poorlySupportedPawns.Count()) * ThreatWeakPawn
+	classical.traceCount(TraceThreats, us, poorlySupportedPawns)
 
 	// penalty for minors attacked by pawns
 	minorsAttackedByPawns := (knights | bishops) & attacksByPawns
 	score += Score(minorsAttackedByPawns.Count()) * ThreatMinorAttackedByPawn
+	classical.traceCount(TraceThreats+1, us, minorsAttackedByPawns)
 
 	// penalty for minors attacked by minors
 	minorsAttackedByMinors := (knights | bishops) & attacksByMinors
 	score += Score(minorsAttackedByMinors.Count()) * ThreatMinorAttackedByMinor
+	classical.traceCount(TraceThreats+2, us, minorsAttackedByMinors)
 
 	// penalty for minors attacked by majors
 	minorsAttackedByMajors := (knights | bishops) & attacksByMajors
 	score += Score(minorsAttackedByMajors.Count()) * ThreatMinorAttackedByMajor
+	classical.traceCount(TraceThreats+3, us, minorsAttackedByMajors)
 
 	// penalty for rooks attacked by lesser pieces
 	rooksAttackedByLesser := rooks & (attacksByPawns | attacksByMinors)
 	score += Score(rooksAttackedByLesser.Count()) * ThreatRookAttackedByLesser
+	classical.traceCount(TraceThreats+4, us, rooksAttackedByLesser)
 
 	// penalty for weak minors attacked by the king
 	weakMinorsAttackedByKing := weakMinors & attacksByKing
 	score += Score(weakMinorsAttackedByKing.Count()) * ThreatMinorAttackedByKing
+	classical.traceCount(TraceThreats+5, us, weakMinorsAttackedByKing)
 
 	// penalty for weak rooks attacked by the king
 	weakRooksAttackedByKing := rooks & poorlyDefended & attacksByKing
 	score += Score(weakRooksAttackedByKing.Count()) * ThreatRookAttackedByKing
+	classical.traceCount(TraceThreats+6, us, weakRooksAttackedByKing)
 
 	// penalty for attacked queens
 	attackedQueens := queens & classical.attacked[them]
 	score += Score(attackedQueens.Count()) * ThreatQueenAttackedByOne
+	classical.traceCount(TraceThreats+7, us, attackedQueens)
 
 	// overloaded pieces are attacked and defended by exactly one piece
 	overloaded := (knights | bishops | rooks | queens) &
 		classical.attacked[us] & ^classical.attackedBy2[us] &
 		classical.attacked[them] & ^classical.attackedBy2[them]
 	score += Score(overloaded.Count()) * ThreatOverloadedPieces
+	classical.traceCount(TraceThreats+8, us, overloaded)
 
 	// bonus for giving threats to non-pawn enemy with safe pawn pushes
 	// squares that are already threatened by our pawns is not considered
 	pushThreat := attacks.Pawns(safePush, us) & (enemies &^ classical.attackedBy[us][piece.Pawn])
 	score += Score(pushThreat.Count()) * ThreatByPawnPush
+	classical.traceCount(TraceThreats+9, us, pushThreat)
 
 	return score
 }
 
 // initialize empties and initializes various variables related to evaluation.
-func (classical *EfficientlyUpdatable) initialize() {
-	classical.phase = 0
-
+// The pawn bitboards are initialized from the given pawn table entry.
+func (classical *EfficientlyUpdatable) initialize(pawns *pawnEntry) {
 	black := classical.Board.ColorBBs[piece.Black]
 	white := classical.Board.ColorBBs[piece.White]
 
@@ -499,13 +566,8 @@ func (classical *EfficientlyUpdatable) initialize() {
 	blackPawns := classical.Board.PawnsBB(piece.Black)
 	whitePawns := classical.Board.PawnsBB(piece.White)
 
-	blackPawnsAdvanced := blackPawns.South()
-	whitePawnsAdvanced := whitePawns.North()
-
-	classical.pawnAttacks[piece.Black] = blackPawnsAdvanced.East() | blackPawnsAdvanced.West()
-	classical.pawnAttacks[piece.White] = whitePawnsAdvanced.East() | whitePawnsAdvanced.West()
-	classical.pawnAttacksBy2[piece.Black] = blackPawnsAdvanced.East() & blackPawnsAdvanced.West()
-	classical.pawnAttacksBy2[piece.White] = whitePawnsAdvanced.East() & whitePawnsAdvanced.West()
+	classical.pawnAttacks = pawns.pawnAttacks
+	classical.pawnAttacksBy2 = pawns.pawnAttacksBy2
 
 	classical.blockedPawns[piece.White] = classical.occupied.South() & whitePawns
 	classical.blockedPawns[piece.Black] = classical.occupied.North() & blackPawns
@@ -516,6 +578,16 @@ func (classical *EfficientlyUpdatable) initialize() {
 	classical.attacked[piece.Black] = classical.attackedBy[piece.Black][piece.King]
 	classical.attacked[piece.White] = classical.attackedBy[piece.White][piece.King]
 
+	// update attack bitboards with pawn attacks
+	classical.attackedBy[piece.Black][piece.Pawn] = classical.pawnAttacks[piece.Black]
+	classical.attackedBy[piece.White][piece.Pawn] = classical.pawnAttacks[piece.White]
+
+	classical.attackedBy2[piece.Black] = classical.pawnAttacks[piece.Black] & classical.attacked[piece.Black]
+	classical.attackedBy2[piece.White] = classical.pawnAttacks[piece.White] & classical.attacked[piece.White]
+
+	classical.attacked[piece.Black] |= classical.pawnAttacks[piece.Black]
+	classical.attacked[piece.White] |= classical.pawnAttacks[piece.White]
+
 	classical.mobilityAreas[piece.Black] = ^(classical.pawnAttacks[piece.White] | blackKing | classical.blockedPawns[piece.Black])
 	classical.mobilityAreas[piece.White] = ^(classical.pawnAttacks[piece.Black] | whiteKing | classical.blockedPawns[piece.White])
 
@@ -0,0 +1,114 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package classical_test
+
+import (
+	"testing"
+
+	"laptudirm.com/x/mess/internal/bench"
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search/eval"
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+func BenchmarkAccumulate(b *testing.B) {
+	boards := make([]*board.Board, len(bench.FENs))
+	evaluators := make([]eval.EfficientlyUpdatable, len(bench.FENs))
+	for i, fenString := range bench.FENs {
+		boards[i] = board.New()
+		evaluators[i] = classical.New(boards[i])
+		boards[i].SetEfficientlyUpdatable(evaluators[i])
+		boards[i].UpdateWithFEN(fen.FromString(fenString))
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for j, evaluator := range evaluators {
+			evaluator.Accumulate(boards[j].SideToMove)
+		}
+	}
+}
+
+func TestLongGame(t *testing.T) {
+	chessboard := board.New()
+	evaluator := classical.New(chessboard)
+	chessboard.SetEfficientlyUpdatable(evaluator)
+	chessboard.UpdateWithFEN(board.StartFEN)
+
+	want := evaluator.Accumulate(chessboard.SideToMove)
+
+	// shuffle the knights for more plys than move.MaxN, which returns
+	// to the starting position every four plys
+	shuffle := []string{"g1f3", "g8f6", "f3g1", "f6g8"}
+	plys := move.MaxN + 2*len(shuffle)
+	for i := 0; i < plys; i++ {
+		chessboard.MakeMove(chessboard.NewMoveFromString(shuffle[i%len(shuffle)]))
+	}
+
+	if got := evaluator.Accumulate(chessboard.SideToMove); got != want {
+		t.Fatalf("after %d plys: evaluation %d, want %d", plys, got, want)
+	}
+
+	for i := 0; i < plys; i++ {
+		chessboard.UnmakeMove()
+	}
+
+	if got := evaluator.Accumulate(chessboard.SideToMove); got != want {
+		t.Fatalf("after unmaking %d plys: evaluation %d, want %d", plys, got, want)
+	}
+}
+
+func TestTrace(t *testing.T) {
+	if !classical.TracingEnabled {
+		t.Skip("tracing requires the tune build tag")
+	}
+
+	weights := classical.Weights()
+
+	for _, fenString := range bench.FENs {
+		chessboard := board.New()
+		evaluator := classical.New(chessboard).(*classical.EfficientlyUpdatable)
+		chessboard.SetEfficientlyUpdatable(evaluator)
+		chessboard.UpdateWithFEN(fen.FromString(fenString))
+
+		trace := evaluator.Trace()
+
+		// rebuild the evaluation from the linear features
+		var mg, eg eval.Eval
+		for term := 0; term < classical.TraceTempo; term++ {
+			coefficient := eval.Eval(trace.Coefficients[term][piece.White] - trace.Coefficients[term][piece.Black])
+			mg += weights[term].MG() * coefficient
+			eg += weights[term].EG() * coefficient
+		}
+
+		nonlinear := trace.Nonlinear[piece.White] - trace.Nonlinear[piece.Black]
+		mg, eg = mg+nonlinear.MG(), eg+nonlinear.EG()
+
+		if chessboard.SideToMove == piece.Black {
+			mg, eg = -mg, -eg
+		}
+
+		tempo := eval.Eval(trace.Coefficients[classical.TraceTempo][chessboard.SideToMove]) * weights[classical.TraceTempo].MG()
+		want := tempo + util.Lerp(eg, mg, trace.Phase, classical.MaxPhase)
+
+		if got := evaluator.Accumulate(chessboard.SideToMove); got != want {
+			t.Errorf("%s: evaluation %d, traced %d", fenString, got, want)
+		}
+	}
+}
@@ -0,0 +1,73 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package classical
+
+import (
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+)
+
+// pawnTableSize is the number of entries in a pawn hash table.
+const pawnTableSize = 1 << 14
+
+// pawnTable is a hash table which caches the evaluation terms which only
+// depend on the pawn structure of a position, indexed by the pawn hash.
+// Since it is not shared, each evaluator has it's own pawn table.
+//
+// A zeroed entry is the correct entry of a position without any pawns,
+// so the table doesn't need to differentiate empty entries.
+type pawnTable [pawnTableSize]pawnEntry
+
+// pawnEntry is an entry of the pawn hash table.
+type pawnEntry struct {
+	key zobrist.Key // pawn hash of the entry's position
+
+	// pawn structure evaluation of each side
+	score [piece.ColorN]Score
+
+	// various pawn bitboards
+	pawnAttacks    [piece.ColorN]bitboard.Board // squares attacked by pawns
+	pawnAttacksBy2 [piece.ColorN]bitboard.Board // squares attacked by 2 pawns
+}
+
+// probePawns returns the pawn table entry of the given position. If the entry
+// isn't in the table, it is evaluated and stored before being returned.
+func (classical *EfficientlyUpdatable) probePawns() *pawnEntry {
+	key := classical.Board.PawnHash
+	entry := &classical.pawns[key%pawnTableSize]
+
+	if entry.key == key && (!TracingEnabled || classical.trace == nil) {
+		// pawn hash hit, which isn't used while tracing
+		return entry
+	}
+
+	entry.key = key
+
+	blackPawns := classical.Board.PawnsBB(piece.Black)
+	whitePawns := classical.Board.PawnsBB(piece.White)
+
+	blackPawnsAdvanced := blackPawns.South()
+	whitePawnsAdvanced := whitePawns.North()
+
+	entry.pawnAttacks[piece.Black] = blackPawnsAdvanced.East() | blackPawnsAdvanced.West()
+	entry.pawnAttacks[piece.White] = whitePawnsAdvanced.East() | whitePawnsAdvanced.West()
+	entry.pawnAttacksBy2[piece.Black] = blackPawnsAdvanced.East() & blackPawnsAdvanced.West()
+	entry.pawnAttacksBy2[piece.White] = whitePawnsAdvanced.East() & whitePawnsAdvanced.West()
+
+	entry.score[piece.Black] = classical.evaluatePawns(piece.Black)
+	entry.score[piece.White] = classical.evaluatePawns(piece.White)
+
+	return entry
+}
@@ -0,0 +1,169 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package classical
+
+import (
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// MaxPhase is the game phase of a position with all the pieces, where the
+// middle game evaluation is used. A zero phase uses the end game one.
+const MaxPhase = startposPhase
+
+// Trace contains the linear features of a position's evaluation, which are
+// the number of times each of the tuned terms is used for each side. The
+// evaluation is, from white's perspective, the lerp of the sum of each
+// term's weight times it's white minus black coefficient, and the terms
+// which are not linear, which are traced as their contribution instead.
+type Trace struct {
+	Coefficients [TraceN][piece.ColorN]int
+	Nonlinear    [piece.ColorN]Score // king safety, which isn't tuned
+	Phase        eval.Eval           // game phase, at most MaxPhase
+}
+
+// Trace evaluates the board with the evaluation terms being traced, and
+// returns the position's linear features. The pawn hash table is skipped
+// while tracing, so that the pawn terms are always traced. It can only be
+// used when the engine is built with the tune build tag.
+func (classical *EfficientlyUpdatable) Trace() Trace {
+	if !TracingEnabled {
+		panic("classical: tracing requires the tune build tag")
+	}
+
+	var trace Trace
+	classical.trace = &trace
+	defer func() { classical.trace = nil }()
+
+	stm := classical.Board.SideToMove
+	classical.Accumulate(stm)
+
+	trace.Phase = util.Min(classical.accumulators[classical.current].phase, startposPhase)
+
+	// the psqt terms are efficiently updated, so trace them separately
+	for s := square.A8; s < square.N; s++ {
+		if p := classical.Board.Position[s]; p != piece.NoPiece {
+			// the tables are from white's perspective
+			relative := s
+			if p.Color() == piece.Black {
+				relative ^= 56
+			}
+
+			trace.add(TracePSQT+int(p.Type()-piece.Pawn)*square.N+int(relative), p.Color(), 1)
+		}
+	}
+
+	trace.add(TraceTempo, stm, 1)
+	return trace
+}
+
+// add adds the given count to the coefficient of the given term.
+func (trace *Trace) add(term int, c piece.Color, count int) {
+	trace.Coefficients[term][c] += count
+}
+
+// traceCount adds the population count of the given bitboard to the
+// coefficient of the given term, if the evaluation is being traced.
+func (classical *EfficientlyUpdatable) traceCount(term int, c piece.Color, b bitboard.Board) {
+	if TracingEnabled && classical.trace != nil {
+		classical.trace.add(term, c, b.Count())
+	}
+}
+
+// traceNonlinear adds the given contribution of a non-linear term, if the
+// evaluation is being traced.
+func (classical *EfficientlyUpdatable) traceNonlinear(c piece.Color, score Score) {
+	if TracingEnabled && classical.trace != nil {
+		classical.trace.Nonlinear[c] += score
+	}
+}
+
+// traceTerm adds a single use of the given term, if the evaluation is
+// being traced.
+func (classical *EfficientlyUpdatable) traceTerm(term int, c piece.Color) {
+	if TracingEnabled && classical.trace != nil {
+		classical.trace.add(term, c, 1)
+	}
+}
+
+// indexes of the tuned terms in a Trace, each of which has a weight for
+// every element of the evaluation variable of the same name
+const (
+	TracePSQT        = 0                                    // [piece type][square], with the material
+	TracePawnStacked = TracePSQT + (piece.TypeN-1)*square.N // [can unstack][file]
+	TraceMobility    = TracePawnStacked + 2*square.FileN    // knight, bishop, rook, and queen
+	TraceRookOpen    = TraceMobility + 9 + 14 + 15 + 28     // semi-open, full-open file
+	TraceDefenders   = TraceRookOpen + 2                    // [defenders]
+	TraceThreats     = TraceDefenders + len(KingDefenders)  // in ThreatTerms order
+	TraceTempo       = TraceThreats + len(ThreatTerms)      // not tapered
+	TraceN           = TraceTempo + 1
+)
+
+// traceMobility contains the index of each piece type's mobility terms.
+var traceMobility = [piece.TypeN]int{
+	piece.Knight: TraceMobility,
+	piece.Bishop: TraceMobility + 9,
+	piece.Rook:   TraceMobility + 9 + 14,
+	piece.Queen:  TraceMobility + 9 + 14 + 15,
+}
+
+// ThreatTerms contains the threat terms, in the order of their traces.
+var ThreatTerms = [...]*Score{
+	&ThreatWeakPawn,
+	&ThreatMinorAttackedByPawn,
+	&ThreatMinorAttackedByMinor,
+	&ThreatMinorAttackedByMajor,
+	&ThreatRookAttackedByLesser,
+	&ThreatMinorAttackedByKing,
+	&ThreatRookAttackedByKing,
+	&ThreatQueenAttackedByOne,
+	&ThreatOverloadedPieces,
+	&ThreatByPawnPush,
+}
+
+// Weights returns the current weights of the tuned terms, in the order of
+// their traces. The untapered Tempo has the same middle and end game
+// weights, and the psqt weights include the material values.
+func Weights() [TraceN]Score {
+	var weights [TraceN]Score
+
+	for t := piece.Pawn; t <= piece.King; t++ {
+		for s := square.A8; s < square.N; s++ {
+			weights[TracePSQT+int(t-piece.Pawn)*square.N+int(s)] = table[piece.New(t, piece.White)][s]
+		}
+	}
+
+	for unstack := range PawnStacked {
+		copy(weights[TracePawnStacked+unstack*square.FileN:], PawnStacked[unstack][:])
+	}
+
+	for t, index := range traceMobility {
+		copy(weights[index:], Mobility[t])
+	}
+
+	weights[TraceRookOpen] = RookSemiOpenFile
+	weights[TraceRookOpen+1] = RookFullOpenFile
+
+	copy(weights[TraceDefenders:], KingDefenders[:])
+
+	for i, term := range ThreatTerms {
+		weights[TraceThreats+i] = *term
+	}
+
+	weights[TraceTempo] = S(Tempo, Tempo)
+	return weights
+}
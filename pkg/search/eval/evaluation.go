@@ -37,6 +37,16 @@ type EfficientlyUpdatable interface {
 	Accumulate(piece.Color) Eval
 }
 
+// NewFunc represents a function which creates a new efficiently updatable
+// evaluation function which evaluates the given board.
+type NewFunc func(*board.Board) EfficientlyUpdatable
+
+// MateIn returns the evaluation for mating in the given plys.
+func MateIn(plys int) Eval {
+	// prefer the shorter lines when mating
+	return Mate - Eval(plys)
+}
+
 // MatedIn returns the evaluation for being mated in the given plys.
 func MatedIn(plys int) Eval {
 	// prefer the longer lines when getting mated
@@ -63,6 +73,12 @@ const (
 	// limits to differentiate between regular and mate in n evaluations
 	WinInMaxPly  Eval = Mate - 2*10000
 	LoseInMaxPly Eval = -WinInMaxPly
+
+	// tablebase wins, which are smaller than the mate scores but larger
+	// than any regular evaluation, and the limits to differentiate them
+	TBWin          Eval = 12000
+	TBWinInMaxPly  Eval = TBWin - 256 // maximum search depth
+	TBLossInMaxPly Eval = -TBWinInMaxPly
 )
 
 // String returns an UCI compliant string representation of the Eval.
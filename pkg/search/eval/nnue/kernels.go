@@ -0,0 +1,53 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package nnue
+
+import "laptudirm.com/x/mess/internal/util"
+
+// the kernels used by the evaluator, which are replaced by vectorized ones
+// during initialization if they are supported by the cpu
+var (
+	addWeights = addWeightsGeneric
+	subWeights = subWeightsGeneric
+	creluDot   = creluDotGeneric
+)
+
+// addWeightsGeneric adds the given weights to the accumulator.
+func addWeightsGeneric(accumulator, weights []int16) {
+	weights = weights[:len(accumulator)]
+	for i := range accumulator {
+		accumulator[i] += weights[i]
+	}
+}
+
+// subWeightsGeneric subtracts the given weights from the accumulator.
+func subWeightsGeneric(accumulator, weights []int16) {
+	weights = weights[:len(accumulator)]
+	for i := range accumulator {
+		accumulator[i] -= weights[i]
+	}
+}
+
+// creluDotGeneric returns the dot product of the clipped relu activation
+// of the given accumulator with the given weights.
+func creluDotGeneric(accumulator, weights []int16) int32 {
+	weights = weights[:len(accumulator)]
+
+	var sum int32
+	for i, value := range accumulator {
+		sum += int32(util.Clamp(value, 0, QA)) * int32(weights[i])
+	}
+
+	return sum
+}
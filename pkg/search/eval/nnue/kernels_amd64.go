@@ -0,0 +1,32 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package nnue
+
+import "laptudirm.com/x/mess/internal/cpu"
+
+func init() {
+	if cpu.HasAVX2 {
+		// use the avx2 kernels
+		addWeights = addWeightsAVX2
+		subWeights = subWeightsAVX2
+		creluDot = creluDotAVX2
+	}
+}
+
+// avx2 versions of the kernels; the slices' lengths should be multiples
+// of 16, and the weights should be at least as long as the accumulator
+
+func addWeightsAVX2(accumulator, weights []int16)
+func subWeightsAVX2(accumulator, weights []int16)
+func creluDotAVX2(accumulator, weights []int16) int32
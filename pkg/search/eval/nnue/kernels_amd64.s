@@ -0,0 +1,95 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "textflag.h"
+
+// func addWeightsAVX2(accumulator, weights []int16)
+TEXT ·addWeightsAVX2(SB), NOSPLIT, $0-48
+	MOVQ accumulator_base+0(FP), DI
+	MOVQ accumulator_len+8(FP), CX
+	MOVQ weights_base+24(FP), SI
+	SHRQ $4, CX // 16 int16s per iteration
+	JZ   add_done
+
+add_loop:
+	VMOVDQU (DI), Y0
+	VPADDW  (SI), Y0, Y0
+	VMOVDQU Y0, (DI)
+	ADDQ    $32, DI
+	ADDQ    $32, SI
+	DECQ    CX
+	JNZ     add_loop
+
+add_done:
+	VZEROUPPER
+	RET
+
+// func subWeightsAVX2(accumulator, weights []int16)
+TEXT ·subWeightsAVX2(SB), NOSPLIT, $0-48
+	MOVQ accumulator_base+0(FP), DI
+	MOVQ accumulator_len+8(FP), CX
+	MOVQ weights_base+24(FP), SI
+	SHRQ $4, CX // 16 int16s per iteration
+	JZ   sub_done
+
+sub_loop:
+	VMOVDQU (DI), Y0
+	VPSUBW  (SI), Y0, Y0
+	VMOVDQU Y0, (DI)
+	ADDQ    $32, DI
+	ADDQ    $32, SI
+	DECQ    CX
+	JNZ     sub_loop
+
+sub_done:
+	VZEROUPPER
+	RET
+
+// func creluDotAVX2(accumulator, weights []int16) int32
+TEXT ·creluDotAVX2(SB), NOSPLIT, $0-52
+	MOVQ accumulator_base+0(FP), DI
+	MOVQ accumulator_len+8(FP), CX
+	MOVQ weights_base+24(FP), SI
+
+	VPXOR        Y0, Y0, Y0 // int32 sums
+	VPXOR        Y1, Y1, Y1 // clipped relu minimum
+	MOVL         $255, AX   // clipped relu maximum, QA
+	VMOVD        AX, X2
+	VPBROADCASTW X2, Y2
+
+	SHRQ $4, CX // 16 int16s per iteration
+	JZ   dot_sum
+
+dot_loop:
+	VMOVDQU  (DI), Y3
+	VPMAXSW  Y1, Y3, Y3
+	VPMINSW  Y2, Y3, Y3
+	VPMADDWD (SI), Y3, Y3 // multiply and add adjacent pairs into int32s
+	VPADDD   Y3, Y0, Y0
+	ADDQ     $32, DI
+	ADDQ     $32, SI
+	DECQ     CX
+	JNZ      dot_loop
+
+dot_sum:
+	// horizontally add the 8 int32 sums
+	VEXTRACTI128 $1, Y0, X1
+	VPADDD       X1, X0, X0
+	VPSHUFD      $0x4e, X0, X1
+	VPADDD       X1, X0, X0
+	VPSHUFD      $0xb1, X0, X1
+	VPADDD       X1, X0, X0
+	VMOVD        X0, AX
+	MOVL         AX, ret+48(FP)
+	VZEROUPPER
+	RET
@@ -0,0 +1,128 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package nnue implements an efficiently updatable neural network (NNUE)
+// evaluation function, which can be used by search in place of the
+// classical evaluation function.
+//
+// The network has a simple 768->Nx2->1 perspective architecture: the 768
+// inputs are the 12 piece types on the 64 squares, relative to the side
+// whose perspective the accumulator is of. The hidden layer, of size N, is
+// activated with a clipped relu, and the two perspectives' accumulators are
+// concatenated, side to move first, before being fed to the output neuron.
+package nnue
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"os"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// network quantization constants
+const (
+	QA    = 255 // quantization of the hidden layer
+	QB    = 64  // quantization of the output layer
+	Scale = 400 // conversion factor from the output to centipawns
+)
+
+// InputN is the number of inputs of a network.
+const InputN = 768
+
+// Network represents a quantized neural network. Networks are read-only
+// after being loaded, so a single network is shared by all the evaluators
+// using it.
+type Network struct {
+	// size of the hidden layer
+	HiddenN int
+
+	// feature transformer, which is efficiently updated
+	FeatureWeights []int16 // [InputN][HiddenN]
+	FeatureBiases  []int16 // [HiddenN]
+
+	// output layer
+	OutputWeights []int16 // [2][HiddenN], side to move first
+	OutputBias    int16
+}
+
+// Load loads a quantized network from the given file. The file contains
+// the little-endian int16 parameters of the network, in the order of the
+// feature weights, feature biases, output weights and the output bias. The
+// file may be padded with zeros at the end, and the hidden layer size is
+// inferred from it's size, which has to be a multiple of 16.
+func Load(path string) (*Network, error) {
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return nil, err
+	}
+
+	// every hidden neuron has InputN feature weights, a feature bias, and
+	// two output weights, and there is a single output bias
+	params := len(data) / 2
+	hiddenN := (params - 1) / (InputN + 3)
+	hiddenN -= hiddenN % 16 // remove padding
+
+	if hiddenN == 0 {
+		return nil, errors.New("nnue: network file is too small")
+	}
+
+	network := NewNetwork(hiddenN)
+
+	offset := 0
+	read := func(params []int16) {
+		for i := range params {
+			params[i] = int16(binary.LittleEndian.Uint16(data[offset:]))
+			offset += 2
+		}
+	}
+
+	read(network.FeatureWeights)
+	read(network.FeatureBiases)
+	read(network.OutputWeights)
+
+	var bias [1]int16
+	read(bias[:])
+	network.OutputBias = bias[0]
+
+	// only padding can follow the parameters
+	for _, b := range data[offset:] {
+		if b != 0 {
+			return nil, fmt.Errorf("nnue: network file has an unexpected size %d", len(data))
+		}
+	}
+
+	return network, nil
+}
+
+// NewNetwork creates a new zeroed network with the given hidden layer size,
+// which should be a multiple of 16 for the vectorized kernels.
+func NewNetwork(hiddenN int) *Network {
+	return &Network{
+		HiddenN: hiddenN,
+
+		FeatureWeights: make([]int16, InputN*hiddenN),
+		FeatureBiases:  make([]int16, hiddenN),
+
+		OutputWeights: make([]int16, 2*hiddenN),
+	}
+}
+
+// NewEvaluator creates a new efficiently updatable evaluator which uses the
+// network. The evaluator doesn't need the board, but the signature matches
+// eval.NewFunc so that the method can be used as an evaluator constructor.
+func (network *Network) NewEvaluator(*board.Board) eval.EfficientlyUpdatable {
+	return New(network)
+}
@@ -0,0 +1,145 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package nnue
+
+import (
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// EfficientlyUpdatable is an efficiently updatable neural network evaluation
+// function. It keeps a stack of accumulators, one for each ply, which are
+// updated by FillSquare and ClearSquare.
+type EfficientlyUpdatable struct {
+	network *Network
+
+	// stack of accumulators, each of which contains the hidden layers of
+	// the white and black perspectives, in that order
+	accumulators []int16
+	current      int // offset of the current position's accumulator
+}
+
+// compile time check that EfficientlyUpdatable implements eval.EfficientlyUpdatable
+var _ eval.EfficientlyUpdatable = (*EfficientlyUpdatable)(nil)
+
+// New creates a new efficiently updatable evaluator using the given network.
+func New(network *Network) *EfficientlyUpdatable {
+	nnue := &EfficientlyUpdatable{
+		network: network,
+
+		// an accumulator for each ply, along with the root position,
+		// which grows along with the board's history in longer games
+		accumulators: make([]int16, (move.MaxN+1)*2*network.HiddenN),
+	}
+
+	nnue.Reset()
+	return nnue
+}
+
+// FillSquare adds the given piece to the given square of a chessboard.
+func (nnue *EfficientlyUpdatable) FillSquare(s square.Square, p piece.Piece) {
+	white, black := nnue.accumulator()
+	addWeights(white, nnue.weights(piece.White, s, p))
+	addWeights(black, nnue.weights(piece.Black, s, p))
+}
+
+// ClearSquare removes the given piece from the given square.
+func (nnue *EfficientlyUpdatable) ClearSquare(s square.Square, p piece.Piece) {
+	white, black := nnue.accumulator()
+	subWeights(white, nnue.weights(piece.White, s, p))
+	subWeights(black, nnue.weights(piece.Black, s, p))
+}
+
+// Push pushes a copy of the current accumulator into the stack, so that
+// the current accumulator can be restored later with Pop.
+func (nnue *EfficientlyUpdatable) Push() {
+	size := 2 * nnue.network.HiddenN
+	if nnue.current+2*size > len(nnue.accumulators) {
+		// stack is full, grow it by an accumulator
+		nnue.accumulators = append(nnue.accumulators, make([]int16, size)...)
+	}
+
+	copy(nnue.accumulators[nnue.current+size:nnue.current+2*size], nnue.accumulators[nnue.current:nnue.current+size])
+	nnue.current += size
+}
+
+// Pop restores the accumulator of the previous position.
+func (nnue *EfficientlyUpdatable) Pop() {
+	nnue.current -= 2 * nnue.network.HiddenN
+}
+
+// Reset resets the accumulator to that of an empty board.
+func (nnue *EfficientlyUpdatable) Reset() {
+	nnue.current = 0
+
+	white, black := nnue.accumulator()
+	copy(white, nnue.network.FeatureBiases)
+	copy(black, nnue.network.FeatureBiases)
+}
+
+// Accumulate runs the output layer of the network on the current
+// accumulator, and returns the evaluation of the position from the
+// perspective of the given color.
+func (nnue *EfficientlyUpdatable) Accumulate(stm piece.Color) eval.Eval {
+	hiddenN := nnue.network.HiddenN
+
+	us, them := nnue.accumulator()
+	if stm == piece.Black {
+		us, them = them, us
+	}
+
+	// the output weights of the side to move come first
+	output := int64(creluDot(us, nnue.network.OutputWeights[:hiddenN]))
+	output += int64(creluDot(them, nnue.network.OutputWeights[hiddenN:]))
+	output += int64(nnue.network.OutputBias)
+
+	// dequantize the output
+	return eval.Eval(output * Scale / (QA * QB))
+}
+
+// accumulator returns the white and black perspective hidden layers of the
+// current position's accumulator.
+func (nnue *EfficientlyUpdatable) accumulator() (white, black []int16) {
+	hiddenN := nnue.network.HiddenN
+	white = nnue.accumulators[nnue.current : nnue.current+hiddenN]
+	black = nnue.accumulators[nnue.current+hiddenN : nnue.current+2*hiddenN]
+	return white, black
+}
+
+// weights returns the feature weights of the given piece on the given
+// square from the given perspective.
+func (nnue *EfficientlyUpdatable) weights(perspective piece.Color, s square.Square, p piece.Piece) []int16 {
+	index := featureIndex(perspective, s, p) * nnue.network.HiddenN
+	return nnue.network.FeatureWeights[index : index+nnue.network.HiddenN]
+}
+
+// featureIndex returns the network input index of the given piece on the
+// given square from the given perspective. Inputs are indexed by the
+// relative color of the piece, it's type, and the square with a1 = 0,
+// flipped vertically for the black perspective.
+func featureIndex(perspective piece.Color, s square.Square, p piece.Piece) int {
+	// squares are numbered from a8, so flip them for the white perspective
+	if perspective == piece.White {
+		s ^= 56
+	}
+
+	side := 0 // our piece
+	if p.Color() != perspective {
+		side = 1 // their piece
+	}
+
+	return side*384 + (int(p.Type())-1)*64 + int(s)
+}
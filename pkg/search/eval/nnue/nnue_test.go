@@ -0,0 +1,168 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package nnue
+
+import (
+	"encoding/binary"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+)
+
+// randomNetwork creates a network with random parameters of realistic
+// magnitudes, and writes it to a network file in the given directory.
+func randomNetwork(t *testing.T, dir string) (*Network, string) {
+	rng := rand.New(rand.NewSource(1))
+	network := NewNetwork(64)
+
+	var data []byte
+	fill := func(params []int16, max int) {
+		for i := range params {
+			params[i] = int16(rng.Intn(2*max+1) - max)
+			data = binary.LittleEndian.AppendUint16(data, uint16(params[i]))
+		}
+	}
+
+	fill(network.FeatureWeights, 100)
+	fill(network.FeatureBiases, 100)
+	fill(network.OutputWeights, 100)
+
+	var bias [1]int16
+	fill(bias[:], 1000)
+	network.OutputBias = bias[0]
+
+	path := filepath.Join(dir, "random.nnue")
+	if err := os.WriteFile(path, data, 0o644); err != nil {
+		t.Fatal(err)
+	}
+
+	return network, path
+}
+
+func TestLoad(t *testing.T) {
+	network, path := randomNetwork(t, t.TempDir())
+
+	loaded, err := Load(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if loaded.HiddenN != network.HiddenN || loaded.OutputBias != network.OutputBias ||
+		!equal(loaded.FeatureWeights, network.FeatureWeights) ||
+		!equal(loaded.FeatureBiases, network.FeatureBiases) ||
+		!equal(loaded.OutputWeights, network.OutputWeights) {
+		t.Fatal("loaded network doesn't match the written network")
+	}
+}
+
+// TestAccumulator checks that the efficiently updated accumulators, and
+// thus the evaluations, match freshly filled ones in every position of a
+// small tree. The active kernels are compared against the generic ones.
+func TestAccumulator(t *testing.T) {
+	network, _ := randomNetwork(t, t.TempDir())
+
+	evaluator := New(network)
+	b := board.New(board.EU(evaluator), board.FEN(fen.FromString(
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	)))
+
+	testAccumulator(t, b, evaluator, 3)
+}
+
+// TestLongGame checks that the accumulators are still efficiently updated
+// in a game which is longer than move.MaxN plys.
+func TestLongGame(t *testing.T) {
+	network, _ := randomNetwork(t, t.TempDir())
+
+	evaluator := New(network)
+	b := board.New(board.EU(evaluator), board.FEN(board.StartFEN))
+
+	// shuffle the knights, which returns to the starting position
+	shuffle := []string{"g1f3", "g8f6", "f3g1", "f6g8"}
+	plys := move.MaxN + 2*len(shuffle)
+	for i := 0; i < plys; i++ {
+		b.MakeMove(b.NewMoveFromString(shuffle[i%len(shuffle)]))
+	}
+
+	testAccumulator(t, b, evaluator, 1)
+
+	for i := 0; i < plys; i++ {
+		b.UnmakeMove()
+	}
+
+	testAccumulator(t, b, evaluator, 0)
+}
+
+func testAccumulator(t *testing.T, b *board.Board, evaluator *EfficientlyUpdatable, depth int) {
+	network := evaluator.network
+	white, black := evaluator.accumulator()
+
+	// fill fresh accumulators with the generic kernels
+	freshWhite := append([]int16(nil), network.FeatureBiases...)
+	freshBlack := append([]int16(nil), network.FeatureBiases...)
+	for s := square.A8; s <= square.H1; s++ {
+		if p := b.Position[s]; p != piece.NoPiece {
+			addWeightsGeneric(freshWhite, evaluator.weights(piece.White, s, p))
+			addWeightsGeneric(freshBlack, evaluator.weights(piece.Black, s, p))
+		}
+	}
+
+	if !equal(white, freshWhite) || !equal(black, freshBlack) {
+		t.Fatalf("%v: efficiently updated accumulator doesn't match", b.FEN())
+	}
+
+	for _, stm := range []piece.Color{piece.White, piece.Black} {
+		us, them := white, black
+		if stm == piece.Black {
+			us, them = them, us
+		}
+
+		usWeights, themWeights := network.OutputWeights[:network.HiddenN], network.OutputWeights[network.HiddenN:]
+		if creluDot(us, usWeights) != creluDotGeneric(us, usWeights) ||
+			creluDot(them, themWeights) != creluDotGeneric(them, themWeights) {
+			t.Fatalf("%v: output kernel doesn't match the generic kernel", b.FEN())
+		}
+	}
+
+	if depth == 0 {
+		return
+	}
+
+	for _, m := range b.GenerateMoves(false) {
+		b.MakeMove(m)
+		testAccumulator(t, b, evaluator, depth-1)
+		b.UnmakeMove()
+	}
+}
+
+func equal(a, b []int16) bool {
+	if len(a) != len(b) {
+		return false
+	}
+
+	for i := range a {
+		if a[i] != b[i] {
+			return false
+		}
+	}
+
+	return true
+}
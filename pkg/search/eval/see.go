@@ -68,13 +68,22 @@ func SEE(b *board.Board, m move.Move, threshold Eval) bool {
 	// calculate attackers to target square
 	attackers := attackersTo(b, target, occupied) & occupied
 
+	// pinned pieces of either side can only recapture along their pin
+	// ray, which is the case when the target square is beyond them from
+	// their king
+	var pinned bitboard.Board
+	for _, c := range [...]piece.Color{piece.White, piece.Black} {
+		kingSq := b.KingBB(c).FirstOne()
+		pinned |= b.Pinned(c) &^ bitboard.Between[kingSq][target]
+	}
+
 	// calculate ray attackers to reveal x-rays
 	diagonal := b.PieceBBs[piece.Bishop] | b.PieceBBs[piece.Queen] // diagonal attackers
 	straight := b.PieceBBs[piece.Rook] | b.PieceBBs[piece.Queen]   // straight attackers
 
 	for {
 		// calculate friendly attackers
-		friends := attackers & b.ColorBBs[sideToMove]
+		friends := attackers & b.ColorBBs[sideToMove] &^ pinned
 		if friends == bitboard.Empty {
 			// no more friendly attackers: end see
 			break
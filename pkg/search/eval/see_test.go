@@ -0,0 +1,77 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package eval_test
+
+import (
+	"testing"
+
+	"laptudirm.com/x/mess/internal/bench"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+func BenchmarkSEE(b *testing.B) {
+	boards := make([]*board.Board, len(bench.FENs))
+	moves := make([][]move.Move, len(bench.FENs))
+	for i, fenString := range bench.FENs {
+		boards[i] = board.New(board.FEN(fen.FromString(fenString)))
+		moves[i] = boards[i].GenerateMoves(false)
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for j, chessboard := range boards {
+			for _, m := range moves[j] {
+				eval.SEE(chessboard, m, 0)
+			}
+		}
+	}
+}
+
+func TestSEEPinned(t *testing.T) {
+	tests := []struct {
+		fen  string
+		want bool
+	}{
+		// the rook recaptures on d5 and wins a pawn
+		{"6k1/8/4p3/3n4/8/2N5/r2R4/7K w - - 0 1", true},
+		// the rook is pinned to the king and can't recapture
+		{"6k1/8/4p3/3n4/8/2N5/r2R3K/8 w - - 0 1", false},
+		// the bishop recaptures on d5 and wins the knight for a pawn
+		{"6k1/8/4b3/3p4/8/2N5/8/4R2K w - - 0 1", false},
+		// the enemy bishop is pinned to it's king and can't recapture
+		{"4k3/8/4b3/3p4/8/2N5/8/4R2K w - - 0 1", true},
+	}
+
+	for _, test := range tests {
+		chessboard := board.New(board.FEN(fen.FromString(test.fen)))
+
+		found := false
+		for _, m := range chessboard.GenerateMoves(false) {
+			if m.String() == "c3d5" {
+				found = true
+				if got := eval.SEE(chessboard, m, 100); got != test.want {
+					t.Errorf("%s: SEE(c3d5, 100) = %v, want %v", test.fen, got, test.want)
+				}
+			}
+		}
+
+		if !found {
+			t.Errorf("%s: c3d5 not generated", test.fen)
+		}
+	}
+}
@@ -13,12 +13,46 @@
 
 package search
 
-import "laptudirm.com/x/mess/pkg/search/eval"
+import (
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
 
 // score return the static evaluation of the current context's internal
-// board. Any changes to the evaluation function should be done here.
+// board. Any changes to the evaluation function should be done here. The
+// evaluations are cached, so that transpositions and re-searches of the
+// same position don't evaluate it again.
 func (search *Context) score() eval.Eval {
-	return search.evaluator.Accumulate(search.board.SideToMove)
+	hash := search.board.Hash
+	entry := &search.evals[hash%evalTableSize]
+
+	search.stats.EvalProbes++
+	if entry.key == hash {
+		// eval cache hit
+		search.stats.EvalHits++
+		return entry.eval
+	}
+
+	score := search.evaluator.Accumulate(search.board.SideToMove)
+	*entry = evalEntry{key: hash, eval: score}
+	return score
+}
+
+// evalTableSize is the number of entries in an eval cache.
+const evalTableSize = 1 << 14
+
+// evalTable is a hash table which caches the static evaluations of the
+// positions, indexed by their zobrist hash. Since it is not shared, each
+// thread has it's own eval cache, which is cleared with the evaluator.
+//
+// A zeroed entry is treated as the position with a zero hash, which is
+// astronomically unlikely to be searched, so empty entries aren't marked.
+type evalTable [evalTableSize]evalEntry
+
+// evalEntry is an entry of the eval cache.
+type evalEntry struct {
+	key  zobrist.Key // hash of the entry's position
+	eval eval.Eval   // static evaluation of the position
 }
 
 // draw returns a randomized draw score to prevent threefold-repetition
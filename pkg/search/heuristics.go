@@ -22,11 +22,12 @@ import (
 // storeKiller tries to store the given move from the given depth as one
 // of the two killer moves.
 func (search *Context) storeKiller(plys int, killer move.Move) {
-	if !killer.IsCapture() && killer != search.killers[plys][0] {
+	killers := &search.stack[plys].killers
+	if !killer.IsCapture() && killer != killers[0] {
 		// different move in killer 1
 		// move it to killer 2 position
-		search.killers[plys][1] = search.killers[plys][0]
-		search.killers[plys][0] = killer // new killer 1
+		killers[1] = killers[0]
+		killers[0] = killer // new killer 1
 	}
 }
 
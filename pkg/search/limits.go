@@ -14,7 +14,9 @@
 package search
 
 import (
+	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/search/eval"
 )
 
 // Limits contains the various limits which decide how long a search can
@@ -25,8 +27,11 @@ type Limits struct {
 	Nodes int
 	Depth int
 
-	// TODO: implement searching selected moves
-	// Moves []move.Move
+	// root moves to search, all of them if empty
+	Moves []move.Move
+
+	// stop once a mate in Mate moves is found, if non-zero
+	Mate int
 
 	// search time limits
 	Infinite        bool
@@ -38,27 +43,65 @@ type Limits struct {
 // UpdateLimits updates the search limits while a search is in progress.
 // The caller should make sure that a search is indeed in progress before
 // calling UpdateLimits.
+//
+// The new limits and their time manager are created on the caller's
+// goroutine, from the root position's state captured by start, and are
+// then handed over to the main search thread, which installs them the
+// next time it checks the limits. The search's state is never touched by
+// the caller, so it is safe to call from another goroutine.
 func (search *Context) UpdateLimits(limits Limits) {
-	search.limits = limits // update limits
+	update := &limitsUpdate{limits: limits}
 
 	switch {
 	case limits.Infinite:
-		return
+		// no time management, and don't keep the time manager of a
+		// previous search, which would end the iterations early
 
 	case limits.MoveTime != 0:
-		search.time = &TimeManagerMovetime{Duration: limits.MoveTime}
+		update.time = &TimeManagerMovetime{Duration: limits.MoveTime}
 
 	default:
-		search.time = &TimeManagerNormal{
+		update.time = &TimeManagerNormal{
 			Time:      limits.Time,
 			Increment: limits.Increment,
 			MovesToGo: limits.MovesToGo,
 			Us:        search.sideToMove,
+			Plys:      search.rootPlys,
 			context:   search,
 		}
 	}
 
-	search.time.GetDeadline() // get search deadline
+	if update.time != nil {
+		update.time.GetDeadline() // get search deadline
+	}
+
+	search.update.Store(update)
+
+	// wake up the main thread if it is waiting in infinite mode
+	search.notify()
+}
+
+// limitsUpdate is a set of limits, along with their time manager, which
+// are waiting to be installed by the main search thread.
+type limitsUpdate struct {
+	limits Limits
+	time   TimeManager // nil for infinite limits
+}
+
+// installLimits installs the limits from the last call to UpdateLimits,
+// if they haven't been installed yet. It is only called by the thread
+// which owns the context, so that the limits are never replaced while
+// they are being used.
+func (search *Context) installLimits() {
+	if update := search.update.Swap(nil); update != nil {
+		search.limits, search.time = update.limits, update.time
+	}
+}
+
+// mateFound reports whether the search has found a mate which satisfies
+// the mate limit, after which searching deeper is unnecessary.
+func (search *Context) mateFound() bool {
+	return search.limits.Mate > 0 && search.pvScore >= eval.MateIn(2*search.limits.Mate-1)
 }
 
 // shouldStop checks the various limits provided for the search and
@@ -69,20 +112,31 @@ func (search *Context) shouldStop() bool {
 	// loop so it's breaching isn't tested in this function
 
 	switch {
-	case search.stopped:
+	case search.stopped.Load():
 		// search already stopped
 		// no checking necessary
 		return true
 
-	case search.stats.Nodes&2047 != 0, search.limits.Infinite:
+	case search.stats.Nodes&2047 != 0:
 		// only check once every 2048 nodes to prevent
 		// spending too much time here
+		return false
+	}
 
-		// if search is infinite never stop
+	// publish the node and tablebase hit counts for the reports
+	search.nodes.Store(int64(search.stats.Nodes))
+	search.tbHits.Store(int64(search.stats.TBHits))
+	search.reportProgress()
+
+	// install the limits from a ponderhit, if any
+	search.installLimits()
 
+	switch {
+	case search.limits.Infinite:
+		// if search is infinite never stop
 		return false
 
-	case search.stats.Nodes > search.limits.Nodes, search.time.PessimisticExpired():
+	case search.totalNodes() > search.limits.Nodes, search.time.PessimisticExpired():
 		// node limit or time limit crossed
 		search.Stop()
 		return true
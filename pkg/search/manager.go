@@ -17,7 +17,9 @@ import (
 	"time"
 
 	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/search/eval"
 )
 
 // Manager represents a time manager.
@@ -26,9 +28,10 @@ type TimeManager interface {
 	// and sets a deadline internally for the search's end.
 	GetDeadline()
 
-	// ExtendDeadline is called when the engine want's to extend the
-	// search's length. A deadline extension may fail.
-	ExtendDeadline()
+	// UpdateDeadline is called by the main thread after each completed
+	// iteration, so that the manager can adjust the search's deadline
+	// depending on the results of the search so far.
+	UpdateDeadline()
 
 	// PessimisticExpired reports if the search deadline has been crossed.
 	PessimisticExpired() bool
@@ -38,14 +41,28 @@ type TimeManager interface {
 // NormalManager is the standard time manager which uses the wtime, btime,
 // winc, binc, and movestogo provided by the GUI to calculate the optimal
 // search time.
+//
+// The optimal time is used as a soft limit, which is checked after each
+// iteration, and is scaled by the stability of the best move, the drop in
+// it's score, and the fraction of the root nodes spent searching it. The
+// soft limit is never scaled beyond the hard limit, which is checked
+// during the search.
 type TimeManagerNormal struct {
-	Us piece.Color // side to move
+	Us   piece.Color // side to move
+	Plys int         // plys played before the root position
 
 	Time, Increment [piece.ColorN]int
 	MovesToGo       int // moves to next time control
 
-	deadline time.Time // search end deadline
-	maxUsage time.Time
+	start    time.Time
+	optimum  time.Duration // unscaled soft limit
+	deadline time.Time     // scaled soft limit
+	maxUsage time.Time     // hard limit
+
+	// results of the previous iteration
+	bestMove  move.Move
+	bestScore eval.Eval
+	stability int // iterations for which the best move hasn't changed
 
 	context *Context
 }
@@ -53,19 +70,82 @@ type TimeManagerNormal struct {
 // compile time check that NormalManager implements Manager
 var _ TimeManager = (*TimeManagerNormal)(nil)
 
+// time manager parameters
+const (
+	// time in milliseconds kept aside for the communication overhead
+	moveOverhead = 10
+
+	// minimum iteration depth after which the soft limit is scaled, the
+	// earlier iterations are too unstable and take negligible time
+	minScaleDepth = 6
+)
+
+// soft limit scale factors for each best move stability count
+var stabilityScale = [...]float64{2.2, 1.6, 1.3, 1.1, 0.95, 0.85, 0.75}
+
 func (c *TimeManagerNormal) GetDeadline() {
 	if c.MovesToGo == 0 {
-		c.MovesToGo = util.Max(20, 50-(c.context.board.Plys/2))
+		c.MovesToGo = util.Max(20, 50-(c.Plys/2))
 	}
 
-	maximum := time.Duration(c.Time[c.Us]) * time.Millisecond
+	remaining := time.Duration(util.Max(c.Time[c.Us]-moveOverhead, 1)) * time.Millisecond
+	increment := time.Duration(c.Increment[c.Us]) * time.Millisecond
 
-	c.deadline = time.Now().Add(maximum / time.Duration(c.MovesToGo))
-	c.maxUsage = time.Now().Add(maximum / 2)
+	// most of the increment can be used every move since it is added
+	// to the clock after the move, but the hard limit is kept at a safe
+	// fraction of the remaining time so that the clock never runs out
+	maximum := util.Min(5*(remaining/time.Duration(c.MovesToGo)+increment), remaining*3/4)
+	c.optimum = util.Min(remaining/time.Duration(c.MovesToGo)+increment*3/4, maximum)
+
+	c.start = time.Now()
+	c.deadline = c.start.Add(c.optimum)
+	c.maxUsage = c.start.Add(maximum)
+
+	c.bestMove = move.Null
+	c.stability = 0
 }
 
-func (c *TimeManagerNormal) ExtendDeadline() {
-	c.deadline = c.deadline.Add((time.Duration(c.Time[c.Us]) * time.Millisecond) / 30)
+func (c *TimeManagerNormal) UpdateDeadline() {
+	search := c.context
+	bestMove, bestScore := search.pv.Move(0), search.pvScore
+
+	// the best move has been stable for another iteration
+	if bestMove == c.bestMove {
+		c.stability = util.Min(c.stability+1, len(stabilityScale)-1)
+	} else {
+		c.stability = 0
+	}
+
+	// no score drop in the first iteration seen by the manager
+	scoreDrop := eval.Eval(0)
+	if c.bestMove != move.Null {
+		scoreDrop = c.bestScore - bestScore
+	}
+
+	c.bestMove, c.bestScore = bestMove, bestScore
+
+	if search.stats.Depth < minScaleDepth {
+		return
+	}
+
+	// a stable best move probably doesn't need more time
+	scale := stabilityScale[c.stability]
+
+	// a falling score needs more time to find a better move
+	scale *= util.Clamp(1+float64(scoreDrop)/100, 0.8, 1.6)
+
+	// a best move which took most of the root's nodes is probably
+	// clearly better than the other moves, which were refuted quickly
+	if search.stats.Nodes > 0 {
+		nodes := search.stats.RootNodes[bestMove.Source()][bestMove.Target()]
+		fraction := float64(nodes) / float64(search.stats.Nodes)
+		scale *= (1.5 - fraction) * 1.35
+	}
+
+	c.deadline = c.start.Add(time.Duration(float64(c.optimum) * scale))
+	if c.deadline.After(c.maxUsage) {
+		c.deadline = c.maxUsage
+	}
 }
 
 func (c *TimeManagerNormal) PessimisticExpired() bool {
@@ -90,8 +170,8 @@ func (c *TimeManagerMovetime) GetDeadline() {
 	c.deadline = time.Now().Add(time.Duration(c.Duration) * time.Millisecond)
 }
 
-func (c *TimeManagerMovetime) ExtendDeadline() {
-	// can't extend deadline: search time is fixed
+func (c *TimeManagerMovetime) UpdateDeadline() {
+	// can't update deadline: search time is fixed
 }
 
 func (c *TimeManagerMovetime) PessimisticExpired() bool {
@@ -0,0 +1,87 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// rootLine is one of the principal variations of a search, along with
+// it's score. Multiple lines are searched in multipv mode, where the
+// line at index k is the best line which doesn't start with the first
+// move of any of the lines before it.
+type rootLine struct {
+	pv    move.Variation
+	score eval.Eval
+}
+
+// SetMultiPV sets the number of best lines the main thread searches and
+// reports in each iteration. The lines share the search's tt, so each of
+// the lines after the first is much cheaper to search than a separate
+// search would be. It should not be called while a search is in progress.
+func (search *Context) SetMultiPV(lines int) {
+	search.multiPV = util.Max(lines, 1)
+}
+
+// initLines initializes the root lines for a new search of the given
+// number of lines. The scores of the lines are initialized to pvScore,
+// which is used as the aspiration window's guess in the first iteration.
+func (search *Context) initLines(lines int) {
+	if cap(search.lines) < lines {
+		search.lines = make([]rootLine, lines)
+	}
+
+	// reuse the buffers of the old lines
+	search.lines = search.lines[:lines]
+	for i := range search.lines {
+		search.lines[i].pv.Clear()
+		search.lines[i].score = search.pvScore
+	}
+}
+
+// multiPVLines returns the number of lines which should be searched on
+// the current position, which is never more than the number of root moves
+// being searched, except when there are none, when a single line is.
+func (search *Context) multiPVLines() int {
+	if search.multiPV <= 1 {
+		return 1
+	}
+
+	moves := len(search.rootMoves)
+	if moves == 0 {
+		moves = len(search.board.GenerateMoves(false))
+	}
+
+	return util.Clamp(moves, 1, search.multiPV)
+}
+
+// rootRestricted reports whether some of the root moves are excluded from
+// the current root search, either by the search limits or by the lines
+// which have been already searched in multipv mode.
+func (search *Context) rootRestricted() bool {
+	return search.pvIndex > 0 || len(search.rootMoves) > 0
+}
+
+// sortLines sorts the lines found in the last iteration in order of their
+// scores. The lines are searched in order, so they are mostly sorted and
+// an insertion sort is used.
+func (search *Context) sortLines() {
+	for i := 1; i < len(search.lines); i++ {
+		for j := i; j > 0 && search.lines[j].score > search.lines[j-1].score; j-- {
+			search.lines[j], search.lines[j-1] = search.lines[j-1], search.lines[j]
+		}
+	}
+}
@@ -31,8 +31,13 @@ import (
 // nodes that need to be searched, due to the fact that a single refutation
 // is enough to mark a position as worse compared to an already found one.
 // https://www.chessprogramming.org/Alpha-Beta
-func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.Variation) eval.Eval {
+func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval) eval.Eval {
 	search.stats.Nodes++
+	search.count(CounterMainNodes)
+
+	// the node's pv is stored in it's stack frame
+	pv := &search.stack[plys].pv
+	pv.Clear()
 
 	// update highest reached depth
 	search.stats.SelDepth = util.Max(search.stats.SelDepth, plys)
@@ -40,7 +45,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 	// node properties
 	isCheck := search.board.IsInCheck(search.board.SideToMove)
 	isPVNode := beta-alpha != 1 // beta = alpha + 1 during PVS
-	isNullMove := search.board.Plys > 0 && search.board.History[search.board.Plys-1].Move == move.Null
+	isNullMove := plys > 0 && search.stack[plys-1].move == move.Null
 
 	// Check Extension: If position is in check, extend search depth so
 	// that we don't push anything important over the horizon. This also
@@ -74,13 +79,6 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		return search.quiescence(plys, alpha, beta)
 	}
 
-	// generate all moves
-	moves := search.board.GenerateMoves(false)
-	if len(moves) == 0 {
-		// position is mated; checkmate if king is in check
-		return util.Ternary(isCheck, eval.MatedIn(plys), eval.Draw)
-	}
-
 	// keep track of the original value of alpha for determining whether
 	// the score will act as an upper bound entry in the transposition table
 	originalAlpha := alpha
@@ -94,7 +92,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 	var posEval eval.Eval
 
 	// check for transposition table hits
-	if entry, hit := search.tt.Probe(search.board.Hash); hit {
+	if entry, hit := search.probeTT(); hit {
 		// use pv move for move ordering in any case
 		bestMove = entry.Move
 
@@ -104,8 +102,6 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		// only use entry if current node is not a pv node and
 		// entry depth is >= current depth (not worse quality)
 		if !isPVNode && !isNullMove && int(entry.Depth) >= depth {
-			search.stats.TTHits++
-
 			// check if the tt entry can be used to exit the search early
 			// on this node. If we have an exact value, we can safely
 			// return it. If we have a new upper bound or lower bound,
@@ -116,6 +112,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 				entry.Type == tt.UpperBound && alpha >= value: // fail high
 				// exit search early cause we have an exact
 				// score or a beta cutoff from the tt entry
+				search.count(CounterTTCutoffs)
 				return value
 			}
 		}
@@ -125,6 +122,27 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		posEval = search.score()
 	}
 
+	// Tablebase Probing: If the position is in the endgame tablebase, it's
+	// result is known and the search can exit early. The result is stored
+	// in the tt as an exact score with a depth bonus, since it is more
+	// reliable than any searched score.
+	if plys > 0 {
+		if value, hit := search.probeWDL(plys); hit {
+			search.storeTT(tt.Entry{
+				Hash:  search.board.Hash,
+				Value: tt.EvalFrom(value, plys),
+				Move:  move.Null,
+				Depth: uint8(util.Min(depth+6, MaxDepth-1)),
+				Type:  tt.ExactEntry,
+			})
+
+			search.count(CounterTBCutoffs)
+			return value
+		}
+	}
+
+	search.stack[plys].eval = posEval
+
 	// Internal Iterative Reduction (IIR): If a hash move is not found by
 	// probing the transposition table, do a shallower search, as our move
 	// ordering won't be as effective.
@@ -137,6 +155,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		// beta that we can expect the node to fail high and thus we can
 		// safely prune this branch.
 		if depth <= 5 && posEval >= beta && posEval-eval.Eval(75*depth) >= beta && posEval < eval.WinInMaxPly {
+			search.count(CounterRFP)
 			return posEval
 		}
 
@@ -144,7 +163,9 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		// and if qsearch score is <= alpha, don't spend any more time
 		// searching this node which will probably fail low.
 		if depth <= 3 && posEval+eval.Eval(200*depth) <= alpha {
+			search.count(CounterRazorTries)
 			if score := search.quiescence(plys, alpha, beta); score <= alpha {
+				search.count(CounterRazorPrunes)
 				return score
 			}
 		}
@@ -164,11 +185,15 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 
 			reduction := 5 + util.Min(4, depth/5) + util.Min(3, (int(posEval)-int(beta))/214)
 
+			search.count(CounterNMPTries)
+			search.stack[plys].move = move.Null
+			search.tt.Prefetch(search.board.KeyAfter(move.Null))
 			search.board.MakeMove(move.Null)
-			score := -search.negamax(plys+1, depth-reduction, -beta, -beta+1, &move.Variation{})
+			score := -search.negamax(plys+1, depth-reduction, -beta, -beta+1)
 			search.board.UnmakeMove()
 
 			if score >= beta {
+				search.count(CounterNMPCutoffs)
 				return beta
 			}
 		}
@@ -178,18 +203,16 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 	historyBonus := depthBonus(depth)
 	seeQuietMargin, seeNoisyMargin := seeMargins(depth)
 
-	// move ordering; score the generated moves
-	list := move.ScoreMoves(moves, eval.OfMove(eval.ModeEvalInfo{
-		Board:   &search.board.Position,
-		PVMove:  bestMove,
-		Killers: search.killers[plys],
-		History: &search.history[search.board.SideToMove],
-	}))
-
-	for i := 0; i < list.Length; i++ {
-		var childPV move.Variation
+	// staged move generation and ordering
+	picker := &search.stack[plys].picker
+	picker.init(search, plys, bestMove, false)
 
-		move := list.PickMove(i)
+	for i := 0; ; i++ {
+		move, ok := picker.next()
+		if !ok {
+			// no moves left
+			break
+		}
 
 		if !isPVNode && i > 0 {
 			// Late Move Pruning (LMP): If the depth is low enough, we can ignore most
@@ -197,6 +220,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 			// probably won't raise alpha anyways. The depth constraint is to make sure
 			// that we don't miss anything at higher depths.
 			if depth <= 3 && i >= depth*10 {
+				search.count(CounterLMP)
 				break
 			}
 
@@ -208,17 +232,32 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 				if move.IsQuiet() {
 					// Quiet SEE
 					if depth <= 3 && !eval.SEE(search.board, move, seeQuietMargin) {
+						search.count(CounterSEEQuiet)
 						continue
 					}
 				} else {
 					// Noisy SEE
 					if depth <= 6 && !eval.SEE(search.board, move, seeNoisyMargin) {
+						search.count(CounterSEENoisy)
 						continue
 					}
 				}
 			}
 		}
 
+		search.stack[plys].move = move
+
+		if plys == 0 {
+			// report the root move being searched
+			search.rootMoveNumber = i + 1
+			search.reportProgress()
+		}
+
+		// start loading the child's tt bucket, which is probed
+		// first thing after the relatively expensive make move
+		search.tt.Prefetch(search.board.KeyAfter(move))
+
+		nodes := search.stats.Nodes
 		search.board.MakeMove(move)
 
 		var score eval.Eval
@@ -233,17 +272,20 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 			rDepth = util.Clamp(depth-rDepth, 1, depth+1)
 
 			// reduced depth search
-			score = -search.negamax(plys+1, rDepth, -alpha-1, -alpha, &childPV)
+			search.count(CounterLMRSearches)
+			score = -search.negamax(plys+1, rDepth, -alpha-1, -alpha)
 			if score <= alpha {
 				break
 			}
 
+			search.count(CounterLMRResearches)
+
 			// lmr failed: do a full depth research
 			fallthrough
 
 		case !isPVNode || i > 0:
 			// full depth search if lmr failed or for a non-PV node
-			score = -search.negamax(plys+1, depth-1, -alpha-1, -alpha, &childPV)
+			score = -search.negamax(plys+1, depth-1, -alpha-1, -alpha)
 		}
 
 		// Principal Variation Search (PVS): Search PV nodes with a full
@@ -252,11 +294,20 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		// that they are worse compared to the PV.
 		if isPVNode && ((score > alpha && score < beta) || i == 0) {
 			// full window search for pv nodes
-			score = -search.negamax(plys+1, depth-1, -beta, -alpha, &childPV)
+			if i > 0 {
+				search.count(CounterPVSResearches)
+			}
+
+			score = -search.negamax(plys+1, depth-1, -beta, -alpha)
 		}
 
 		search.board.UnmakeMove()
 
+		if plys == 0 {
+			// keep track of the effort spent on each root move
+			search.stats.RootNodes[move.Source()][move.Target()] += search.stats.Nodes - nodes
+		}
+
 		// update score and bounds
 		if score > bestScore {
 			// better move found
@@ -269,13 +320,18 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 				alpha = score
 
 				// update parent pv
-				pv.Update(move, childPV)
+				pv.Update(move, search.stack[plys+1].pv)
 
 				if alpha >= beta {
 					// move ordering heuristics
 					search.storeKiller(plys, move)           // killer move
 					search.updateHistory(move, historyBonus) // history bonus
 
+					search.count(CounterFailHighs)
+					if i == 0 {
+						search.count(CounterFirstFailHighs)
+					}
+
 					break // fail high
 				}
 			}
@@ -285,9 +341,16 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		search.updateHistory(move, -historyBonus)
 	}
 
+	if bestScore == -eval.Inf {
+		// no moves were searched, so there are no legal moves in the
+		// position; checkmate if king is in check, stalemate otherwise
+		return util.Ternary(isCheck, eval.MatedIn(plys), eval.Draw)
+	}
+
 	// if search is stopped, score may be of a bad quality and
-	// thus can pollute the transposition table for future searches
-	if !search.stopped {
+	// thus can pollute the transposition table for future searches;
+	// the root's score is also bad if some root moves were excluded
+	if !search.stopped.Load() && (plys > 0 || !search.rootRestricted()) {
 		var entryType tt.EntryType
 		switch {
 		case bestScore <= originalAlpha:
@@ -307,7 +370,7 @@ func (search *Context) negamax(plys, depth int, alpha, beta eval.Eval, pv *move.
 		}
 
 		// update transposition table
-		search.tt.Store(tt.Entry{
+		search.storeTT(tt.Entry{
 			Hash:  search.board.Hash,
 			Value: tt.EvalFrom(bestScore, plys),
 			Move:  bestMove,
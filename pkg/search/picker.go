@@ -0,0 +1,255 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// maxMoves is the size of the move buffers, which is larger than the
+// maximum number of legal moves possible in a position (218).
+const maxMoves = 256
+
+// movePicker is a staged move picker, which generates and orders the moves
+// of a position lazily, so that the work isn't wasted if a node fails high
+// on one of the first moves. The moves are picked in the following order:
+//  1. the tt move, if it is legal
+//  2. captures and promotions, ordered by mvv-lva
+//  3. the killer moves, if they are legal
+//  4. quiet moves, ordered by their history scores
+//
+// At the root, the moves not in the searchmoves limit and the first moves
+// of the multipv lines which have already been searched in the current
+// iteration are excluded from all the stages.
+//
+// The picker doesn't allocate, as it's move buffers are a part of it.
+type movePicker struct {
+	board     *board.Board
+	generator board.MoveGenerator
+
+	stage        pickerStage
+	tacticalOnly bool // only pick tactical moves
+
+	// move ordering information
+	ttMove  move.Move
+	killers [2]move.Move
+	killer  int // index of the next killer to try
+	history *[square.N][square.N]eval.Move
+
+	// root move restrictions
+	excluded []rootLine  // lines whose first moves are excluded
+	allowed  []move.Move // moves which can be picked, all if empty
+
+	// current stage's moves
+	generated [maxMoves]move.Move
+	moves     [maxMoves]move.Ordered[eval.Move]
+	current   int // index of the next move to pick
+	length    int // number of moves
+}
+
+// pickerStage represents a stage of the move picker.
+type pickerStage uint8
+
+// constants representing the move picker's stages
+const (
+	stageTTMove pickerStage = iota
+	stageGenerateTacticals
+	stageTacticals
+	stageKillers
+	stageGenerateQuiets
+	stageQuiets
+	stageDone
+)
+
+// init initializes the move picker for the current position of the search
+// board, at the given ply and with the given tt move. A null tt move can be
+// provided if one is not available.
+func (picker *movePicker) init(search *Context, plys int, ttMove move.Move, tacticalOnly bool) {
+	picker.board = search.board
+	picker.board.InitGenerator(&picker.generator)
+
+	picker.stage = stageTTMove
+	picker.tacticalOnly = tacticalOnly
+
+	picker.excluded, picker.allowed = nil, nil
+	if plys == 0 {
+		picker.excluded = search.lines[:search.pvIndex]
+		picker.allowed = search.rootMoves
+	}
+
+	// tt move may be from a hash collision, so check it's legality
+	picker.ttMove = move.Null
+	if picker.generator.IsLegal(ttMove) && (!tacticalOnly || !ttMove.IsQuiet()) && !picker.isExcluded(ttMove) {
+		picker.ttMove = ttMove
+	}
+
+	picker.killers = search.stack[plys].killers
+	picker.killer = 0
+	picker.history = &search.history[picker.board.SideToMove]
+}
+
+// next returns the next move in the position. If there are no more moves
+// left, the returned boolean is false.
+func (picker *movePicker) next() (move.Move, bool) {
+	switch picker.stage {
+	case stageTTMove:
+		picker.stage++
+		if picker.ttMove != move.Null {
+			return picker.ttMove, true
+		}
+
+		fallthrough
+
+	case stageGenerateTacticals:
+		picker.stage++
+		picker.generateTacticals()
+
+		fallthrough
+
+	case stageTacticals:
+		if m := picker.pick(); m != move.Null {
+			return m, true
+		}
+
+		if picker.tacticalOnly {
+			// no more moves to pick
+			picker.stage = stageDone
+			return move.Null, false
+		}
+
+		picker.stage++
+		fallthrough
+
+	case stageKillers:
+		for picker.killer < len(picker.killers) {
+			killer := picker.killers[picker.killer]
+			picker.killer++
+
+			// killers are from sibling nodes, so check their legality
+			if killer != picker.ttMove && killer.IsQuiet() && picker.generator.IsLegal(killer) && !picker.isExcluded(killer) {
+				return killer, true
+			}
+		}
+
+		picker.stage++
+		fallthrough
+
+	case stageGenerateQuiets:
+		picker.stage++
+		picker.generateQuiets()
+
+		fallthrough
+
+	case stageQuiets:
+		if m := picker.pick(); m != move.Null {
+			return m, true
+		}
+
+		picker.stage++
+		fallthrough
+
+	default:
+		return move.Null, false
+	}
+}
+
+// generateTacticals generates and scores the tactical moves.
+func (picker *movePicker) generateTacticals() {
+	moves := picker.generator.AppendTacticals(picker.generated[:0])
+
+	for i, m := range moves {
+		// a less valuable piece capturing a more valuable
+		// piece is very likely to be a good move
+		victim := picker.board.Position[m.Target()].Type()
+		attacker := m.FromPiece().Type()
+		picker.moves[i] = move.NewOrdered(m, eval.MvvLva[victim][attacker])
+	}
+
+	picker.current, picker.length = 0, len(moves)
+}
+
+// generateQuiets generates and scores the quiet moves.
+func (picker *movePicker) generateQuiets() {
+	moves := picker.generator.AppendQuiets(picker.generated[:0])
+
+	for i, m := range moves {
+		picker.moves[i] = move.NewOrdered(m, picker.history[m.Source()][m.Target()])
+	}
+
+	picker.current, picker.length = 0, len(moves)
+}
+
+// pick picks the best move from the current stage's remaining moves, while
+// skipping moves which have already been picked in the previous stages. A
+// null move is returned if there are no moves left.
+func (picker *movePicker) pick() move.Move {
+	for picker.current < picker.length {
+		// perform a single selection sort iteration
+		// the full array is not sorted as most of the moves
+		// will not be searched due to alpha-beta pruning
+		best := picker.current
+		for i := best + 1; i < picker.length; i++ {
+			if picker.moves[i].Eval() > picker.moves[best].Eval() {
+				best = i
+			}
+		}
+
+		picker.moves[picker.current], picker.moves[best] = picker.moves[best], picker.moves[picker.current]
+
+		m := picker.moves[picker.current].Move()
+		picker.current++
+
+		if m == picker.ttMove || (picker.stage == stageQuiets && picker.isKiller(m)) {
+			// already picked
+			continue
+		}
+
+		if picker.isExcluded(m) {
+			continue
+		}
+
+		return m
+	}
+
+	return move.Null
+}
+
+// isKiller reports whether the given move is one of the killer moves.
+func (picker *movePicker) isKiller(m move.Move) bool {
+	return m == picker.killers[0] || m == picker.killers[1]
+}
+
+// isExcluded reports whether the given move is excluded from the search.
+func (picker *movePicker) isExcluded(m move.Move) bool {
+	for i := range picker.excluded {
+		if picker.excluded[i].pv.Move(0) == m {
+			return true
+		}
+	}
+
+	if len(picker.allowed) == 0 {
+		return false
+	}
+
+	for _, allowed := range picker.allowed {
+		if allowed == m {
+			return false
+		}
+	}
+
+	return true
+}
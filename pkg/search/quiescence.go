@@ -25,6 +25,8 @@ import (
 // This search is needed to avoid the horizon effect.
 // https://www.chessprogramming.org/Quiescence_Search
 func (search *Context) quiescence(plys int, alpha, beta eval.Eval) eval.Eval {
+	search.count(CounterQNodes)
+
 	// quick exit clauses
 	switch {
 	case search.shouldStop():
@@ -40,9 +42,7 @@ func (search *Context) quiescence(plys int, alpha, beta eval.Eval) eval.Eval {
 	}
 
 	// check for transposition table hits
-	if entry, hit := search.tt.Probe(search.board.Hash); hit {
-		search.stats.TTHits++
-
+	if entry, hit := search.probeTT(); hit {
 		// check if the tt entry can be used to exit the search early
 		// on this node. If we have an exact value, we can safely
 		// return it. If we have a new upper bound or lower bound,
@@ -59,22 +59,22 @@ func (search *Context) quiescence(plys int, alpha, beta eval.Eval) eval.Eval {
 
 	bestScore := search.score() // standing pat
 	if bestScore >= beta {
+		search.count(CounterStandPats)
 		return bestScore // fail high
 	}
 
 	alpha = util.Max(alpha, bestScore)
 
-	// generate tactical (captures and promotions) moves only
-	moves := search.board.GenerateMoves(true)
+	// generate and order tactical (captures and promotions) moves only
+	picker := &search.stack[plys].picker
+	picker.init(search, plys, move.Null, true)
 
-	// move ordering
-	list := move.ScoreMoves(moves, eval.OfMove(eval.ModeEvalInfo{
-		Board:   &search.board.Position,
-		Killers: search.killers[plys],
-	}))
-
-	for i := 0; i < list.Length; i++ {
-		m := list.PickMove(i)
+	for {
+		m, ok := picker.next()
+		if !ok {
+			// no moves left
+			break
+		}
 
 		// node amount updates are done here to prevent duplicates
 		// when quiescence search is called from the negamax function.
@@ -83,6 +83,7 @@ func (search *Context) quiescence(plys int, alpha, beta eval.Eval) eval.Eval {
 		// quiescence search itself.
 		search.stats.Nodes++
 
+		search.tt.Prefetch(search.board.KeyAfter(m))
 		search.board.MakeMove(m)
 		score := -search.quiescence(plys+1, -beta, -alpha)
 		search.board.UnmakeMove()
@@ -104,9 +105,9 @@ func (search *Context) quiescence(plys int, alpha, beta eval.Eval) eval.Eval {
 		}
 	}
 
-	if !search.stopped {
+	if !search.stopped.Load() {
 		// update transposition table
-		search.tt.Store(tt.Entry{
+		search.storeTT(tt.Entry{
 			Hash:  search.board.Hash,
 			Value: tt.EvalFrom(bestScore, plys),
 			Depth: 0,
@@ -19,6 +19,8 @@ package search
 
 import (
 	"errors"
+	"sync"
+	"sync/atomic"
 	realtime "time"
 
 	"laptudirm.com/x/mess/pkg/board"
@@ -27,6 +29,7 @@ import (
 	"laptudirm.com/x/mess/pkg/board/square"
 	"laptudirm.com/x/mess/pkg/search/eval"
 	"laptudirm.com/x/mess/pkg/search/eval/classical"
+	"laptudirm.com/x/mess/pkg/search/syzygy"
 	"laptudirm.com/x/mess/pkg/search/tt"
 )
 
@@ -35,60 +38,124 @@ const MaxDepth = 256
 
 // NewContext creates a new search Context.
 func NewContext(reporter Reporter, ttSize int) *Context {
-	evaluator := &classical.EfficientlyUpdatable{}
-	chessboard := board.New(board.EU(evaluator))
-	evaluator.Board = chessboard
+	chessboard, evaluator := newBoard(classical.New)
 	chessboard.UpdateWithFEN(board.StartFEN)
 
+	stopped := &atomic.Bool{}
+	stopped.Store(true)
+
 	return &Context{
 		// default position
 		board: chessboard,
 
-		evaluator: evaluator,
+		evaluator:    evaluator,
+		newEvaluator: classical.New,
 
 		tt:      tt.NewTable(ttSize),
-		stopped: true,
+		tbLimit: syzygy.MaxPieces,
+		stopped: stopped,
+		signal:  make(chan struct{}, 1),
 
 		reporter: reporter,
 	}
 }
 
+// newBoard creates a new board along with an evaluator, created with the
+// given function, which is efficiently updated by that board.
+func newBoard(newEvaluator eval.NewFunc) (*board.Board, eval.EfficientlyUpdatable) {
+	chessboard := board.New()
+	evaluator := newEvaluator(chessboard)
+	chessboard.SetEfficientlyUpdatable(evaluator)
+	return chessboard, evaluator
+}
+
 // Context stores various options, state, and debug variables regarding a
 // particular search. During multiple searches on the same position, the
-// internal board (*Context).Board should be switched out, while a brand
-// new Context should be used for different games.
+// internal board (*Context).Board should be switched out, while NewGame
+// should be called before using the Context for a different game.
 type Context struct {
 	// search state
 	board      *board.Board
 	sideToMove piece.Color
 	tt         *tt.Table
-	stopped    bool
+	stopped    *atomic.Bool
 
-	evaluator eval.EfficientlyUpdatable
+	// signal wakes up the main thread while it waits for a stop or a
+	// limits update in infinite mode; it is nil for the helper threads
+	signal chan struct{}
+
+	// lazy smp state
+	thread  int        // index of the thread, 0 for the main thread
+	helpers []*Context // helper threads, only used by the main thread
+	running sync.WaitGroup
+	nodes   atomic.Int64 // node count last published by the thread
+
+	evaluator    eval.EfficientlyUpdatable
+	newEvaluator eval.NewFunc // creates the evaluators of the threads
+	evals        evalTable    // cache of the evaluator's results
 
 	// principal variation
 	pv      move.Variation
 	pvScore eval.Eval
 
-	// stats
+	// multipv state, the helper threads only search a single line
+	multiPV int        // number of lines to search, set by the user
+	lines   []rootLine // lines of the current iteration
+	pvIndex int        // index of the line being searched
+
+	// thread local stats
 	stats    Stats
 	reporter Reporter
 
+	// rate-limited progress reports, only used by the main thread
+	progress         ProgressReporter
+	progressInterval realtime.Duration
+	lastProgress     realtime.Time
+	rootMoveNumber   int // number of the root move being searched
+
 	// search limits
-	time   TimeManager
-	limits Limits
+	time      TimeManager
+	limits    Limits
+	rootMoves []move.Move // root moves to search, all of them if empty
+	rootPlys  int         // plys played before the root position
+
+	// limits from UpdateLimits, not yet installed by the main thread
+	update atomic.Pointer[limitsUpdate]
+
+	// endgame tablebase, shared by all the threads and nil if disabled
+	tb      *syzygy.Tablebase
+	tbLimit int          // maximum number of pieces of the probed positions
+	tbProbe bool         // whether positions are probed during the search
+	tbHits  atomic.Int64 // tablebase hits last published by the thread
+
+	// search stack, indexed by ply
+	stack [stackSize]frame
 
 	// move ordering stuff
 	history [piece.ColorN][square.N][square.N]eval.Move
-	killers [MaxDepth][2]move.Move
 }
 
 // Search initializes the context for a new search and calls the main
 // iterative deepening function. It checks if the position is illegal
 // and cleans up the context after the search finishes.
 func (search *Context) Search(limits Limits) (move.Variation, eval.Eval, error) {
+	search.start(limits)
+	return search.run()
+}
 
+// SearchAsync starts a search with the given limits in a new goroutine,
+// and calls done with it's results once it finishes. The search is in
+// progress when SearchAsync returns, so it can be immediately stopped or
+// have it's limits updated.
+func (search *Context) SearchAsync(limits Limits, done func(move.Variation, eval.Eval, error)) {
 	search.start(limits)
+	go func() {
+		done(search.run())
+	}()
+}
+
+// run runs a search which has been started with start.
+func (search *Context) run() (move.Variation, eval.Eval, error) {
 	defer search.Stop()
 
 	// illegal position check; king can be captured
@@ -96,24 +163,92 @@ func (search *Context) Search(limits Limits) (move.Variation, eval.Eval, error)
 		return move.Variation{}, eval.Inf, errors.New("search move: position is illegal")
 	}
 
+	// start the helper threads alongside the main search
+	search.startHelpers()
 	pv, eval := search.iterativeDeepening()
+
+	// stop the helper threads and wait for them to exit
+	search.Stop()
+	search.running.Wait()
+
 	return pv, eval, nil
 }
 
+// NewGame resets the context so that it can be used for searching the
+// positions of a new game. The transposition table is cleared and the
+// move ordering state of every thread reset, but no memory reallocated.
+func (search *Context) NewGame() {
+	search.UpdatePosition(board.StartFEN)
+	search.tt.Clear()
+
+	search.reset()
+	for _, helper := range search.helpers {
+		helper.reset()
+	}
+}
+
+// SetEvaluator changes the evaluation function used by the search. The
+// given function is used to create a new evaluator for each thread. It
+// should not be called while a search is in progress.
+func (search *Context) SetEvaluator(newEvaluator eval.NewFunc) {
+	search.newEvaluator = newEvaluator
+	search.setEvaluator(newEvaluator)
+
+	for _, helper := range search.helpers {
+		helper.setEvaluator(newEvaluator)
+	}
+}
+
+// setEvaluator changes the evaluator of the given thread's context.
+func (search *Context) setEvaluator(newEvaluator eval.NewFunc) {
+	search.evaluator = newEvaluator(search.board)
+	search.board.SetEfficientlyUpdatable(search.evaluator)
+
+	// the cached evaluations are from the old evaluator
+	search.evals = evalTable{}
+}
+
+// reset resets the game specific state of the given thread's context.
+func (search *Context) reset() {
+	search.pvScore = 0
+	search.history = [piece.ColorN][square.N][square.N]eval.Move{}
+	for i := range search.stack {
+		search.stack[i].killers = [2]move.Move{}
+	}
+}
+
 // InProgress reports whether a search is in progress on the given context.
 func (search *Context) InProgress() bool {
-	return !search.stopped
+	return !search.stopped.Load()
 }
 
 // ResizeTT resizes the search's transposition table.
-func (search *Context) ResizeTT(mbs int) {
-	search.tt.Resize(mbs)
+func (search *Context) ResizeTT(mbs int) error {
+	return search.tt.Resize(mbs)
+}
+
+// SetTTAllocation changes the memory allocation method used by the
+// search's transposition table.
+func (search *Context) SetTTAllocation(allocation tt.Allocation) error {
+	return search.tt.SetAllocation(allocation)
 }
 
 // Stop stops any ongoing search on the given context. The main search
-// function will immediately return after this function is called.
+// function will immediately return after this function is called. The
+// stop signal is shared, so every helper thread is stopped with it.
 func (search *Context) Stop() {
-	search.stopped = true
+	search.stopped.Store(true)
+	search.notify()
+}
+
+// notify wakes up the main thread if it is waiting for the search to be
+// stopped or for it's limits to be updated. It never blocks, and only a
+// single pending signal is kept as the waiter checks the state itself.
+func (search *Context) notify() {
+	select {
+	case search.signal <- struct{}{}:
+	default:
+	}
 }
 
 // start initializes search variables during the start of a search.
@@ -123,15 +258,38 @@ func (search *Context) start(limits Limits) {
 
 	// reset stats
 	search.stats = Stats{}
+	search.nodes.Store(0)
+	search.tbHits.Store(0)
 	search.sideToMove = search.board.SideToMove
+	search.rootPlys = search.board.Plys
 
 	// age the transposition table
 	search.tt.NextEpoch()
 
-	// start search
+	// start search, the limits are installed directly since the
+	// search hasn't started yet
 	search.UpdateLimits(limits)
-	search.stopped = false // search not stopped
+	search.installLimits()
+
+	// only search the root moves which preserve the tablebase result,
+	// unless the root moves have been restricted by the user
+	search.rootMoves, search.tbProbe = search.limits.Moves, true
+	if len(search.rootMoves) == 0 {
+		search.rootMoves, search.tbProbe = search.rootTBMoves()
+	}
+
+	search.initLines(search.multiPVLines())
+
+	// discard any stale signal from the previous search
+	select {
+	case <-search.signal:
+	default:
+	}
+
+	search.stopped.Store(false) // search not stopped
 
 	// start search timer
 	search.stats.SearchStart = realtime.Now()
+	search.lastProgress = search.stats.SearchStart
+	search.rootMoveNumber = 0
 }
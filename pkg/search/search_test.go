@@ -0,0 +1,219 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search_test
+
+import (
+	"math"
+	"testing"
+	"time"
+
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// a few middlegame and endgame positions from the bench command
+var benchFens = []string{
+	"r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
+	"4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
+	"6k1/1R3p2/6p1/2Bp3p/3P2q1/P7/1P2rQ1K/5R2 b - - 4 44",
+	"8/8/1p2k1p1/3p3p/1p1P1P1P/1P2PK2/8/8 w - - 3 54",
+}
+
+// depthLimits returns limits which search to the given depth.
+func depthLimits(depth int) search.Limits {
+	return search.Limits{Depth: depth, Nodes: math.MaxInt, MoveTime: math.MaxInt32}
+}
+
+// isLegal reports whether the given move is legal in the context's position.
+func isLegal(context *search.Context, m move.Move) bool {
+	for _, legal := range context.Board().GenerateMoves(false) {
+		if legal == m {
+			return true
+		}
+	}
+
+	return false
+}
+
+func TestThreads(t *testing.T) {
+	context := search.NewContext(func(search.Report) {}, 16)
+	context.SetThreads(4)
+
+	for _, fenString := range benchFens {
+		context.NewGame()
+		context.UpdatePosition(fen.FromString(fenString))
+
+		pv, _, err := context.Search(depthLimits(7))
+		if err != nil {
+			t.Fatalf("%s: %v", fenString, err)
+		}
+
+		if bestMove := pv.Move(0); !isLegal(context, bestMove) {
+			t.Errorf("%s: illegal best move %s", fenString, bestMove)
+		}
+	}
+}
+
+func TestMultiPV(t *testing.T) {
+	const lines = 3
+	const depth = 7
+
+	// first moves and scores of the lines of the last iteration
+	var moves [lines]move.Move
+	var scores [lines]eval.Eval
+	var reported [lines]bool
+
+	context := search.NewContext(func(report search.Report) {
+		if report.Depth == depth && report.MultiPV >= 1 && report.MultiPV <= lines {
+			moves[report.MultiPV-1] = report.PV.Move(0)
+			scores[report.MultiPV-1] = report.Score
+			reported[report.MultiPV-1] = true
+		}
+	}, 16)
+	context.SetMultiPV(lines)
+
+	for _, fenString := range benchFens {
+		context.NewGame()
+		context.UpdatePosition(fen.FromString(fenString))
+		reported = [lines]bool{}
+
+		pv, _, err := context.Search(depthLimits(depth))
+		if err != nil {
+			t.Fatalf("%s: %v", fenString, err)
+		}
+
+		for i := 0; i < lines; i++ {
+			if !reported[i] {
+				t.Fatalf("%s: line %d not reported", fenString, i+1)
+			}
+
+			if !isLegal(context, moves[i]) {
+				t.Errorf("%s: line %d starts with illegal move %s", fenString, i+1, moves[i])
+			}
+
+			for j := 0; j < i; j++ {
+				if moves[j] == moves[i] {
+					t.Errorf("%s: lines %d and %d both start with %s", fenString, j+1, i+1, moves[i])
+				}
+			}
+
+			if i > 0 && scores[i] > scores[i-1] {
+				t.Errorf("%s: line %d score %d above line %d score %d", fenString, i+1, scores[i], i, scores[i-1])
+			}
+		}
+
+		if pv.Move(0) != moves[0] {
+			t.Errorf("%s: best move %s, first line starts with %s", fenString, pv.Move(0), moves[0])
+		}
+	}
+}
+
+// searchAsync starts an asynchronous search with the given limits, and
+// returns a channel which receives it's best move once it finishes.
+func searchAsync(context *search.Context, limits search.Limits) <-chan move.Move {
+	done := make(chan move.Move, 1)
+	context.SearchAsync(limits, func(pv move.Variation, _ eval.Eval, err error) {
+		if err != nil {
+			done <- move.Null
+			return
+		}
+
+		done <- pv.Move(0)
+	})
+
+	return done
+}
+
+// expectRunning fails the test if the search finishes within a while.
+func expectRunning(t *testing.T, done <-chan move.Move) {
+	select {
+	case bestMove := <-done:
+		t.Fatalf("search finished with %s while it should be waiting", bestMove)
+	case <-time.After(200 * time.Millisecond):
+	}
+}
+
+// expectDone fails the test unless the search finishes with a legal move.
+func expectDone(t *testing.T, context *search.Context, done <-chan move.Move) {
+	select {
+	case bestMove := <-done:
+		if !isLegal(context, bestMove) {
+			t.Fatalf("search finished with illegal best move %s", bestMove)
+		}
+	case <-time.After(10 * time.Second):
+		t.Fatal("search didn't finish")
+	}
+}
+
+func TestPonderHit(t *testing.T) {
+	context := search.NewContext(func(search.Report) {}, 16)
+	context.SetThreads(2)
+
+	for _, ponderDepth := range []int{search.MaxDepth, 4} {
+		context.NewGame()
+		context.UpdatePosition(fen.FromString(benchFens[0]))
+
+		// the limits of go ponder wtime 1000 btime 1000, which are kept
+		// for the ponderhit while pondering is an infinite search
+		limits := search.Limits{
+			Depth: ponderDepth,
+			Nodes: math.MaxInt,
+			Time:  [piece.ColorN]int{1000, 1000},
+		}
+
+		ponder := limits
+		ponder.Infinite = true
+
+		done := searchAsync(context, ponder)
+
+		// pondering waits for the ponderhit, even at the depth limit
+		expectRunning(t, done)
+
+		// ponderhit, sent from a different goroutine than the search's
+		context.UpdateLimits(limits)
+		expectDone(t, context, done)
+	}
+}
+
+func TestInfiniteDepth(t *testing.T) {
+	context := search.NewContext(func(search.Report) {}, 16)
+	context.UpdatePosition(fen.FromString(benchFens[1]))
+
+	// go infinite depth 3 should only finish after a stop
+	done := searchAsync(context, search.Limits{Depth: 3, Nodes: math.MaxInt, Infinite: true})
+	expectRunning(t, done)
+
+	context.Stop()
+	expectDone(t, context, done)
+}
+
+func BenchmarkSearch(b *testing.B) {
+	context := search.NewContext(func(search.Report) {}, 16)
+	limits := depthLimits(8)
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, fenString := range benchFens {
+			context.NewGame()
+			context.UpdatePosition(fen.FromString(fenString))
+			if _, _, err := context.Search(limits); err != nil {
+				b.Fatal(err)
+			}
+		}
+	}
+}
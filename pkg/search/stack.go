@@ -0,0 +1,43 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// frame represents the search state of a single ply, which is stored in
+// the search stack so that it isn't allocated again at every node.
+type frame struct {
+	// principal variation of the node
+	pv move.Variation
+
+	// position evaluation of the node
+	eval eval.Eval
+
+	// move currently being searched, move.Null
+	// if a null move is being searched
+	move move.Move
+
+	// move ordering stuff
+	killers [2]move.Move
+
+	// move picker, along with it's move buffers
+	picker movePicker
+}
+
+// stackSize is the size of the search stack. One frame more than MaxDepth
+// is needed since a node's child pv is stored in the next ply's frame.
+const stackSize = MaxDepth + 1
@@ -19,6 +19,7 @@ import (
 
 	"laptudirm.com/x/mess/internal/util"
 	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/square"
 	"laptudirm.com/x/mess/pkg/search/eval"
 )
 
@@ -27,11 +28,29 @@ type Stats struct {
 	// time when search started
 	SearchStart time.Time
 
-	TTHits int // transposition table hits
-	Nodes  int // positions (nodes) searched
+	Nodes int // positions (nodes) searched
+
+	// transposition table stats
+	TTProbes   int // tt probes
+	TTHits     int // tt probes which found the position
+	TTStores   int // entries written into the tt
+	TTReplaces int // stores which replaced a different position
+
+	// eval cache stats
+	EvalProbes int // static evaluations requested
+	EvalHits   int // evaluations found in the eval cache
+
+	TBHits int // positions found in the endgame tablebase
 
 	Depth    int // current iterative depth
 	SelDepth int // maximum depth reached
+
+	// nodes searched under each root move, indexed by it's source and
+	// target squares, over all the iterations of the search
+	RootNodes [square.N][square.N]int
+
+	// detailed counters, only collected with the stats build tag
+	Counters Counters
 }
 
 // GenerateReport generates a statistics report from the current search
@@ -39,15 +58,26 @@ type Stats struct {
 // know about a search.
 func (search *Context) GenerateReport() Report {
 	searchTime := time.Since(search.stats.SearchStart)
+	nodes := search.totalNodes()
 
 	return Report{
 		Depth:    search.stats.Depth,
 		SelDepth: search.stats.SelDepth,
 
-		Nodes: search.stats.Nodes,
-		Nps:   float64(search.stats.Nodes) / util.Max(0.001, searchTime.Seconds()),
+		Nodes: nodes,
+		Nps:   float64(nodes) / util.Max(0.001, searchTime.Seconds()),
+
+		Hashfull: search.tt.Hashfull(),
 
-		Hashfull: 0, // TODO: implement hashfull calculation
+		TTProbes:   search.stats.TTProbes,
+		TTHits:     search.stats.TTHits,
+		TTStores:   search.stats.TTStores,
+		TTReplaces: search.stats.TTReplaces,
+
+		EvalProbes: search.stats.EvalProbes,
+		EvalHits:   search.stats.EvalHits,
+
+		TBHits: search.totalTBHits(),
 
 		Time: searchTime,
 
@@ -56,6 +86,23 @@ func (search *Context) GenerateReport() Report {
 	}
 }
 
+// report reports the lines found in the last completed iteration. In
+// multipv mode, a separate report is generated for each of the lines.
+func (search *Context) report() {
+	if len(search.lines) == 1 {
+		search.reporter(search.GenerateReport())
+		return
+	}
+
+	report := search.GenerateReport()
+	for i, line := range search.lines {
+		report.MultiPV = i + 1
+		report.Score = line.score
+		report.PV = line.pv
+		search.reporter(report)
+	}
+}
+
 // Reporter takes a report as input and processes it in some way.
 type Reporter func(Report)
 
@@ -69,23 +116,115 @@ type Report struct {
 	Nodes int
 	Nps   float64
 
-	// tt stats
-	Hashfull float64
+	// tt stats, the counters are of the main thread
+	Hashfull   float64
+	TTProbes   int
+	TTHits     int
+	TTStores   int
+	TTReplaces int
+
+	// eval cache stats, of the main thread
+	EvalProbes int
+	EvalHits   int
+
+	// tablebase hits of all the threads
+	TBHits int
 
 	// search time stats
 	Time time.Duration
 
 	// principal variation stats
-	Score eval.Eval
-	PV    move.Variation
+	MultiPV int // index of the line, starting at 1; 0 outside multipv
+	Score   eval.Eval
+	PV      move.Variation
 }
 
 // String converts a Report into an UCI compatible info string.
 func (report Report) String() string {
+	multiPV := ""
+	if report.MultiPV > 0 {
+		multiPV = fmt.Sprintf(" multipv %d", report.MultiPV)
+	}
+
 	return fmt.Sprintf(
-		"info depth %d seldepth %d score %s nodes %d nps %.f hashfull %.f tbhits 0 time %d pv %s",
-		report.Depth, report.SelDepth, report.Score, report.Nodes, report.Nps,
+		"info depth %d seldepth %d%s score %s nodes %d nps %.f hashfull %.f tbhits %d time %d pv %s",
+		report.Depth, report.SelDepth, multiPV, report.Score, report.Nodes, report.Nps,
 		report.Hashfull*1000, // convert fraction to per-mille
-		report.Time.Milliseconds(), report.PV,
+		report.TBHits, report.Time.Milliseconds(), report.PV,
+	)
+}
+
+// SetProgressReporter sets the reporter of the search's progress reports,
+// which are sent by the main thread while it is searching an iteration,
+// at most once every interval. A zero interval disables the reports. It
+// should not be called while a search is in progress.
+func (search *Context) SetProgressReporter(reporter ProgressReporter, interval time.Duration) {
+	search.progress = reporter
+	search.progressInterval = interval
+}
+
+// reportProgress sends a progress report if the progress reports are
+// enabled and the report interval has passed since the last one.
+func (search *Context) reportProgress() {
+	if search.progressInterval == 0 || search.progress == nil {
+		return
+	}
+
+	now := time.Now()
+	if now.Sub(search.lastProgress) < search.progressInterval {
+		return
+	}
+
+	search.lastProgress = now
+
+	searchTime := now.Sub(search.stats.SearchStart)
+	nodes := search.totalNodes()
+
+	search.progress(Progress{
+		Depth: search.stats.Depth,
+
+		CurrMove:       search.stack[0].move,
+		CurrMoveNumber: search.rootMoveNumber,
+
+		Nodes: nodes,
+		Nps:   float64(nodes) / util.Max(0.001, searchTime.Seconds()),
+
+		Hashfull: search.tt.Hashfull(),
+		Time:     searchTime,
+	})
+}
+
+// ProgressReporter takes a progress report as input and processes it.
+type ProgressReporter func(Progress)
+
+// Progress represents a report of the progress of an ongoing iteration.
+type Progress struct {
+	Depth int // current id depth
+
+	// move being searched at the root, and it's number, which
+	// is zero if the search hasn't reached the root moves yet
+	CurrMove       move.Move
+	CurrMoveNumber int
+
+	// node stats
+	Nodes int
+	Nps   float64
+
+	Hashfull float64
+	Time     time.Duration
+}
+
+// String converts a Progress into an UCI compatible info string.
+func (progress Progress) String() string {
+	currMove := ""
+	if progress.CurrMoveNumber != 0 {
+		currMove = fmt.Sprintf(" currmove %s currmovenumber %d", progress.CurrMove, progress.CurrMoveNumber)
+	}
+
+	return fmt.Sprintf(
+		"info depth %d%s nodes %d nps %.f hashfull %.f time %d",
+		progress.Depth, currMove, progress.Nodes, progress.Nps,
+		progress.Hashfull*1000, // convert fraction to per-mille
+		progress.Time.Milliseconds(),
 	)
 }
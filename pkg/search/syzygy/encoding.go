@@ -0,0 +1,194 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import "laptudirm.com/x/mess/internal/util"
+
+// The tables index their positions using squares numbered from a1 = 0 to
+// h8 = 63, which is the rank flipped version of this engine's squares. All
+// the squares in this package are table squares, unless stated otherwise.
+
+// fileOf returns the file of the given table square, 0 for the a file.
+func fileOf(s int) int {
+	return s & 7
+}
+
+// rankOf returns the rank of the given table square, 0 for the 1st rank.
+func rankOf(s int) int {
+	return s >> 3
+}
+
+// flipFile mirrors the given table square horizontally.
+func flipFile(s int) int {
+	return s ^ 7
+}
+
+// flipRank mirrors the given table square vertically.
+func flipRank(s int) int {
+	return s ^ 56
+}
+
+// offA1H8 returns the signed distance of the given table square from the
+// a1-h8 diagonal, which is positive above the diagonal and negative below.
+func offA1H8(s int) int {
+	return rankOf(s) - fileOf(s)
+}
+
+// sortSquares sorts the given squares by the given key, keeping the order
+// of the squares with equal keys. The lists of squares are short enough
+// for an insertion sort.
+func sortSquares(squares []int, key func(int) int) {
+	for i := 1; i < len(squares); i++ {
+		for j := i; j > 0 && key(squares[j]) < key(squares[j-1]); j-- {
+			squares[j], squares[j-1] = squares[j-1], squares[j]
+		}
+	}
+}
+
+// maxLeadPawns is the maximum number of leading pawns in a table.
+const maxLeadPawns = 5
+
+var (
+	// mapPawns maps the squares a2-h7 to 0..47, which is the number of
+	// squares available to the other leading pawns if the square has the
+	// leading pawn. The leading pawn is the one with the largest value,
+	// which is the one nearest to the edge and, on the same file, the one
+	// with the lowest rank.
+	mapPawns [64]int
+
+	// mapB1H1H7 maps the squares below the a1-h8 diagonal to 0..27.
+	mapB1H1H7 [64]int
+
+	// mapA1D1D4 maps the squares of the a1-d1-d4 triangle to 0..9, with
+	// the squares on the diagonal being mapped last.
+	mapA1D1D4 [64]int
+
+	// mapKK maps the 462 legal placements of two kings, with the first
+	// king in the a1-d1-d4 triangle, to 0..461. If the first king is on
+	// the diagonal, the second king is below or on the diagonal.
+	mapKK [10][64]int
+
+	// binomial[k][n] is the number of ways to choose k out of n squares.
+	binomial [maxLeadPawns + 1][64]uint64
+
+	// leadPawnIdx is the first index of the leading pawn group of the
+	// given size, with the leading pawn on the given square.
+	leadPawnIdx [maxLeadPawns + 1][64]uint64
+
+	// leadPawnsSize is the number of placements of the leading pawn group
+	// of the given size, with the leading pawn on the given file.
+	leadPawnsSize [maxLeadPawns + 1][4]uint64
+)
+
+func init() {
+	code := 0
+	for s := 0; s < 64; s++ {
+		if offA1H8(s) < 0 {
+			mapB1H1H7[s] = code
+			code++
+		}
+	}
+
+	// a1-d1-d4 triangle, with the diagonal squares encoded last
+	var diagonal []int
+	code = 0
+	for s := 0; s <= 27; s++ { // a1 to d4
+		switch {
+		case fileOf(s) > 3:
+			continue
+		case offA1H8(s) < 0:
+			mapA1D1D4[s] = code
+			code++
+		case offA1H8(s) == 0:
+			diagonal = append(diagonal, s)
+		}
+	}
+
+	for _, s := range diagonal {
+		mapA1D1D4[s] = code
+		code++
+	}
+
+	// king placements, with both kings on the diagonal encoded last
+	type placement struct{ first, second int }
+	var bothOnDiagonal []placement
+	code = 0
+	for index := 0; index < 10; index++ {
+		for s1 := 0; s1 <= 27; s1++ {
+			// b1 is the only square of the triangle mapped to 0
+			if fileOf(s1) > 3 || offA1H8(s1) > 0 || mapA1D1D4[s1] != index || (index == 0 && s1 != 1) {
+				continue
+			}
+
+			for s2 := 0; s2 < 64; s2++ {
+				switch {
+				case util.Abs(fileOf(s1)-fileOf(s2)) <= 1 && util.Abs(rankOf(s1)-rankOf(s2)) <= 1:
+					// kings on adjacent or the same squares
+				case offA1H8(s1) == 0 && offA1H8(s2) > 0:
+					// first king on the diagonal, second above it
+				case offA1H8(s1) == 0 && offA1H8(s2) == 0:
+					bothOnDiagonal = append(bothOnDiagonal, placement{index, s2})
+				default:
+					mapKK[index][s2] = code
+					code++
+				}
+			}
+		}
+	}
+
+	for _, p := range bothOnDiagonal {
+		mapKK[p.first][p.second] = code
+		code++
+	}
+
+	// binomial coefficients using pascal's rule
+	binomial[0][0] = 1
+	for n := 1; n < 64; n++ {
+		for k := 0; k <= maxLeadPawns && k <= n; k++ {
+			if k > 0 {
+				binomial[k][n] += binomial[k-1][n-1]
+			}
+
+			if k < n {
+				binomial[k][n] += binomial[k][n-1]
+			}
+		}
+	}
+
+	// leading pawn group encoding, which restarts at every file as the
+	// tables with pawns are split by the file of the leading pawn
+	available := 47
+	for leadPawns := 1; leadPawns <= maxLeadPawns; leadPawns++ {
+		for f := 0; f < 4; f++ {
+			var index uint64
+			for r := 1; r <= 6; r++ {
+				s := r*8 + f
+
+				// the squares below or nearer to the edge than the
+				// leading pawn are not available to the other pawns
+				if leadPawns == 1 {
+					mapPawns[s] = available
+					available--
+					mapPawns[flipFile(s)] = available
+					available--
+				}
+
+				leadPawnIdx[leadPawns][s] = index
+				index += binomial[leadPawns-1][mapPawns[s]]
+			}
+
+			leadPawnsSize[leadPawns][f] = index
+		}
+	}
+}
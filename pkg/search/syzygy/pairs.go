@@ -0,0 +1,353 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import (
+	"encoding/binary"
+
+	"laptudirm.com/x/mess/pkg/board/piece"
+)
+
+// flags of the pairs data of a table
+const (
+	flagSTM         = 1   // side to move stored by a dtz table
+	flagMapped      = 2   // dtz values are mapped through the dtz map
+	flagWinPlies    = 4   // dtz values of wins are in plys
+	flagLossPlies   = 8   // dtz values of losses are in plys
+	flagWide        = 16  // dtz map entries are 16 bits wide
+	flagSingleValue = 128 // every position has the same value
+)
+
+// noSymbol is the right child of a symbol which isn't a pair.
+const noSymbol = 0xfff
+
+// pairsData contains the information needed to decode the values of one
+// part of a table, which stores the positions with a given side to move
+// and, in tables with pawns, a given file of the leading pawn.
+//
+// The values are compressed with recursive pairing, which replaces the most
+// frequent pair of adjacent symbols with a new symbol until the alphabet
+// is large enough, and the resulting symbols are huffman coded in blocks.
+type pairsData struct {
+	flags uint8
+
+	blockSize uint64 // size of a block of compressed data in bytes
+	span      uint64 // number of values between sparse index entries
+	numBlocks int    // number of blocks of compressed data
+
+	sparseIndexSize int // number of sparse index entries
+	blockLengthSize int // number of block lengths, including padding
+
+	maxSymLen int // maximum length of a huffman code in bits
+	minSymLen int // minimum length of a huffman code, or the single value
+
+	// lowestSym[l] is the symbol of the lowest huffman code of length l,
+	// relative to the minimum length, stored as little endian uint16s
+	lowestSym []byte
+
+	// base64[l] is the lowest huffman code of length l, relative to the
+	// minimum length, left aligned to 64 bits
+	base64 []uint64
+
+	// btree stores the two symbols which make up every pair symbol, as a
+	// 12 bit left and a 12 bit right symbol packed into 3 bytes
+	btree []byte
+
+	// symLen is the number of values represented by a symbol, minus one
+	symLen []uint8
+
+	// blockLength stores the number of values in each block, minus one,
+	// as little endian uint16s
+	blockLength []byte
+
+	// sparseIndex stores the block and the offset in that block of every
+	// span'th value, as a little endian uint32 and uint16 per entry
+	sparseIndex []byte
+
+	// compressed data of the blocks
+	data []byte
+
+	// pieces of the table in the order in which they are encoded, and the
+	// groups of pieces which are encoded together
+	pieces   [MaxPieces]piece.Piece
+	groupIdx [MaxPieces + 1]uint64 // multiplier of each group's index
+	groupLen [MaxPieces + 1]int    // pieces in each group, zero terminated
+
+	// offsets of the dtz maps of each wdl value in the table file
+	mapIdx [4]int
+}
+
+// size returns the number of values, indexed positions, in the data.
+func (d *pairsData) size() uint64 {
+	n := 0
+	for d.groupLen[n] != 0 {
+		n++
+	}
+
+	return d.groupIdx[n]
+}
+
+// setGroups calculates the groups of the pieces of the given table, and
+// the multiplier of the index of each group. The order contains the place
+// of the leading group and of the other side's pawns in the encoding. It
+// is calculated for the given file of the leading pawn.
+func (d *pairsData) setGroups(t *table, order [2]int, f int) {
+	// pieces which are always in the first group
+	firstLen := 2
+	switch {
+	case t.hasPawns:
+		firstLen = 0
+	case t.hasUniquePieces:
+		firstLen = 3
+	}
+
+	n := 0
+	d.groupLen[n] = 1
+	for i := 1; i < t.pieces; i++ {
+		firstLen--
+		if firstLen > 0 || d.pieces[i] == d.pieces[i-1] {
+			d.groupLen[n]++
+		} else {
+			n++
+			d.groupLen[n] = 1
+		}
+	}
+
+	n++
+	d.groupLen[n] = 0
+
+	// pawns on both sides
+	pp := t.hasPawns && t.pawnCount[1] > 0
+
+	next := 1
+	freeSquares := 64 - d.groupLen[0]
+	if pp {
+		next = 2
+		freeSquares -= d.groupLen[1]
+	}
+
+	idx := uint64(1)
+	for k := 0; next < n || k == order[0] || k == order[1]; k++ {
+		switch k {
+		case order[0]:
+			// leading pawns or pieces
+			d.groupIdx[0] = idx
+			switch {
+			case t.hasPawns:
+				idx *= leadPawnsSize[d.groupLen[0]][f]
+			case t.hasUniquePieces:
+				idx *= 31332
+			default:
+				idx *= 462
+			}
+
+		case order[1]:
+			// other side's pawns
+			d.groupIdx[1] = idx
+			idx *= binomial[d.groupLen[1]][48-d.groupLen[0]]
+
+		default:
+			// other pieces
+			d.groupIdx[next] = idx
+			idx *= binomial[d.groupLen[next]][freeSquares]
+			freeSquares -= d.groupLen[next]
+			next++
+		}
+	}
+
+	d.groupIdx[n] = idx
+}
+
+// setSizes reads the huffman code and block information of the data from
+// the given offset of the table file, and returns the offset after it.
+func (d *pairsData) setSizes(data []byte, offset int) int {
+	d.flags = data[offset]
+	offset++
+
+	if d.flags&flagSingleValue != 0 {
+		d.minSymLen = int(data[offset]) // the single value
+		return offset + 1
+	}
+
+	d.blockSize = 1 << data[offset]
+	d.span = 1 << data[offset+1]
+	padding := int(data[offset+2])
+	d.numBlocks = int(binary.LittleEndian.Uint32(data[offset+3:]))
+	d.maxSymLen = int(data[offset+7])
+	d.minSymLen = int(data[offset+8])
+	offset += 9
+
+	// the block lengths are padded so that the sparse index, which
+	// has an entry for every span values, can't point out of range
+	d.sparseIndexSize = int((d.size() + d.span - 1) / d.span)
+	d.blockLengthSize = d.numBlocks + padding
+
+	lengths := d.maxSymLen - d.minSymLen + 1
+	d.lowestSym = data[offset : offset+2*lengths]
+	offset += 2 * lengths
+
+	// the codes of each length are consecutive integers, and the lowest
+	// code of a length is calculated from the lowest code of the next
+	// length, and the number of codes of the next length
+	d.base64 = make([]uint64, lengths)
+	for i := lengths - 2; i >= 0; i-- {
+		d.base64[i] = (d.base64[i+1] + uint64(d.lowest(i)) - uint64(d.lowest(i+1))) / 2
+	}
+
+	for i := range d.base64 {
+		d.base64[i] <<= 64 - i - d.minSymLen
+	}
+
+	symbols := int(binary.LittleEndian.Uint16(data[offset:]))
+	offset += 2
+
+	d.btree = data[offset : offset+3*symbols]
+	offset += 3*symbols + symbols&1
+
+	d.symLen = make([]uint8, symbols)
+	visited := make([]bool, symbols)
+	for sym := range d.symLen {
+		if !visited[sym] {
+			d.symLen[sym] = d.setSymLen(sym, visited)
+		}
+	}
+
+	return offset
+}
+
+// setSymLen calculates the number of values, minus one, represented by the
+// given symbol, and the symbols which make it up if it is a pair.
+func (d *pairsData) setSymLen(sym int, visited []bool) uint8 {
+	visited[sym] = true
+
+	right := d.right(sym)
+	if right == noSymbol {
+		return 0
+	}
+
+	left := d.left(sym)
+	if !visited[left] {
+		d.symLen[left] = d.setSymLen(left, visited)
+	}
+
+	if !visited[right] {
+		d.symLen[right] = d.setSymLen(right, visited)
+	}
+
+	return d.symLen[left] + d.symLen[right] + 1
+}
+
+// lowest returns the symbol of the lowest code of the given length,
+// relative to the minimum length.
+func (d *pairsData) lowest(length int) int {
+	return int(binary.LittleEndian.Uint16(d.lowestSym[2*length:]))
+}
+
+// left returns the left symbol of the given pair, or the value of a symbol
+// which isn't a pair.
+func (d *pairsData) left(sym int) int {
+	lr := d.btree[3*sym:]
+	return int(lr[1]&0xf)<<8 | int(lr[0])
+}
+
+// right returns the right symbol of the given pair, or noSymbol.
+func (d *pairsData) right(sym int) int {
+	lr := d.btree[3*sym:]
+	return int(lr[2])<<4 | int(lr[1]>>4)
+}
+
+// blockLen returns the number of values in the given block, minus one.
+func (d *pairsData) blockLen(block int) int {
+	return int(binary.LittleEndian.Uint16(d.blockLength[2*block:]))
+}
+
+// decompress returns the value with the given index.
+func (d *pairsData) decompress(idx uint64) int {
+	if d.flags&flagSingleValue != 0 {
+		return d.minSymLen
+	}
+
+	// Every span'th value, at the index k*span + span/2 for the k'th
+	// entry, has an entry in the sparse index, which stores it's block
+	// and it's offset in the block. The block and the offset of the
+	// given index are found by walking the block lengths from there.
+	k := idx / d.span
+	entry := d.sparseIndex[6*k:]
+	block := int(binary.LittleEndian.Uint32(entry))
+	offset := int(binary.LittleEndian.Uint16(entry[4:]))
+
+	offset += int(idx%d.span) - int(d.span/2)
+
+	for offset < 0 {
+		block--
+		offset += d.blockLen(block) + 1
+	}
+
+	for offset > d.blockLen(block) {
+		offset -= d.blockLen(block) + 1
+		block++
+	}
+
+	// The block is a sequence of huffman codes, of which the first one
+	// starts at the beginning of the block. The codes are read into a
+	// left aligned 64 bit buffer, until the symbol containing the value
+	// at the offset is found.
+	data := d.data[uint64(block)*d.blockSize:]
+	buffer := binary.BigEndian.Uint64(data)
+	data = data[8:]
+	bufferSize := 64
+
+	var sym int
+	for {
+		// the length of the code, relative to the minimum length, is the
+		// first one whose lowest code is smaller than the buffer
+		length := 0
+		for buffer < d.base64[length] {
+			length++
+		}
+
+		sym = int((buffer - d.base64[length]) >> (64 - length - d.minSymLen))
+		sym += d.lowest(length)
+
+		if offset <= int(d.symLen[sym]) {
+			break
+		}
+
+		// skip over the symbol's values and consume it's code
+		offset -= int(d.symLen[sym]) + 1
+		length += d.minSymLen
+		buffer <<= length
+		bufferSize -= length
+
+		if bufferSize <= 32 {
+			// refill the buffer
+			bufferSize += 32
+			buffer |= uint64(binary.BigEndian.Uint32(data)) << (64 - bufferSize)
+			data = data[4:]
+		}
+	}
+
+	// expand the symbol's pairs until the symbol of the value is found
+	for d.symLen[sym] != 0 {
+		left := d.left(sym)
+		if offset <= int(d.symLen[left]) {
+			sym = left
+		} else {
+			offset -= int(d.symLen[left]) + 1
+			sym = d.right(sym)
+		}
+	}
+
+	return d.left(sym)
+}
@@ -0,0 +1,292 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import (
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+)
+
+// maxMoves is the size of the move buffers, which is larger than the
+// maximum number of legal moves possible in a position (218).
+const maxMoves = 256
+
+// probeState represents the state of a probe, which is passed around the
+// recursive probing functions.
+type probeState uint8
+
+// constants representing the various probe states
+const (
+	probeOK        probeState = iota // probe successful
+	probeFail                        // table not available
+	probeZeroing                     // best move is a zeroing move
+	probeChangeSTM                   // dtz table stores the other side
+)
+
+// ProbeWDL probes the wdl tables for the given position. The reported
+// boolean is false if a required table isn't available. The castling
+// rights and the draw clock of the position are ignored, so the probes
+// are only accurate for positions where both are zero. The board is used
+// to search the captures of the position, but is restored before return.
+func (tb *Tablebase) ProbeWDL(b *board.Board) (WDL, bool) {
+	state := probeOK
+	wdl := tb.search(b, false, &state)
+	return wdl, state != probeFail
+}
+
+// ProbeDTZ probes the dtz tables for the given position, and returns the
+// number of plys to a zeroing move, which is positive if the side to move
+// is winning, negative if it is losing, and zero if the position is a draw.
+// The dtz of cursed wins and blessed losses is 100 more than their actual
+// dtz, and the dtz is one ply more than the actual dtz in some positions
+// which are not near the 50-move rule limit. A dtz of -1 means that the
+// side to move is mated. The reported boolean is false if a required table
+// isn't available. The board is restored before return.
+func (tb *Tablebase) ProbeDTZ(b *board.Board) (int, bool) {
+	state := probeOK
+	dtz := tb.probeDTZ(b, &state)
+	return dtz, state != probeFail
+}
+
+// DTZBeforeZeroing returns the dtz of a position whose best move is a
+// zeroing move leading to the given wdl, from the perspective of the side
+// to move before the zeroing move.
+func DTZBeforeZeroing(wdl WDL) int {
+	switch wdl {
+	case Win:
+		return 1
+	case CursedWin:
+		return 101
+	case BlessedLoss:
+		return -101
+	case Loss:
+		return -1
+	default:
+		return 0
+	}
+}
+
+// search resolves the captures of the given position, and the pawn moves
+// if zeroing is set, before probing the wdl tables. This is required since
+// the tables store arbitrary values for positions where a capture, or an
+// en passant capture which isn't encoded by the tables, is the best move.
+// The state is set to probeZeroing if the best move is one of the moves
+// searched.
+func (tb *Tablebase) search(b *board.Board, zeroing bool, state *probeState) WDL {
+	var buffer [maxMoves]move.Move
+	var generator board.MoveGenerator
+	b.InitGenerator(&generator)
+
+	moves := generator.AppendTacticals(buffer[:0])
+	if zeroing {
+		// all pawn moves are zeroing moves, not only the promotions
+		moves = generator.AppendQuiets(moves)
+	}
+
+	best, searched := Loss, 0
+	for _, m := range moves {
+		if !m.IsCapture() && (!zeroing || m.FromPiece().Type() != piece.Pawn) {
+			continue
+		}
+
+		searched++
+
+		b.MakeMove(m)
+		wdl := -tb.search(b, false, state)
+		b.UnmakeMove()
+
+		if *state == probeFail {
+			return Draw
+		}
+
+		if wdl > best {
+			best = wdl
+			if wdl >= Win {
+				*state = probeZeroing
+				return wdl
+			}
+		}
+	}
+
+	// If all the legal moves have been searched, the stored value of the
+	// position can't be trusted, and isn't needed either.
+	noMoreMoves := false
+	if searched > 0 {
+		if !zeroing {
+			moves = generator.AppendQuiets(moves)
+		}
+
+		noMoreMoves = searched == len(moves)
+	}
+
+	value := best
+	if !noMoreMoves {
+		value = tb.probeWDLTable(b, state)
+		if *state == probeFail {
+			return Draw
+		}
+	}
+
+	// the dtz tables store arbitrary values if the best value is a win
+	if best >= value {
+		*state = probeOK
+		if best > Draw || noMoreMoves {
+			*state = probeZeroing
+		}
+
+		return best
+	}
+
+	*state = probeOK
+	return value
+}
+
+// probeDTZ probes the dtz of the given position, as described by ProbeDTZ.
+func (tb *Tablebase) probeDTZ(b *board.Board, state *probeState) int {
+	wdl := tb.search(b, true, state)
+	if *state == probeFail || wdl == Draw {
+		return 0
+	}
+
+	// the stored dtz can't be trusted if the best move is a zeroing move
+	if *state == probeZeroing {
+		return DTZBeforeZeroing(wdl)
+	}
+
+	dtz := tb.probeDTZTable(b, wdl, state)
+	switch *state {
+	case probeFail:
+		return 0
+	case probeOK:
+		if wdl == CursedWin || wdl == BlessedLoss {
+			dtz += 100
+		}
+
+		if wdl < Draw {
+			dtz = -dtz
+		}
+
+		return dtz
+	}
+
+	// The dtz table stores the other side to move, so a 1-ply search is
+	// done, which finds the move with the smallest dtz among the moves
+	// which preserve the position's wdl.
+	var buffer [maxMoves]move.Move
+	var generator board.MoveGenerator
+	b.InitGenerator(&generator)
+
+	moves := generator.AppendTacticals(buffer[:0])
+	moves = generator.AppendQuiets(moves)
+
+	minDTZ := 0xffff
+	for _, m := range moves {
+		zeroing := m.IsCapture() || m.FromPiece().Type() == piece.Pawn
+
+		b.MakeMove(m)
+
+		// the dtz of a zeroing move is known from the wdl after it,
+		// while the dtz of the other moves is one ply more than the
+		// dtz after them
+		if zeroing {
+			dtz = -DTZBeforeZeroing(tb.search(b, false, state))
+		} else {
+			dtz = -tb.probeDTZ(b, state)
+		}
+
+		if dtz == 1 && b.IsInCheck(b.SideToMove) && isMated(b) {
+			// the move checkmates the opponent
+			minDTZ = 1
+		}
+
+		if !zeroing {
+			switch {
+			case dtz > 0:
+				dtz++
+			case dtz < 0:
+				dtz--
+			}
+		}
+
+		b.UnmakeMove()
+
+		if *state == probeFail {
+			return 0
+		}
+
+		// only the moves which preserve the wdl are considered
+		if dtz != 0 && dtz < minDTZ && (dtz > 0) == (wdl > Draw) {
+			minDTZ = dtz
+		}
+	}
+
+	if minDTZ == 0xffff {
+		// no legal moves, the position is a checkmate
+		return -1
+	}
+
+	return minDTZ
+}
+
+// probeWDLTable probes the wdl table of the given position, without
+// resolving it's captures.
+func (tb *Tablebase) probeWDLTable(b *board.Board, state *probeState) WDL {
+	if (b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]).Count() == 2 {
+		// only the kings are left
+		return Draw
+	}
+
+	t, flipped := tb.lookup(b)
+	if t == nil || t.wdl == nil {
+		*state = probeFail
+		return Draw
+	}
+
+	return t.probeWDL(b, flipped)
+}
+
+// probeDTZTable probes the dtz table of the given position, whose wdl is
+// given, without resolving it's captures. The state is set to
+// probeChangeSTM if the table only stores the other side to move.
+func (tb *Tablebase) probeDTZTable(b *board.Board, wdl WDL, state *probeState) int {
+	if (b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]).Count() == 2 {
+		// only the kings are left
+		return 0
+	}
+
+	t, flipped := tb.lookup(b)
+	if t == nil || t.dtz == nil {
+		*state = probeFail
+		return 0
+	}
+
+	dtz, stored := t.probeDTZ(b, flipped, wdl)
+	if !stored {
+		*state = probeChangeSTM
+	}
+
+	return dtz
+}
+
+// isMated reports whether the side to move has no legal moves. It is
+// only called on positions where the side to move is in check.
+func isMated(b *board.Board) bool {
+	var buffer [maxMoves]move.Move
+	var generator board.MoveGenerator
+	b.InitGenerator(&generator)
+
+	return len(generator.AppendTacticals(buffer[:0])) == 0 &&
+		len(generator.AppendQuiets(buffer[:0])) == 0
+}
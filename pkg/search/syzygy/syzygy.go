@@ -0,0 +1,257 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package syzygy implements the loading and probing of syzygy endgame
+// tablebases. The tablebase files are memory-mapped where it is supported
+// and are only ever read, so a Tablebase can be probed concurrently by any
+// number of search threads without any synchronization.
+//
+// The wdl tables store the win-draw-loss value of every position of their
+// material, as if the draw clock was zero, while the dtz tables store the
+// distance to a zeroing move (a capture or a pawn move) for the winning
+// and losing side.
+// https://www.chessprogramming.org/Syzygy_Bases
+package syzygy
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/piece"
+)
+
+// MaxPieces is the largest number of pieces, including the kings, of the
+// positions available in the syzygy tablebases.
+const MaxPieces = 7
+
+// WDL represents the win-draw-loss value of a position, from the side to
+// move's perspective. Cursed wins and blessed losses are the wins and
+// losses which can't be achieved within the 50-move rule.
+type WDL int8
+
+// constants representing the various wdl values
+const (
+	Loss        WDL = -2
+	BlessedLoss WDL = -1
+	Draw        WDL = 0
+	CursedWin   WDL = 1
+	Win         WDL = 2
+)
+
+// file extensions of the wdl and dtz tables
+const (
+	wdlSuffix = ".rtbw"
+	dtzSuffix = ".rtbz"
+)
+
+// Tablebase represents a set of opened syzygy tables. The tables are read
+// only, and are not valid after the tablebase is closed.
+type Tablebase struct {
+	tables    map[materialKey]*table // tables indexed by their material
+	maxPieces int                    // largest number of pieces of a table
+}
+
+// Open opens the syzygy tables found in the given list of directories,
+// which is separated by the os's path list separator (':' on unix, ';' on
+// windows), like the SyzygyPath option of other engines.
+func Open(path string) (*Tablebase, error) {
+	tb := &Tablebase{tables: make(map[materialKey]*table)}
+
+	for _, dir := range filepath.SplitList(path) {
+		if dir == "" {
+			continue
+		}
+
+		if err := tb.openDir(dir); err != nil {
+			tb.Close()
+			return nil, err
+		}
+	}
+
+	return tb, nil
+}
+
+// openDir opens every syzygy table found in the given directory.
+func (tb *Tablebase) openDir(dir string) error {
+	entries, err := os.ReadDir(dir)
+	if err != nil {
+		return err
+	}
+
+	for _, entry := range entries {
+		name := entry.Name()
+		ext := filepath.Ext(name)
+		material := strings.TrimSuffix(name, ext)
+
+		first, second, valid := parseMaterial(material)
+		if entry.IsDir() || (ext != wdlSuffix && ext != dtzSuffix) || !valid {
+			// not a syzygy table
+			continue
+		}
+
+		key := first.key()<<sideBits | second.key()
+		t := tb.tables[key]
+		if t == nil {
+			t = newTable(first, second)
+			tb.tables[key] = t
+		}
+
+		file := filepath.Join(dir, name)
+		switch ext {
+		case wdlSuffix:
+			if t.wdl != nil {
+				// table already found in a previous directory
+				continue
+			}
+
+			t.wdl, err = openTable(file, wdlMagic, t)
+		case dtzSuffix:
+			if t.dtz != nil {
+				// table already found in a previous directory
+				continue
+			}
+
+			t.dtz, err = openTable(file, dtzMagic, t)
+		}
+
+		if err != nil {
+			return err
+		}
+
+		if t.wdl != nil && t.pieces > tb.maxPieces {
+			tb.maxPieces = t.pieces
+		}
+	}
+
+	return nil
+}
+
+// Close closes the tablebase, and releases all of it's tables.
+func (tb *Tablebase) Close() error {
+	var err error
+	for material, t := range tb.tables {
+		if e := t.close(); e != nil && err == nil {
+			err = e
+		}
+
+		delete(tb.tables, material)
+	}
+
+	tb.maxPieces = 0
+	return err
+}
+
+// MaxPieces returns the largest number of pieces of the positions which
+// can be probed in the tablebase, and zero if it doesn't have any tables.
+func (tb *Tablebase) MaxPieces() int {
+	return tb.maxPieces
+}
+
+// lookup returns the table of the given position's material, which is nil
+// if it isn't available. The tables are only stored with the stronger
+// side first, so the reported boolean is true if the colors of the
+// position are flipped relative to it's table.
+func (tb *Tablebase) lookup(b *board.Board) (*table, bool) {
+	// the piece counts of larger positions can overflow the keys
+	if (b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]).Count() > tb.maxPieces {
+		return nil, false
+	}
+
+	white, black := sideKey(b, piece.White), sideKey(b, piece.Black)
+	if t, found := tb.tables[white<<sideBits|black]; found {
+		return t, false
+	}
+
+	return tb.tables[black<<sideBits|white], true
+}
+
+// materialKey uniquely identifies the material of a table, with the piece
+// counts of the first side in the high bits and of the second in the low
+// bits. The kings are implied, so they aren't counted.
+type materialKey uint32
+
+// bits used by the piece counts of each type and each side
+const (
+	countBits = 3
+	sideBits  = countBits * (len(materialOrder) - 1)
+)
+
+// sideKey returns the material key of the given color's pieces.
+func sideKey(b *board.Board, c piece.Color) materialKey {
+	var key materialKey
+	for _, t := range materialOrder[1:] {
+		key = key<<countBits | materialKey((b.PieceBBs[t] & b.ColorBBs[c]).Count())
+	}
+
+	return key
+}
+
+// material represents the piece counts of a side of a table, in the order
+// of materialOrder.
+type material [len(materialOrder)]int
+
+// key returns the material key of the side, without the king.
+func (m material) key() materialKey {
+	var key materialKey
+	for _, count := range m[1:] {
+		key = key<<countBits | materialKey(count)
+	}
+
+	return key
+}
+
+// parseMaterial parses the material of both sides of the given table name,
+// of the form KQRvKP, with a king on each side. The reported boolean is
+// false if the name isn't a valid table name.
+func parseMaterial(name string) (material, material, bool) {
+	first, second, found := strings.Cut(name, "v")
+	if !found || len(name)-1 > MaxPieces {
+		return material{}, material{}, false
+	}
+
+	var sides [2]material
+	for i, side := range [...]string{first, second} {
+		if !strings.HasPrefix(side, "K") {
+			return material{}, material{}, false
+		}
+
+		sides[i][0] = 1 // king
+		for j := 1; j < len(side); j++ {
+			// the king can't be repeated
+			index := strings.IndexByte(materialLetters[1:], side[j])
+			if index < 0 {
+				return material{}, material{}, false
+			}
+
+			sides[i][index+1]++
+		}
+	}
+
+	return sides[0], sides[1], true
+}
+
+// materialOrder is the order of the pieces in the names of the tables.
+var materialOrder = [...]piece.Type{
+	piece.King, piece.Queen, piece.Rook, piece.Bishop, piece.Knight, piece.Pawn,
+}
+
+// materialLetters are the letters of the pieces in materialOrder.
+const materialLetters = "KQRBNP"
+
+// errCorrupt is returned while opening a corrupted table.
+func errCorrupt(name string) error {
+	return fmt.Errorf("syzygy: %s is not a valid table", name)
+}
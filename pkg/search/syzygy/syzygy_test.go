@@ -0,0 +1,501 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import (
+	"encoding/binary"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/move/attacks"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+)
+
+// The tables used by the tests are written by a simple encoder, since no
+// real tables are available to the tests. The values are encoded with pair
+// symbols for runs of up to 256 equal values, and the symbols are encoded
+// with canonical codes of two different lengths.
+
+// parameters of the encoded tables
+const (
+	testBlockSize   = 10 // log2 of the block size in bytes
+	testSpan        = 10 // log2 of the sparse index span
+	testBlockBits   = 8 * 1000
+	testBlockValues = 60000
+)
+
+// testEncoding represents the encoded values of a part of a table.
+type testEncoding struct {
+	sizes, sparseIndex, blockLength, blocks []byte
+}
+
+// encodeValues encodes the given values, with the given pairs data flags.
+// A single value is encoded with the single value flag.
+func encodeValues(values []uint8, flags uint8) testEncoding {
+	if len(values) == 1 {
+		return testEncoding{sizes: []byte{flags | flagSingleValue, values[0]}}
+	}
+
+	leaves := 0
+	for _, value := range values {
+		leaves = util.Max(leaves, int(value)+1)
+	}
+
+	// symbol v is the value v, and symbol leaves + 8v + k-1 is a run of
+	// 2^k values v, made up of two runs of 2^(k-1) values v
+	run := func(value uint8, k int) int {
+		if k == 0 {
+			return int(value)
+		}
+
+		return leaves + 8*int(value) + k - 1
+	}
+
+	btree := make([][2]int, 9*leaves)
+	for value := uint8(0); int(value) < leaves; value++ {
+		btree[value] = [2]int{int(value), noSymbol}
+		for k := 1; k <= 8; k++ {
+			btree[run(value, k)] = [2]int{run(value, k-1), run(value, k-1)}
+		}
+	}
+
+	// greedily use the longest runs
+	var stream []int
+	for i := 0; i < len(values); {
+		length := 1
+		for i+length < len(values) && length < 256 && values[i+length] == values[i] {
+			length++
+		}
+
+		k := 0
+		for 1<<(k+1) <= length {
+			k++
+		}
+
+		stream = append(stream, run(values[i], k))
+		i += 1 << k
+	}
+
+	return encodeSymbols(btree, stream, len(values), flags)
+}
+
+// encodeSymbols encodes the given stream of symbols, which represents the
+// given number of values. The symbols are the leaves and pairs in btree.
+func encodeSymbols(btree [][2]int, stream []int, values int, flags uint8) testEncoding {
+	symbols := len(btree)
+
+	// The codes of the symbols are a complete code with 2^length codes
+	// where the first symbols have length bit codes, and the rest have
+	// codes one bit shorter, each replacing two longer codes. Longer codes
+	// have lower symbols, and the lowest code of each length is zero for
+	// the longest codes, and after the longer codes for the shorter ones.
+	length := 1
+	for 1<<length < symbols {
+		length++
+	}
+
+	long := 2*symbols - 1<<length
+	code := func(sym int) (uint64, int) {
+		if sym < long {
+			return uint64(sym), length
+		}
+
+		return uint64(long/2 + sym - long), length - 1
+	}
+
+	// lowest symbol of each length, from the shortest length
+	lowestSym := []byte{byte(long), byte(long >> 8), 0, 0}
+	minSymLen := length - 1
+	if long == symbols {
+		lowestSym, minSymLen = lowestSym[2:], length
+	}
+
+	symLen := make([]int, symbols)
+	for sym, lr := range btree {
+		if lr[1] != noSymbol {
+			symLen[sym] = symLen[lr[0]] + symLen[lr[1]]
+		} else {
+			symLen[sym] = 1
+		}
+	}
+
+	// encode the symbols into blocks
+	var blocks [][]byte
+	var blockStart []int
+	var block []byte
+	bits, count := 0, 0
+	for i, value := 0, 0; i < len(stream); i++ {
+		c, n := code(stream[i])
+		if i == 0 || bits+n > testBlockBits || count+symLen[stream[i]] > testBlockValues {
+			if i > 0 {
+				blocks = append(blocks, block)
+			}
+
+			block, bits, count = make([]byte, 1<<testBlockSize), 0, 0
+			blockStart = append(blockStart, value)
+		}
+
+		for j := n - 1; j >= 0; j-- {
+			block[bits/8] |= byte(c>>j&1) << (7 - bits%8)
+			bits++
+		}
+
+		count += symLen[stream[i]]
+		value += symLen[stream[i]]
+	}
+
+	blocks = append(blocks, block)
+	blockStart = append(blockStart, values)
+
+	var e testEncoding
+
+	e.sizes = []byte{flags, testBlockSize, testSpan, 0, 0, 0, 0, 0, byte(length), byte(minSymLen)}
+	binary.LittleEndian.PutUint32(e.sizes[4:], uint32(len(blocks)))
+	e.sizes = append(e.sizes, lowestSym...)
+	e.sizes = binary.LittleEndian.AppendUint16(e.sizes, uint16(symbols))
+	for _, lr := range btree {
+		e.sizes = append(e.sizes, byte(lr[0]), byte(lr[0]>>8&0xf)|byte(lr[1]&0xf)<<4, byte(lr[1]>>4))
+	}
+
+	e.sizes = append(e.sizes, make([]byte, symbols&1)...)
+
+	for i, block := range blocks {
+		e.blockLength = binary.LittleEndian.AppendUint16(e.blockLength, uint16(blockStart[i+1]-blockStart[i]-1))
+		e.blocks = append(e.blocks, block...)
+	}
+
+	// the sparse index entry k points to the value k*span + span/2, and
+	// the entries past the end point past the end of the last block
+	span := 1 << testSpan
+	last := 0
+	for k := 0; k*span < values; k++ {
+		value := k*span + span/2
+		for last < len(blocks)-1 && blockStart[last+1] <= value {
+			last++
+		}
+
+		e.sparseIndex = binary.LittleEndian.AppendUint32(e.sparseIndex, uint32(last))
+		e.sparseIndex = binary.LittleEndian.AppendUint16(e.sparseIndex, uint16(value-blockStart[last]))
+	}
+
+	return e
+}
+
+// newTestFile creates a table file, without any values, for the given
+// table whose pieces are encoded in the given order.
+func newTestFile(t *table, pieces []piece.Piece) *tableFile {
+	order := [2]int{0, 0xf}
+	if t.hasPawns && t.pawnCount[1] > 0 {
+		order[1] = 1
+	}
+
+	maxFile := 0
+	if t.hasPawns {
+		maxFile = 3
+	}
+
+	f := &tableFile{sides: 2}
+	for file := 0; file <= maxFile; file++ {
+		for stm := range f.items {
+			d := &f.items[stm][file]
+			copy(d.pieces[:], pieces)
+			d.setGroups(t, order, file)
+		}
+	}
+
+	return f
+}
+
+// writeTable writes a table file of the given material, without pawns, to
+// the directory. The pieces are encoded in the given order, and the values
+// of every side stored in the file, with their flags, are given.
+func writeTable(t *testing.T, dir, name string, magic []byte, pieces []piece.Piece, values [][]uint8, flags uint8) {
+	data := append([]byte(nil), magic...)
+
+	header := byte(0)
+	if len(values) == 2 {
+		header |= headerSplit
+	}
+
+	data = append(data, header, 0) // leading group first for both sides
+	for _, p := range pieces {
+		data = append(data, byte(p)|byte(p)<<4)
+	}
+
+	data = append(data, make([]byte, len(data)&1)...)
+
+	encodings := make([]testEncoding, len(values))
+	for i := range values {
+		encodings[i] = encodeValues(values[i], flags)
+		data = append(data, encodings[i].sizes...)
+	}
+
+	if len(values) == 1 {
+		// the alignment after the dtz maps
+		data = append(data, make([]byte, len(data)&1)...)
+	}
+
+	for _, e := range encodings {
+		data = append(data, e.sparseIndex...)
+	}
+
+	for _, e := range encodings {
+		data = append(data, e.blockLength...)
+	}
+
+	for _, e := range encodings {
+		data = append(data, make([]byte, -len(data)&63)...)
+		data = append(data, e.blocks...)
+	}
+
+	data = append(data, make([]byte, -len(data)&63+16)...)
+	if err := os.WriteFile(filepath.Join(dir, name), data, 0o644); err != nil {
+		t.Fatal(err)
+	}
+}
+
+// kqkPieces is the order in which the pieces of KQvK are encoded.
+var kqkPieces = []piece.Piece{piece.WhiteQueen, piece.WhiteKing, piece.BlackKing}
+
+// kqkValues calculates the wdl values, plus two, of KQvK for both sides
+// to move. With black to move, the positions where the queen can be
+// captured are stored as losses, and are resolved by the probe's search.
+func kqkValues() [][]uint8 {
+	kqk := newTable(material{1, 1}, material{1})
+	f := newTestFile(kqk, kqkPieces)
+
+	values := [][]uint8{
+		make([]uint8, f.items[0][0].size()),
+		make([]uint8, f.items[1][0].size()),
+	}
+
+	for i := range values[1] {
+		values[0][i], values[1][i] = uint8(Win+2), uint8(Loss+2)
+	}
+
+	b := board.New()
+	forEachPlacement(kqkPieces, nil, func(squares []square.Square) {
+		queen, king, enemy := squares[0], squares[1], squares[2]
+		occupied := bitboard.Square(queen) | bitboard.Square(king) | bitboard.Square(enemy)
+
+		// the squares attacked by white, with the black king removed
+		attacked := attacks.King[king] | attacks.Queen(queen, occupied&^bitboard.Square(enemy))
+
+		// black's king can't capture a defended queen
+		moves := attacks.King[enemy] &^ attacked
+		if attacks.King[king].IsSet(queen) {
+			moves &^= bitboard.Square(queen)
+		}
+
+		b.SideToMove = piece.Black
+		_, _, idx := kqk.index(b, f, false, false)
+
+		switch {
+		case moves == bitboard.Empty && !attacked.IsSet(enemy):
+			// stalemate
+			values[1][idx] = uint8(Draw + 2)
+		case moves == bitboard.Square(queen):
+			// the only move is capturing the queen, so the stored value
+			// doesn't matter, and an arbitrary value is stored
+			values[1][idx] = uint8(Win + 2)
+		}
+	}, b)
+
+	return values
+}
+
+// forEachPlacement calls fn for every placement of the given pieces on the
+// board, where the kings aren't adjacent. The placements of each piece are
+// limited to the given squares, if any. The pieces are placed on b.
+func forEachPlacement(pieces []piece.Piece, limits [][]square.Square, fn func([]square.Square), b *board.Board) {
+	squares := make([]square.Square, len(pieces))
+
+	var place func(i int)
+	place = func(i int) {
+		if i == len(pieces) {
+			if (b.KingBB(piece.White) & attacks.King[b.KingBB(piece.Black).FirstOne()]) == bitboard.Empty {
+				fn(squares)
+			}
+
+			return
+		}
+
+		candidates := allSquares
+		if i < len(limits) && limits[i] != nil {
+			candidates = limits[i]
+		}
+
+		for _, s := range candidates {
+			if b.Position[s] != piece.NoPiece ||
+				(pieces[i].Type() == piece.Pawn && (s.Rank() == square.Rank1 || s.Rank() == square.Rank8)) {
+				continue
+			}
+
+			squares[i] = s
+			b.FillSquare(s, pieces[i])
+			place(i + 1)
+			b.ClearSquare(s)
+		}
+	}
+
+	place(0)
+}
+
+// allSquares contains all the squares of the board.
+var allSquares = func() []square.Square {
+	squares := make([]square.Square, square.N)
+	for s := range squares {
+		squares[s] = square.Square(s)
+	}
+
+	return squares
+}()
+
+func TestOpen(t *testing.T) {
+	first, second := t.TempDir(), t.TempDir()
+
+	krkn := []piece.Piece{piece.WhiteRook, piece.WhiteKing, piece.BlackKing, piece.BlackKnight}
+	writeTable(t, first, "KQvK.rtbw", wdlMagic, kqkPieces, [][]uint8{{4}, {0}}, 0)
+	writeTable(t, first, "KRvKN.rtbw", wdlMagic, krkn, [][]uint8{{2}, {2}}, 0)
+	writeTable(t, second, "KRvKN.rtbz", dtzMagic, krkn, [][]uint8{{0}}, 0)
+	if err := os.WriteFile(filepath.Join(second, "README.txt"), nil, 0o644); err != nil {
+		t.Fatal(err)
+	}
+
+	tb, err := Open(first + string(os.PathListSeparator) + second)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	defer tb.Close()
+
+	if tb.MaxPieces() != 4 {
+		t.Errorf("max pieces: expected 4, got %d", tb.MaxPieces())
+	}
+
+	tests := []struct {
+		fen     string
+		found   bool
+		flipped bool
+	}{
+		{"8/8/8/8/8/2k5/8/KQ6 w - - 0 1", true, false},
+		{"8/8/8/8/8/2k5/8/Kq6 b - - 0 1", true, true},
+		{"8/8/8/8/8/2k5/8/KR1n4 w - - 0 1", true, false},
+		{"8/8/8/8/8/2k5/8/Kr1N4 w - - 0 1", true, true},
+		{"8/8/8/8/8/2k5/8/KB6 w - - 0 1", false, false},
+		{"8/8/8/8/8/2k5/8/KQRN4 w - - 0 1", false, false},
+	}
+
+	for _, test := range tests {
+		b := board.New(board.FEN(fen.FromString(test.fen)))
+		table, flipped := tb.lookup(b)
+		if found := table != nil; found != test.found || (found && flipped != test.flipped) {
+			t.Errorf("%s: expected found %v flipped %v, got %v %v", test.fen, test.found, test.flipped, found, flipped)
+		}
+	}
+}
+
+func TestOpenCorrupt(t *testing.T) {
+	tests := []struct {
+		name  string
+		magic []byte
+		size  int
+	}{
+		{"wrong magic", dtzMagic, 80},
+		{"truncated", wdlMagic, 80},
+		{"wrong size", wdlMagic, 64},
+	}
+
+	for _, test := range tests {
+		dir := t.TempDir()
+
+		data := make([]byte, test.size)
+		copy(data, test.magic)
+		if err := os.WriteFile(filepath.Join(dir, "KQvK.rtbw"), data, 0o644); err != nil {
+			t.Fatal(err)
+		}
+
+		if _, err := Open(dir); err == nil {
+			t.Errorf("%s: expected error", test.name)
+		}
+	}
+}
+
+func TestProbe(t *testing.T) {
+	dir := t.TempDir()
+	writeTable(t, dir, "KQvK.rtbw", wdlMagic, kqkPieces, kqkValues(), 0)
+
+	// every win is stored as 1 move, or 2 plys, to a zeroing move, which
+	// is one more than the stored value with white to move
+	writeTable(t, dir, "KQvK.rtbz", dtzMagic, kqkPieces, [][]uint8{{0}}, 0)
+
+	tb, err := Open(dir)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	defer tb.Close()
+
+	tests := []struct {
+		fen string
+		wdl WDL
+		dtz int
+	}{
+		{"8/8/8/8/8/2k5/8/KQ6 w - - 0 1", Win, 1},
+		{"8/8/8/8/8/2k5/8/KQ6 b - - 0 1", Loss, -2},
+		{"8/8/8/8/8/2K5/8/kq6 b - - 0 1", Win, 1},
+		{"8/8/8/8/8/2K5/8/kq6 w - - 0 1", Loss, -2},
+
+		// stalemate
+		{"k7/2Q5/1K6/8/8/8/8/8 b - - 0 1", Draw, 0},
+		{"8/8/8/8/8/1k6/2q5/K7 w - - 0 1", Draw, 0},
+
+		// checkmate
+		{"k7/1Q6/1K6/8/8/8/8/8 b - - 0 1", Loss, -1},
+
+		// the queen is captured, which is resolved by the search
+		{"8/8/8/8/8/8/1kQ5/4K3 b - - 0 1", Draw, 0},
+		{"8/8/8/8/8/8/1kQ5/2K5 b - - 0 1", Loss, -2},
+		{"k7/1Q6/8/8/8/8/8/7K b - - 0 1", Draw, 0},
+	}
+
+	for _, test := range tests {
+		b := board.New(board.FEN(fen.FromString(test.fen)))
+		hash := b.Hash
+
+		if wdl, ok := tb.ProbeWDL(b); !ok || wdl != test.wdl {
+			t.Errorf("%s: wdl: expected %d, got %d (found %v)", test.fen, test.wdl, wdl, ok)
+		}
+
+		if dtz, ok := tb.ProbeDTZ(b); !ok || dtz != test.dtz {
+			t.Errorf("%s: dtz: expected %d, got %d (found %v)", test.fen, test.dtz, dtz, ok)
+		}
+
+		if b.Hash != hash || b.Plys != 0 {
+			t.Errorf("%s: board not restored", test.fen)
+		}
+	}
+
+	// tables with more pieces are not available
+	b := board.New(board.FEN(fen.FromString("8/8/8/4k3/8/8/8/KQR5 w - - 0 1")))
+	if _, ok := tb.ProbeWDL(b); ok {
+		t.Error("KQRvK: expected probe to fail")
+	}
+}
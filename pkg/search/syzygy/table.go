@@ -0,0 +1,556 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import (
+	"bytes"
+	"encoding/binary"
+	"math/bits"
+	"os"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/bitboard"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+)
+
+// magic numbers at the start of the wdl and dtz tables
+var (
+	wdlMagic = []byte{0x71, 0xe8, 0x23, 0x5d}
+	dtzMagic = []byte{0xd7, 0x66, 0x0c, 0xa5}
+)
+
+// flags in the header of a table file
+const (
+	headerSplit    = 1 // wdl values stored for both sides to move
+	headerHasPawns = 2 // table has pawns
+)
+
+// table represents the wdl and dtz tables of a single material, with the
+// material of the first side of it's name as white.
+type table struct {
+	pieces          int  // number of pieces, including the kings
+	hasPawns        bool // whether there are any pawns
+	hasUniquePieces bool // whether a side has a single piece of a type
+	symmetric       bool // whether both sides have the same material
+
+	// pawns of the leading color, which is the color with pawns, or the
+	// one with less pawns if both have them, and of the other color
+	pawnCount [2]int
+
+	// parsed table files, nil if not available
+	wdl, dtz *tableFile
+}
+
+// newTable creates a new table for the given material, with the pieces
+// of the first side and the second side in the order of materialOrder.
+func newTable(first, second material) *table {
+	t := &table{symmetric: first == second}
+
+	for _, counts := range [...]material{first, second} {
+		for i, count := range counts {
+			t.pieces += count
+			if materialOrder[i] != piece.King && count == 1 {
+				t.hasUniquePieces = true
+			}
+		}
+	}
+
+	pawn := len(materialOrder) - 1
+	whitePawns, blackPawns := first[pawn], second[pawn]
+	t.hasPawns = whitePawns+blackPawns > 0
+
+	// the side with less pawns leads, as it compresses better
+	if blackPawns == 0 || (whitePawns > 0 && blackPawns >= whitePawns) {
+		t.pawnCount = [2]int{whitePawns, blackPawns}
+	} else {
+		t.pawnCount = [2]int{blackPawns, whitePawns}
+	}
+
+	return t
+}
+
+// tableFile represents a parsed wdl or dtz table file.
+type tableFile struct {
+	data []byte // memory-mapped file
+
+	// pairs data indexed by side to move and by the file of the leading
+	// pawn; dtz tables only store a single side to move, and the tables
+	// without pawns don't depend on the file
+	items [2][4]pairsData
+	sides int
+}
+
+// get returns the pairs data of the given side to move and leading file.
+func (f *tableFile) get(stm, file int) *pairsData {
+	return &f.items[stm%f.sides][file]
+}
+
+// openTable memory-maps the given table file, and parses it's header for
+// the given table's material.
+func openTable(name string, magic []byte, t *table) (*tableFile, error) {
+	f, err := os.Open(name)
+	if err != nil {
+		return nil, err
+	}
+
+	// the mapping stays valid after the file is closed
+	defer f.Close()
+
+	info, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+
+	// the tables are padded to a multiple of 64 bytes, followed
+	// by a 16 byte checksum, which is not verified here
+	size := info.Size()
+	if size%64 != 16 {
+		return nil, errCorrupt(name)
+	}
+
+	data, err := mapFile(f, int(size))
+	if err != nil {
+		return nil, err
+	}
+
+	file := &tableFile{data: data, sides: 1}
+	if bytes.Equal(magic, wdlMagic) {
+		file.sides = 2
+	}
+
+	if !bytes.HasPrefix(data, magic) || !file.parse(t) {
+		unmapFile(data)
+		return nil, errCorrupt(name)
+	}
+
+	return file, nil
+}
+
+// parse parses the headers of the table file, which contains the given
+// table. It reports whether the file is a valid table file.
+func (f *tableFile) parse(t *table) (valid bool) {
+	// the offsets in the header are trusted, and a corrupt header makes
+	// them point out of the file, which panics on the slice bounds
+	defer func() {
+		if recover() != nil {
+			valid = false
+		}
+	}()
+
+	data := f.data
+	offset := len(wdlMagic)
+
+	if (data[offset]&headerHasPawns != 0) != t.hasPawns {
+		return false
+	}
+
+	offset++
+
+	sides := 1
+	if f.sides == 2 && !t.symmetric {
+		sides = 2
+	}
+
+	maxFile := 0
+	if t.hasPawns {
+		maxFile = 3
+	}
+
+	// pawns on both sides
+	pp := t.hasPawns && t.pawnCount[1] > 0
+
+	for file := 0; file <= maxFile; file++ {
+		// the order of the leading group and the other side's pawns in
+		// the encoding, for both sides to move
+		order := [2][2]int{{int(data[offset] & 0xf), 0xf}, {int(data[offset] >> 4), 0xf}}
+		if pp {
+			order[0][1] = int(data[offset+1] & 0xf)
+			order[1][1] = int(data[offset+1] >> 4)
+			offset++
+		}
+
+		offset++
+
+		for k := 0; k < t.pieces; k++ {
+			f.items[0][file].pieces[k] = piece.Piece(data[offset] & 0xf)
+			f.items[1][file].pieces[k] = piece.Piece(data[offset] >> 4)
+			offset++
+		}
+
+		for i := 0; i < sides; i++ {
+			f.items[i][file].setGroups(t, order[i], file)
+		}
+	}
+
+	offset += offset & 1 // word alignment
+
+	for file := 0; file <= maxFile; file++ {
+		for i := 0; i < sides; i++ {
+			offset = f.items[i][file].setSizes(data, offset)
+		}
+	}
+
+	if f.sides == 1 {
+		offset = f.setDTZMap(offset, maxFile)
+	}
+
+	for file := 0; file <= maxFile; file++ {
+		for i := 0; i < sides; i++ {
+			d := &f.items[i][file]
+			d.sparseIndex = data[offset : offset+6*d.sparseIndexSize]
+			offset += 6 * d.sparseIndexSize
+		}
+	}
+
+	for file := 0; file <= maxFile; file++ {
+		for i := 0; i < sides; i++ {
+			d := &f.items[i][file]
+			d.blockLength = data[offset : offset+2*d.blockLengthSize]
+			offset += 2 * d.blockLengthSize
+		}
+	}
+
+	for file := 0; file <= maxFile; file++ {
+		for i := 0; i < sides; i++ {
+			offset = (offset + 63) &^ 63 // 64 byte alignment
+
+			d := &f.items[i][file]
+			size := d.numBlocks * int(d.blockSize)
+			d.data = data[offset:] // the decoder may read past the last block
+			offset += size
+		}
+	}
+
+	return offset <= len(data)
+}
+
+// setDTZMap finds the maps of the dtz table from the given offset, which
+// map the stored values to the dtz values for each wdl value. It returns
+// the offset after the maps.
+func (f *tableFile) setDTZMap(offset, maxFile int) int {
+	data := f.data
+
+	for file := 0; file <= maxFile; file++ {
+		d := f.get(0, file)
+		if d.flags&flagMapped == 0 {
+			continue
+		}
+
+		if d.flags&flagWide != 0 {
+			offset += offset & 1 // word alignment
+			for i := range d.mapIdx {
+				d.mapIdx[i] = offset + 2
+				offset += 2*int(binary.LittleEndian.Uint16(data[offset:])) + 2
+			}
+		} else {
+			for i := range d.mapIdx {
+				d.mapIdx[i] = offset + 1
+				offset += int(data[offset]) + 1
+			}
+		}
+	}
+
+	return offset + offset&1 // word alignment
+}
+
+// close releases the memory mappings of the table's files.
+func (t *table) close() error {
+	var err error
+	for _, file := range [...]**tableFile{&t.wdl, &t.dtz} {
+		if *file == nil {
+			continue
+		}
+
+		if e := unmapFile((*file).data); e != nil && err == nil {
+			err = e
+		}
+
+		*file = nil
+	}
+
+	return err
+}
+
+// probeWDL probes the table's wdl file for the given position, which has
+// it's colors flipped relative to the table if flipped is set.
+func (t *table) probeWDL(b *board.Board, flipped bool) WDL {
+	d, _, idx := t.index(b, t.wdl, flipped, false)
+	return WDL(d.decompress(idx) - 2)
+}
+
+// probeDTZ probes the table's dtz file for the given position, which has
+// it's colors flipped relative to the table if flipped is set, and whose
+// wdl is given. The returned dtz is not signed, and is in plys, except
+// for one ply less in certain positions. The reported boolean is false if
+// the table stores the other side to move, and so can't be probed.
+func (t *table) probeDTZ(b *board.Board, flipped bool, wdl WDL) (int, bool) {
+	d, file, idx := t.index(b, t.dtz, flipped, true)
+	if d == nil {
+		return 0, false
+	}
+
+	return t.dtz.mapDTZ(file, d.decompress(idx), wdl), true
+}
+
+// wdlToMap maps a wdl value, plus two, to it's dtz map.
+var wdlToMap = [...]int{1, 3, 0, 2, 0}
+
+// mapDTZ converts the given stored value into a dtz value in plys.
+func (f *tableFile) mapDTZ(file, value int, wdl WDL) int {
+	d := f.get(0, file)
+
+	if d.flags&flagMapped != 0 {
+		offset := d.mapIdx[wdlToMap[wdl+2]]
+		if d.flags&flagWide != 0 {
+			value = int(binary.LittleEndian.Uint16(f.data[offset+2*value:]))
+		} else {
+			value = int(f.data[offset+value])
+		}
+	}
+
+	// the values are stored in moves or plys, depending on the table
+	if (wdl == Win && d.flags&flagWinPlies == 0) ||
+		(wdl == Loss && d.flags&flagLossPlies == 0) ||
+		wdl == CursedWin || wdl == BlessedLoss {
+		value *= 2
+	}
+
+	return value + 1
+}
+
+// index calculates the index of the given position in the table file, and
+// returns it, along with the pairs data which contains it and the file of
+// the leading pawn. The position has it's colors flipped relative to the
+// table if flipped is set. If dtz is set, the returned pairs data is nil
+// if the position's side to move isn't stored in the table file.
+func (t *table) index(b *board.Board, f *tableFile, flipped, dtz bool) (*pairsData, int, uint64) {
+	var squares [MaxPieces]int
+	var pieces [MaxPieces]piece.Piece
+
+	// The tables of materials which are the same for both sides only
+	// store the positions with white to move, and the tables are stored
+	// with the stronger side as white, so the colors of the position are
+	// flipped in both cases. This is done by flipping the colors of the
+	// pieces, and mirroring the squares vertically.
+	flip := flipped || (t.symmetric && b.SideToMove == piece.Black)
+
+	var flipColor piece.Piece
+	var flipSquares int
+	stm := int(b.SideToMove)
+	if flip {
+		flipColor, flipSquares = 8, 56
+		stm ^= 1
+	}
+
+	// the pieces are collected in the order of the table's squares
+	occupied := tableBB(b.ColorBBs[piece.White] | b.ColorBBs[piece.Black])
+
+	// The tables with pawns are split into four parts, by the file of
+	// the leading pawn, which is the one with the largest mapPawns value.
+	// It's pawns are the first pieces of every part of the table.
+	size, leadPawns, leadFile := 0, 0, 0
+	if t.hasPawns {
+		leadColor := (f.get(0, 0).pieces[0] ^ flipColor).Color()
+		pawns := tableBB(b.PawnsBB(leadColor))
+		occupied &^= pawns
+
+		for pawns != 0 {
+			squares[size] = bits.TrailingZeros64(pawns) ^ flipSquares
+			pawns &= pawns - 1
+			size++
+		}
+
+		leadPawns = size
+
+		lead := 0
+		for i := 1; i < leadPawns; i++ {
+			if mapPawns[squares[i]] > mapPawns[squares[lead]] {
+				lead = i
+			}
+		}
+
+		squares[0], squares[lead] = squares[lead], squares[0]
+		leadFile = fileOf(squares[0])
+		if leadFile > 3 {
+			leadFile = 7 - leadFile
+		}
+	}
+
+	// dtz tables only store a single side to move, unless both sides
+	// have the same material and no pawns, when the colors are flipped
+	if dtz && f.get(stm, leadFile).flags&flagSTM != uint8(stm) && (!t.symmetric || t.hasPawns) {
+		return nil, 0, 0
+	}
+
+	for occupied != 0 {
+		s := bits.TrailingZeros64(occupied)
+		occupied &= occupied - 1
+
+		squares[size] = s ^ flipSquares
+		pieces[size] = b.Position[square.Square(flipRank(s))] ^ flipColor // board square
+		size++
+	}
+
+	d := f.get(stm, leadFile)
+
+	// reorder the pieces into the table's encoding order
+	for i := leadPawns; i < size-1; i++ {
+		for j := i + 1; j < size; j++ {
+			if d.pieces[i] == pieces[j] {
+				pieces[i], pieces[j] = pieces[j], pieces[i]
+				squares[i], squares[j] = squares[j], squares[i]
+				break
+			}
+		}
+	}
+
+	// mirror the position horizontally so that the leading piece is in
+	// the a-d files
+	if fileOf(squares[0]) > 3 {
+		for i := 0; i < size; i++ {
+			squares[i] = flipFile(squares[i])
+		}
+	}
+
+	var idx uint64
+	if t.hasPawns {
+		// encode the leading pawns, with the other leading pawns in the
+		// order of their mapPawns values
+		idx = leadPawnIdx[leadPawns][squares[0]]
+
+		sortSquares(squares[1:leadPawns], func(s int) int { return mapPawns[s] })
+
+		for i := 1; i < leadPawns; i++ {
+			idx += binomial[i][mapPawns[squares[i]]]
+		}
+	} else {
+		idx = leadingIndex(squares[:size], d.groupLen[0], t.hasUniquePieces)
+	}
+
+	idx *= d.groupIdx[0]
+
+	// Encode the remaining groups, where the pieces in every group are
+	// encoded as a combination of the squares which are not occupied by
+	// the pieces of the previous groups. The other side's pawns, which
+	// are always the second group if present, can't be on the first or
+	// the last rank.
+	remainingPawns := t.hasPawns && t.pawnCount[1] > 0
+	start := d.groupLen[0]
+	for next := 1; d.groupLen[next] != 0; next++ {
+		group := squares[start : start+d.groupLen[next]]
+		sortSquares(group, func(s int) int { return s })
+
+		var n uint64
+		for i, s := range group {
+			adjust := 0
+			for _, previous := range squares[:start] {
+				if s > previous {
+					adjust++
+				}
+			}
+
+			if remainingPawns {
+				adjust += 8
+			}
+
+			n += binomial[i+1][s-adjust]
+		}
+
+		remainingPawns = false
+		idx += n * d.groupIdx[next]
+		start += d.groupLen[next]
+	}
+
+	return d, leadFile, idx
+}
+
+// leadingIndex returns the index of the leading group of pieces, with the
+// given number of pieces, of a position without pawns. The squares are
+// mirrored so that the leading piece is in the a1-d1-d4 triangle.
+func leadingIndex(squares []int, groupLen int, hasUniquePieces bool) uint64 {
+	// mirror the position vertically so that the leading piece is
+	// below the 5th rank
+	if rankOf(squares[0]) > 3 {
+		for i := range squares {
+			squares[i] = flipRank(squares[i])
+		}
+	}
+
+	// mirror the position along the a1-h8 diagonal so that the first
+	// piece of the leading group not on the diagonal is below it
+	for i := 0; i < groupLen; i++ {
+		if offA1H8(squares[i]) == 0 {
+			continue
+		}
+
+		if offA1H8(squares[i]) > 0 {
+			for j := i; j < len(squares); j++ {
+				squares[j] = (squares[j]>>3 | squares[j]<<3) & 63
+			}
+		}
+
+		break
+	}
+
+	// Without three unique pieces, including the kings, only the kings
+	// are in the leading group. They are encoded together, as there are
+	// only 462 legal placements of the kings after the mirroring.
+	if !hasUniquePieces {
+		return uint64(mapKK[mapA1D1D4[squares[0]]][squares[1]])
+	}
+
+	// Otherwise, the three unique pieces are encoded together. Every
+	// square is mapped down if it comes after one of the squares of the
+	// previous pieces, as those squares are not available to it.
+	adjust1 := 0
+	if squares[1] > squares[0] {
+		adjust1 = 1
+	}
+
+	adjust2 := 0
+	if squares[2] > squares[0] {
+		adjust2++
+	}
+
+	if squares[2] > squares[1] {
+		adjust2++
+	}
+
+	switch {
+	case offA1H8(squares[0]) != 0:
+		// first piece below the diagonal, in the b1-d1-d3 triangle
+		return uint64((mapA1D1D4[squares[0]]*63+squares[1]-adjust1)*62 + squares[2] - adjust2)
+
+	case offA1H8(squares[1]) != 0:
+		// first piece on the diagonal, second below it
+		return uint64((6*63+rankOf(squares[0])*28+mapB1H1H7[squares[1]])*62 + squares[2] - adjust2)
+
+	case offA1H8(squares[2]) != 0:
+		// first two pieces on the diagonal, third below it
+		return uint64(6*63*62 + 4*28*62 + rankOf(squares[0])*7*28 +
+			(rankOf(squares[1])-adjust1)*28 + mapB1H1H7[squares[2]])
+
+	default:
+		// all three pieces on the diagonal
+		return uint64(6*63*62 + 4*28*62 + 4*7*28 + rankOf(squares[0])*7*6 +
+			(rankOf(squares[1])-adjust1)*6 + rankOf(squares[2]) - adjust2)
+	}
+}
+
+// tableBB converts the given bitboard into a bitboard of table squares,
+// by mirroring it vertically.
+func tableBB(b bitboard.Board) uint64 {
+	return bits.ReverseBytes64(uint64(b))
+}
@@ -0,0 +1,212 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package syzygy
+
+import (
+	"math/rand"
+	"testing"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+)
+
+func TestDecompress(t *testing.T) {
+	random := rand.New(rand.NewSource(1))
+
+	// random pairs of the previous symbols, which represent at most 256
+	// values, on top of the leaves
+	const leaves, symbols = 5, 300
+	btree := make([][2]int, symbols)
+	expansion := make([][]uint8, symbols)
+	for sym := range btree {
+		if sym < leaves {
+			btree[sym] = [2]int{sym, noSymbol}
+			expansion[sym] = []uint8{uint8(sym)}
+			continue
+		}
+
+		left, right := random.Intn(sym), random.Intn(sym)
+		for len(expansion[left])+len(expansion[right]) > 256 {
+			left, right = random.Intn(leaves), random.Intn(sym)
+		}
+
+		btree[sym] = [2]int{left, right}
+		expansion[sym] = append(append([]uint8(nil), expansion[left]...), expansion[right]...)
+	}
+
+	var stream []int
+	var values []uint8
+	for len(values) < 200000 {
+		sym := random.Intn(symbols)
+		stream = append(stream, sym)
+		values = append(values, expansion[sym]...)
+	}
+
+	e := encodeSymbols(btree, stream, len(values), 0)
+
+	var d pairsData
+	d.groupLen[0], d.groupIdx[1] = 1, uint64(len(values))
+	d.setSizes(e.sizes, 0)
+	d.sparseIndex, d.blockLength, d.data = e.sparseIndex, e.blockLength, e.blocks
+
+	for i, value := range values {
+		if got := d.decompress(uint64(i)); got != int(value) {
+			t.Fatalf("value %d: expected %d, got %d", i, value, got)
+		}
+	}
+}
+
+func TestIndex(t *testing.T) {
+	// the a1-d4 quarter of the board, the 1st and 2nd ranks, and the corners
+	var quarter, ranks []square.Square
+	corners := []square.Square{square.A1, square.H1, square.A8, square.H8}
+	for s := square.Square(0); s < square.N; s++ {
+		if s.File() <= square.FileD && s.Rank() >= square.Rank4 {
+			quarter = append(quarter, s)
+		}
+
+		if s.Rank() >= square.Rank2 {
+			ranks = append(ranks, s)
+		}
+	}
+
+	tests := []struct {
+		name          string
+		first, second material
+		pieces        []piece.Piece
+		limits        [][]square.Square
+	}{
+		{
+			name: "KRvK", first: material{1, 0, 1}, second: material{1},
+			pieces: []piece.Piece{piece.WhiteRook, piece.WhiteKing, piece.BlackKing},
+		},
+		{
+			name: "KNNvK", first: material{1, 0, 0, 0, 2}, second: material{1},
+			pieces: []piece.Piece{piece.WhiteKing, piece.BlackKing, piece.WhiteKnight, piece.WhiteKnight},
+			limits: [][]square.Square{quarter, ranks},
+		},
+		{
+			name: "KPvK", first: material{1, 0, 0, 0, 0, 1}, second: material{1},
+			pieces: []piece.Piece{piece.WhitePawn, piece.WhiteKing, piece.BlackKing},
+		},
+		{
+			name: "KPPvK", first: material{1, 0, 0, 0, 0, 2}, second: material{1},
+			pieces: []piece.Piece{piece.WhitePawn, piece.WhitePawn, piece.WhiteKing, piece.BlackKing},
+			limits: [][]square.Square{nil, nil, quarter, ranks},
+		},
+		{
+			name: "KPvKP", first: material{1, 0, 0, 0, 0, 1}, second: material{1, 0, 0, 0, 0, 1},
+			pieces: []piece.Piece{piece.WhitePawn, piece.BlackPawn, piece.WhiteKing, piece.BlackKing},
+			limits: [][]square.Square{nil, nil, nil, corners},
+		},
+	}
+
+	for _, test := range tests {
+		tb := newTable(test.first, test.second)
+		f := newTestFile(tb, test.pieces)
+
+		// every index must be of a single position, up to symmetry
+		positions := make(map[uint64]uint64)
+
+		b := board.New()
+		forEachPlacement(test.pieces, test.limits, func([]square.Square) {
+			for _, stm := range [...]piece.Color{piece.White, piece.Black} {
+				b.SideToMove = stm
+
+				d, file, idx := tb.index(b, f, false, false)
+				if idx >= d.size() {
+					t.Fatalf("%s: %s: index %d out of range %d", test.name, b.FEN(), idx, d.size())
+				}
+
+				// the side to move is flipped with the colors
+				if tb.symmetric && stm == piece.Black {
+					stm = piece.White
+				}
+
+				key := uint64(stm)<<62 | uint64(file)<<60 | idx
+				position := canonical(b, tb)
+				if other, found := positions[key]; found && other != position {
+					t.Fatalf("%s: %s: index %d shared by different positions", test.name, b.FEN(), idx)
+				}
+
+				positions[key] = position
+			}
+		}, b)
+	}
+}
+
+// canonical returns a key of the position on the given board, which is the
+// same for all the positions which are the same in the given table, due to
+// it's symmetries.
+func canonical(b *board.Board, t *table) uint64 {
+	var pieces [MaxPieces]int
+	n := 0
+
+	occupied := b.ColorBBs[piece.White] | b.ColorBBs[piece.Black]
+	for occupied != 0 {
+		s := occupied.Pop()
+		p, sq := b.Position[s], flipRank(int(s))
+
+		// the colors are flipped with black to move in symmetric tables,
+		// which mirrors the board vertically
+		if t.symmetric && b.SideToMove == piece.Black {
+			p, sq = p^8, int(s)
+		}
+
+		pieces[n] = int(p)<<6 | sq
+		n++
+	}
+
+	// the horizontal mirror, and without pawns the vertical mirror and
+	// the mirror along the a1-h8 diagonal, each set in a bit of symmetry
+	symmetries := 2
+	if !t.hasPawns {
+		symmetries = 8
+	}
+
+	key := ^uint64(0)
+	for symmetry := 0; symmetry < symmetries; symmetry++ {
+		var mirrored [MaxPieces]int
+		for i, p := range pieces[:n] {
+			sq := p & 63
+			if symmetry&1 != 0 {
+				sq = flipFile(sq)
+			}
+
+			if symmetry&2 != 0 {
+				sq = flipRank(sq)
+			}
+
+			if symmetry&4 != 0 {
+				sq = (sq>>3 | sq<<3) & 63
+			}
+
+			mirrored[i] = p&^63 | sq
+		}
+
+		sortSquares(mirrored[:n], func(p int) int { return p })
+
+		var k uint64
+		for _, p := range mirrored[:n] {
+			k = k<<10 | uint64(p)
+		}
+
+		if k < key {
+			key = k
+		}
+	}
+
+	return key
+}
@@ -0,0 +1,39 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/search/tt"
+)
+
+// probeTT probes the transposition table for the current position, and
+// updates the tt stats of the search accordingly.
+func (search *Context) probeTT() (tt.Entry, bool) {
+	entry, hit := search.tt.Probe(search.board.Hash)
+
+	search.stats.TTProbes++
+	search.stats.TTHits += util.Btoi[int](hit)
+
+	return entry, hit
+}
+
+// storeTT stores the given entry into the transposition table, and
+// updates the tt stats of the search accordingly.
+func (search *Context) storeTT(entry tt.Entry) {
+	stored, replaced := search.tt.Store(entry)
+
+	search.stats.TTStores += util.Btoi[int](stored)
+	search.stats.TTReplaces += util.Btoi[int](replaced)
+}
@@ -0,0 +1,211 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import (
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/move/castling"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/search/eval"
+	"laptudirm.com/x/mess/pkg/search/syzygy"
+)
+
+// SetTablebase changes the endgame tablebase probed by the search, which
+// is disabled if the tablebase is nil. The tablebase is shared by all the
+// threads. It should not be called while a search is in progress.
+func (search *Context) SetTablebase(tb *syzygy.Tablebase) {
+	search.tb = tb
+	for _, helper := range search.helpers {
+		helper.tb = tb
+	}
+}
+
+// SetTBProbeLimit changes the maximum number of pieces, including the
+// kings, of the positions which are probed in the tablebase. It should not
+// be called while a search is in progress.
+func (search *Context) SetTBProbeLimit(pieces int) {
+	search.tbLimit = pieces
+	for _, helper := range search.helpers {
+		helper.tbLimit = pieces
+	}
+}
+
+// canProbeTB reports whether the tablebase can be probed for the current
+// position, which is when it has few enough pieces and can't castle. The
+// draw clock isn't considered, so callers should check it if required.
+func (search *Context) canProbeTB() bool {
+	if search.tb == nil || search.board.CastlingRights != castling.NoCasl {
+		return false
+	}
+
+	pieces := (search.board.ColorBBs[piece.White] | search.board.ColorBBs[piece.Black]).Count()
+	return pieces <= search.tbLimit && pieces <= search.tb.MaxPieces()
+}
+
+// probeWDL probes the tablebase for the wdl of the current position, and
+// converts it into an exact score. Since the wdl tables don't consider the
+// draw clock, only positions right after a zeroing move are probed, where
+// the wdl is accurate with the 50-move rule.
+func (search *Context) probeWDL(plys int) (eval.Eval, bool) {
+	if !search.tbProbe || search.board.DrawClock != 0 || !search.canProbeTB() {
+		return 0, false
+	}
+
+	wdl, ok := search.tb.ProbeWDL(search.board)
+	if !ok {
+		return 0, false
+	}
+
+	search.stats.TBHits++
+
+	switch wdl {
+	case syzygy.Win:
+		return eval.TBWin - eval.Eval(plys), true
+	case syzygy.Loss:
+		return -eval.TBWin + eval.Eval(plys), true
+	default:
+		// cursed wins and blessed losses are draws by the 50-move rule
+		return eval.Draw, true
+	}
+}
+
+// maxDTZ is larger than any dtz value, and is used to rank the root moves.
+const maxDTZ = 1 << 18
+
+// wdlRanks are the ranks of the root moves leading to each wdl, plus two,
+// when the dtz tables are not available.
+var wdlRanks = [...]int{-maxDTZ, -maxDTZ + 101, 0, maxDTZ - 101, maxDTZ}
+
+// rootTBMoves ranks the root moves with the tablebase, and returns the
+// moves with the best rank, so that the search doesn't throw away a win,
+// or a draw, by the 50-move rule. Nil is returned if the root position
+// can't be ranked. The reported boolean is false if the positions in the
+// search shouldn't be probed, which is the case when the moves are ranked
+// by their dtz, as all the winning moves have the same wdl score, or when
+// the root position isn't winning.
+func (search *Context) rootTBMoves() ([]move.Move, bool) {
+	if !search.canProbeTB() {
+		return nil, true
+	}
+
+	moves := search.board.GenerateMoves(false)
+	ranks, ok := search.rootDTZRanks(moves)
+	probe := false
+	if !ok {
+		if ranks, ok = search.rootWDLRanks(moves); !ok {
+			return nil, true
+		}
+
+		probe = true
+	}
+
+	best := -maxDTZ
+	for _, rank := range ranks {
+		best = util.Max(best, rank)
+	}
+
+	var filtered []move.Move
+	for i, m := range moves {
+		if ranks[i] == best {
+			filtered = append(filtered, m)
+		}
+	}
+
+	return filtered, probe && best > 0
+}
+
+// rootDTZRanks ranks the given root moves with the dtz tables. Better
+// moves are ranked higher, and the wins which can be converted before the
+// 50-move rule is triggered are ranked equally, as are the losses which
+// can't be saved by the 50-move rule. The reported boolean is false if
+// any of the moves can't be probed.
+func (search *Context) rootDTZRanks(moves []move.Move) ([]int, bool) {
+	drawClock := search.board.DrawClock
+	ranks := make([]int, len(moves))
+
+	for i, m := range moves {
+		search.board.MakeMove(m)
+
+		var dtz int
+		ok := true
+		switch {
+		case search.board.DrawClock == 0:
+			// the dtz of a zeroing move is known from the wdl after it
+			var wdl syzygy.WDL
+			wdl, ok = search.tb.ProbeWDL(search.board)
+			dtz = syzygy.DTZBeforeZeroing(-wdl)
+		case search.board.IsDraw():
+			dtz = 0
+		default:
+			// convert the opponent's dtz into ours, including this move
+			dtz, ok = search.tb.ProbeDTZ(search.board)
+			switch {
+			case dtz > 0:
+				dtz = -dtz - 1
+			case dtz < 0:
+				dtz = -dtz + 1
+			}
+		}
+
+		// a checkmate is the fastest possible win
+		if dtz == 2 && search.board.IsInCheck(search.board.SideToMove) &&
+			len(search.board.GenerateMoves(false)) == 0 {
+			dtz = 1
+		}
+
+		search.board.UnmakeMove()
+
+		if !ok {
+			return nil, false
+		}
+
+		search.stats.TBHits++
+
+		switch {
+		case dtz > 0 && dtz+drawClock <= 99:
+			ranks[i] = maxDTZ
+		case dtz > 0:
+			ranks[i] = maxDTZ - (dtz + drawClock)
+		case dtz < 0 && -dtz*2+drawClock < 100:
+			ranks[i] = -maxDTZ
+		case dtz < 0:
+			ranks[i] = -maxDTZ + (-dtz + drawClock)
+		}
+	}
+
+	return ranks, true
+}
+
+// rootWDLRanks ranks the given root moves with the wdl tables, which is
+// used when the dtz tables are not available. The reported boolean is
+// false if any of the moves can't be probed.
+func (search *Context) rootWDLRanks(moves []move.Move) ([]int, bool) {
+	ranks := make([]int, len(moves))
+
+	for i, m := range moves {
+		search.board.MakeMove(m)
+		wdl, ok := search.tb.ProbeWDL(search.board)
+		search.board.UnmakeMove()
+
+		if !ok {
+			return nil, false
+		}
+
+		search.stats.TBHits++
+		ranks[i] = wdlRanks[-wdl+2]
+	}
+
+	return ranks, true
+}
@@ -0,0 +1,127 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package search
+
+import "laptudirm.com/x/mess/internal/util"
+
+// SetThreads sets the number of threads used while searching. The main
+// thread is included in the count, so threads - 1 helper threads are
+// created. The helper threads implement Lazy SMP: each of them has its
+// own board, move ordering tables, and stats, while the transposition
+// table and the stop signal are shared with the main thread. It should not
+// be called while a search is in progress.
+// https://www.chessprogramming.org/Lazy_SMP
+func (search *Context) SetThreads(threads int) {
+	helpers := util.Max(threads, 1) - 1
+
+	// remove any extra helper threads
+	if helpers < len(search.helpers) {
+		search.helpers = search.helpers[:helpers]
+	}
+
+	// create any missing helper threads
+	for thread := len(search.helpers) + 1; thread <= helpers; thread++ {
+		chessboard, evaluator := newBoard(search.newEvaluator)
+		search.helpers = append(search.helpers, &Context{
+			thread: thread,
+
+			board:     chessboard,
+			evaluator: evaluator,
+
+			// shared state
+			tt:      search.tt,
+			stopped: search.stopped,
+
+			tb:      search.tb,
+			tbLimit: search.tbLimit,
+		})
+	}
+}
+
+// startHelpers starts all the helper threads on the main thread's position.
+// The helpers search without any limits of their own, and run until they
+// are stopped by the main thread.
+func (search *Context) startHelpers() {
+	for _, helper := range search.helpers {
+		// copy the position, with it's history for repetitions
+		helper.board.Copy(search.board)
+
+		helper.pv.Clear()
+		helper.initLines(1)
+		helper.stats = Stats{SearchStart: search.stats.SearchStart}
+		helper.nodes.Store(0)
+		helper.tbHits.Store(0)
+		helper.sideToMove = search.sideToMove
+
+		helper.limits = Limits{
+			Depth:    search.limits.Depth,
+			Moves:    search.limits.Moves,
+			Infinite: true, // stopped by the main thread
+		}
+		helper.rootMoves = search.rootMoves
+		helper.tbProbe = search.tbProbe
+
+		search.running.Add(1)
+		go func(helper *Context) {
+			defer search.running.Done()
+			helper.iterativeDeepening()
+		}(helper)
+	}
+}
+
+// isMainThread reports whether the context is of the main search thread.
+func (search *Context) isMainThread() bool {
+	return search.thread == 0
+}
+
+// totalNodes returns the number of nodes searched by all the threads. The
+// helper threads' node counts are only published periodically, so the
+// value returned may be slightly lower than the actual value.
+func (search *Context) totalNodes() int {
+	nodes := search.stats.Nodes
+	for _, helper := range search.helpers {
+		nodes += int(helper.nodes.Load())
+	}
+
+	return nodes
+}
+
+// totalTBHits returns the number of tablebase hits of all the threads,
+// with the helper threads' counts published alongside their node counts.
+func (search *Context) totalTBHits() int {
+	hits := search.stats.TBHits
+	for _, helper := range search.helpers {
+		hits += int(helper.tbHits.Load())
+	}
+
+	return hits
+}
+
+// skip sizes and phases for each helper thread, which are used to stagger
+// the depths searched by the helper threads
+var skipSize = [...]int{1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4}
+var skipPhase = [...]int{0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7}
+
+// skipDepth reports whether the given iterative deepening depth should be
+// skipped by the current thread. The depths searched by the helper threads
+// are staggered so that all the threads aren't searching the same depth.
+func (search *Context) skipDepth(depth int) bool {
+	if search.isMainThread() {
+		// main thread searches every depth
+		return false
+	}
+
+	i := (search.thread - 1) % len(skipSize)
+	return ((depth+skipPhase[i])/skipSize[i])%2 != 0
+}
@@ -0,0 +1,59 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tt
+
+import (
+	"fmt"
+	"strings"
+)
+
+// Allocation represents a method of allocating the memory of a tt.
+type Allocation int
+
+// constants representing the various tt allocation methods
+const (
+	// memory is allocated by the go runtime
+	HeapAllocation Allocation = iota
+
+	// memory is mapped directly and backed by transparent huge pages,
+	// which reduces the tlb misses caused by random tt accesses
+	HugePageAllocation
+
+	// memory is backed by huge pages which are interleaved across all
+	// the numa nodes, so that no single node's memory bus is saturated
+	InterleavedAllocation
+)
+
+// Allocations contains the names of all the allocation methods.
+var Allocations = []string{
+	HeapAllocation:        "Heap",
+	HugePageAllocation:    "HugePages",
+	InterleavedAllocation: "Interleaved",
+}
+
+// NewAllocation parses the given name of an allocation method.
+func NewAllocation(name string) (Allocation, error) {
+	for allocation, allocationName := range Allocations {
+		if strings.EqualFold(name, allocationName) {
+			return Allocation(allocation), nil
+		}
+	}
+
+	return HeapAllocation, fmt.Errorf("new allocation: unknown allocation %q", name)
+}
+
+// String converts the given allocation into it's name.
+func (allocation Allocation) String() string {
+	return Allocations[allocation]
+}
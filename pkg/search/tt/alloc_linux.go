@@ -0,0 +1,136 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//go:build linux
+
+package tt
+
+import (
+	"math/bits"
+	"os"
+	"strconv"
+	"strings"
+	"syscall"
+	"unsafe"
+)
+
+// size of a transparent huge page; the memory is aligned to this size so
+// that the kernel is able to back all of it with huge pages
+const hugePageSize = 2 * 1024 * 1024
+
+// allocate allocates memory for the given number of buckets using the
+// given allocation method. It returns the buckets, and the underlying
+// memory mapping which needs to be released, if any.
+func allocate(size int, allocation Allocation) ([]bucket, []byte, error) {
+	if allocation == HeapAllocation || size == 0 {
+		return make([]bucket, size), nil, nil
+	}
+
+	// map an extra huge page to align the buckets
+	length := size*BucketSize + hugePageSize
+	memory, err := syscall.Mmap(
+		-1, 0, length,
+		syscall.PROT_READ|syscall.PROT_WRITE,
+		syscall.MAP_PRIVATE|syscall.MAP_ANONYMOUS,
+	)
+	if err != nil {
+		return nil, nil, err
+	}
+
+	// align the start of the buckets to a huge page
+	offset := 0
+	if rem := int(uintptr(unsafe.Pointer(&memory[0])) % hugePageSize); rem != 0 {
+		offset = hugePageSize - rem
+	}
+
+	region := memory[offset : offset+size*BucketSize]
+
+	// ask for transparent huge pages; the kernel may not support them, in
+	// which case the memory is backed by regular pages and still usable
+	_ = syscall.Madvise(region, syscall.MADV_HUGEPAGE)
+
+	if allocation == InterleavedAllocation {
+		if err := interleave(region); err != nil {
+			_ = syscall.Munmap(memory)
+			return nil, nil, err
+		}
+	}
+
+	return unsafe.Slice((*bucket)(unsafe.Pointer(&region[0])), size), memory, nil
+}
+
+// release releases the given memory mapping returned by allocate.
+func release(memory []byte) {
+	if memory != nil {
+		_ = syscall.Munmap(memory)
+	}
+}
+
+// memory policy which interleaves pages across nodes
+const mpolInterleave = 3
+
+// interleave sets the memory policy of the given memory region so that
+// it's pages are interleaved across all the online numa nodes.
+func interleave(region []byte) error {
+	nodes, err := onlineNodes()
+	if err != nil || bits.OnesCount64(nodes) <= 1 {
+		// not a numa system, nothing to interleave
+		return nil
+	}
+
+	_, _, errno := syscall.Syscall6(
+		syscall.SYS_MBIND,
+		uintptr(unsafe.Pointer(&region[0])), uintptr(len(region)),
+		mpolInterleave, uintptr(unsafe.Pointer(&nodes)), 64+1, 0,
+	)
+
+	if errno != 0 {
+		return errno
+	}
+
+	return nil
+}
+
+// onlineNodes returns a mask of the online numa nodes, parsed from sysfs.
+// Nodes which don't fit into the mask are ignored.
+func onlineNodes() (uint64, error) {
+	data, err := os.ReadFile("/sys/devices/system/node/online")
+	if err != nil {
+		return 0, err
+	}
+
+	// the node list looks like "0-3,5,7-8"
+	var nodes uint64
+	for _, nodeRange := range strings.Split(strings.TrimSpace(string(data)), ",") {
+		first, last, found := strings.Cut(nodeRange, "-")
+		if !found {
+			last = first
+		}
+
+		start, err := strconv.Atoi(first)
+		if err != nil {
+			return 0, err
+		}
+
+		end, err := strconv.Atoi(last)
+		if err != nil {
+			return 0, err
+		}
+
+		for node := start; node <= end && node < 64; node++ {
+			nodes |= 1 << node
+		}
+	}
+
+	return nodes, nil
+}
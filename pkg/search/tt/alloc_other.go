@@ -0,0 +1,26 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//go:build !linux
+
+package tt
+
+// allocate allocates memory for the given number of buckets. Only heap
+// allocations are supported outside linux, so the allocation method is
+// ignored and the go runtime's memory is always used.
+func allocate(size int, _ Allocation) ([]bucket, []byte, error) {
+	return make([]bucket, size), nil, nil
+}
+
+// release releases the given memory mapping returned by allocate.
+func release([]byte) {}
@@ -0,0 +1,176 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tt
+
+import (
+	"math"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+	"laptudirm.com/x/mess/pkg/search/eval"
+)
+
+// Entry represents a transposition table entry.
+type Entry struct {
+	// complete hash of the position; to guard against
+	// transposition table key collisions
+	Hash zobrist.Key
+
+	// best move in the position
+	// used during iterative deepening as pv move
+	Move move.Move
+
+	// evaluation info
+	Value Eval      // value of this position
+	Type  EntryType // bound type of the value
+
+	// entry metadata
+	Depth uint8 // depth the position was searched to
+	epoch uint8 // epoch/age of the entry from creation
+}
+
+// quality returns a quality measure of the given tt entry which will be
+// used to determine whether a tt entry should be overwritten or not.
+func (entry *Entry) quality() uint8 {
+	return entry.epoch + entry.Depth/3
+}
+
+// layout of a packed tt entry's data word
+const (
+	moveWidth  = 21
+	valueWidth = 16
+	depthWidth = 8
+	typeWidth  = 2
+	epochWidth = 8
+
+	moveOffset  = 0
+	valueOffset = moveOffset + moveWidth
+	depthOffset = valueOffset + valueWidth
+	typeOffset  = depthOffset + depthWidth
+	epochOffset = typeOffset + typeWidth
+
+	moveMask  = (1 << moveWidth) - 1
+	valueMask = (1 << valueWidth) - 1
+	depthMask = (1 << depthWidth) - 1
+	typeMask  = (1 << typeWidth) - 1
+	epochMask = (1 << epochWidth) - 1
+)
+
+// pack packs the given entry's data, everything except the hash, into a
+// single 64-bit word which can be stored atomically.
+func (entry *Entry) pack() uint64 {
+	data := uint64(entry.Move) << moveOffset
+	data |= uint64(uint16(entry.Value.pack())) << valueOffset
+	data |= uint64(entry.Depth) << depthOffset
+	data |= uint64(entry.Type) << typeOffset
+	data |= uint64(entry.epoch) << epochOffset
+	return data
+}
+
+// unpack unpacks the given data word into an entry of the given hash.
+func unpack(hash zobrist.Key, data uint64) Entry {
+	return Entry{
+		Hash:  hash,
+		Move:  move.Move((data >> moveOffset) & moveMask),
+		Value: unpackEval(int16((data >> valueOffset) & valueMask)),
+		Type:  EntryType((data >> typeOffset) & typeMask),
+		Depth: uint8((data >> depthOffset) & depthMask),
+		epoch: uint8((data >> epochOffset) & epochMask),
+	}
+}
+
+// EntryType represents the type of a transposition table entry's
+// value, whether it exists, it is upper bound, lower bound, or exact.
+type EntryType uint8
+
+// constants representing various transposition table entry types
+const (
+	NoEntry EntryType = iota // no entry exists
+
+	ExactEntry // the value is an exact score
+	LowerBound // the value is a lower bound on the exact score
+	UpperBound // the value is an upper bound on the exact score
+)
+
+// EvalFrom converts a given mate score from "n plys till mate from root"
+// to "n plys till mate from current position" so that it is reusable in
+// other positions with greater or lesser depth. Tablebase wins and losses
+// are converted in the same way.
+func EvalFrom(score eval.Eval, plys int) Eval {
+	switch {
+	case score > eval.TBWinInMaxPly:
+		score += eval.Eval(plys)
+	case score < eval.TBLossInMaxPly:
+		score -= eval.Eval(plys)
+	}
+
+	return Eval(score)
+}
+
+// Eval represents the evaluation of a transposition table entry. For mate
+// scores, it stores "n plys till mate from current position" instead of the
+// standard "n plys till mate from root" used in search.
+type Eval eval.Eval
+
+// Eval converts transposition table entry scores from "n plys to mate
+// from current position" to "n plys till mate from root" which is the
+// format used during search.
+func (e Eval) Eval(plys int) eval.Eval {
+	score := eval.Eval(e)
+
+	// checkmate scores need to be changed from
+	switch {
+	case score > eval.TBWinInMaxPly:
+		score -= eval.Eval(plys)
+	case score < eval.TBLossInMaxPly:
+		score += eval.Eval(plys)
+	}
+
+	return score
+}
+
+// limits of packed evaluations: regular evaluations are packed as is into
+// [-packedWin, packedWin], while mate scores are packed as their distance
+// from packedMate, so that they fit in (packedWin, packedMate].
+const (
+	packedMate = math.MaxInt16
+	packedWin  = packedMate - int16(eval.Mate-eval.WinInMaxPly)
+)
+
+// pack packs the given tt evaluation into 16 bits.
+func (e Eval) pack() int16 {
+	score := eval.Eval(e)
+
+	switch {
+	case score > eval.WinInMaxPly:
+		return packedMate - int16(util.Max(eval.Mate-score, 0))
+	case score < eval.LoseInMaxPly:
+		return -packedMate + int16(util.Max(eval.Mate+score, 0))
+	default:
+		return int16(util.Clamp(score, eval.Eval(-packedWin), eval.Eval(packedWin)))
+	}
+}
+
+// unpackEval unpacks a tt evaluation packed by Eval.pack.
+func unpackEval(packed int16) Eval {
+	switch {
+	case packed > packedWin:
+		return Eval(eval.Mate - eval.Eval(packedMate-packed))
+	case packed < -packedWin:
+		return Eval(-eval.Mate + eval.Eval(packedMate+packed))
+	default:
+		return Eval(packed)
+	}
+}
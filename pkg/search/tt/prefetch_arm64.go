@@ -0,0 +1,23 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tt
+
+import "unsafe"
+
+// prefetch executes the prfm pldl1keep instruction, which hints the cpu to
+// load the cache line containing the given address into the l1 cache and
+// keep it there.
+//
+//go:noescape
+func prefetch(address unsafe.Pointer)
@@ -0,0 +1,32 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tt
+
+import "testing"
+
+func TestTornSlot(t *testing.T) {
+	a := Entry{Hash: 0x9d39247e33776d41, Value: 35, Type: ExactEntry, Depth: 12}
+	b := Entry{Hash: 0x9d39247e33776d42, Value: -80, Type: LowerBound, Depth: 3}
+
+	// the key of one entry and the data of another, from racing stores
+	var torn slot
+	torn.store(a)
+	torn.data.Store(b.pack())
+
+	for _, hash := range []uint64{uint64(a.Hash), uint64(b.Hash)} {
+		if entry, _ := torn.load(); uint64(entry.Hash) == hash {
+			t.Errorf("load: torn slot verified as %#x", hash)
+		}
+	}
+}
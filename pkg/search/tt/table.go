@@ -18,37 +18,93 @@ package tt
 
 import (
 	"math/bits"
+	"runtime"
+	"sync"
+	"sync/atomic"
 	"unsafe"
 
-	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/internal/util"
 	"laptudirm.com/x/mess/pkg/board/zobrist"
-	"laptudirm.com/x/mess/pkg/search/eval"
 )
 
-// EntrySize stores the size in bytes of a tt entry.
-var EntrySize = int(unsafe.Sizeof(Entry{}))
+// BucketSize stores the size in bytes of a tt bucket.
+var BucketSize = int(unsafe.Sizeof(bucket{}))
 
 // NewTable creates a new transposition table with a size equal to or
 // less than the given number of megabytes.
 func NewTable(mbs int) *Table {
-	// compute table size (number of entries)
-	size := (mbs * 1024 * 1024) / EntrySize
+	// compute table size (number of buckets)
+	size := (mbs * 1024 * 1024) / BucketSize
 
 	return &Table{
-		table: make([]Entry, size),
+		table: make([]bucket, size),
 		size:  size,
 	}
 }
 
-// Table represents a transposition table.
+// Table represents a transposition table. The table is made up of cache
+// line sized buckets, each of which contains multiple entries. A given
+// position maps to a single bucket, and may be stored in any of it's
+// entries. The table doesn't use any locks, and is safe to be used by
+// multiple threads at the same time; see slot for details.
 type Table struct {
-	table []Entry // hash table
-	size  int     // table size
-	epoch uint8   // table epoch
+	table []bucket // hash table
+	size  int      // table size
+	epoch uint8    // table epoch
+
+	// memory allocation
+	allocation Allocation // allocation method
+	memory     []byte     // memory mapping backing table, if any
+}
+
+// number of entries in a single tt bucket
+const bucketEntries = 4
+
+// bucket represents a single tt bucket, which fills a cache line.
+type bucket [bucketEntries]slot
+
+// slot is the storage of a single tt entry. The entry is stored packed
+// into a single atomic data word. It's hash is stored xor-ed with that
+// data, so that a torn entry, whose key and data words are from writes
+// by different threads, fails the hash check and is treated as a miss.
+// https://www.chessprogramming.org/Shared_Hash_Table#Lock-less
+type slot struct {
+	key  atomic.Uint64 // hash ^ data
+	data atomic.Uint64 // packed entry data
+}
+
+// load atomically loads the entry stored in the given slot.
+func (slot *slot) load() (Entry, bool) {
+	data := slot.data.Load()
+	hash := zobrist.Key(slot.key.Load() ^ data)
+	return unpack(hash, data), data != 0
 }
 
+// store atomically stores the given entry in the given slot.
+func (slot *slot) store(entry Entry) {
+	data := entry.pack()
+	slot.data.Store(data)
+	slot.key.Store(uint64(entry.Hash) ^ data)
+}
+
+// Clear clears all the entries in the given tt. Large tables are cleared
+// in parallel, with each cpu clearing a contiguous chunk of the table.
 func (tt *Table) Clear() {
-	clear(tt.table)
+	const minChunkSize = 1024 * 1024 / bucketEntries // buckets
+
+	chunks := util.Clamp(tt.size/minChunkSize, 1, runtime.NumCPU())
+	chunkSize := (tt.size + chunks - 1) / chunks
+
+	var group sync.WaitGroup
+	for start := 0; start < tt.size; start += chunkSize {
+		group.Add(1)
+		go func(chunk []bucket) {
+			defer group.Done()
+			clear(chunk)
+		}(tt.table[start:util.Min(start+chunkSize, tt.size)])
+	}
+
+	group.Wait()
 }
 
 // NextEpoch increases the epoch number of the given tt.
@@ -56,35 +112,109 @@ func (tt *Table) NextEpoch() {
 	tt.epoch++
 }
 
-// Resize resizes the given transposition table to the new size. The
-// entries are copied from the old table to the new one. If the new table
-// is smaller, some entries are discarded.
-func (tt *Table) Resize(mbs int) {
-	// compute new table size (number of entries)
-	size := (mbs * 1024 * 1024) / EntrySize
+// Resize resizes the given transposition table to the new size. The old
+// entries are discarded, since the bucket of each position depends on the
+// size of the table. If the table's allocation method fails, the memory
+// is allocated from the heap instead, and the error is returned.
+func (tt *Table) Resize(mbs int) error {
+	// compute new table size (number of buckets)
+	size := (mbs * 1024 * 1024) / BucketSize
+	return tt.reallocate(size, tt.allocation)
+}
 
-	// create table with new size
-	newTable := make([]Entry, size)
+// SetAllocation changes the memory allocation method used by the given
+// transposition table, and reallocates the table using it. As with Resize
+// the old entries are discarded, and the heap is used on errors.
+func (tt *Table) SetAllocation(allocation Allocation) error {
+	return tt.reallocate(tt.size, allocation)
+}
 
-	// copy old elements
-	copy(newTable, tt.table)
+// reallocate replaces the given table's memory with a new allocation of the
+// given size which uses the given allocation method.
+func (tt *Table) reallocate(size int, allocation Allocation) error {
+	// release old memory before allocating the new table
+	release(tt.memory)
+	*tt = Table{}
+
+	table, memory, err := allocate(size, allocation)
+	if err != nil {
+		table, memory = make([]bucket, size), nil
+		allocation = HeapAllocation
+	}
 
-	// replace old table
 	*tt = Table{
-		table: newTable,
+		table: table,
 		size:  size,
+
+		allocation: allocation,
+		memory:     memory,
+	}
+
+	if memory != nil {
+		// the mapped memory is already zeroed, but clearing it faults in
+		// the pages in parallel instead of during the search
+		tt.Clear()
 	}
+
+	return err
 }
 
-// Store puts the given data into the transposition table.
-func (tt *Table) Store(entry Entry) {
-	target := tt.fetch(entry.Hash)
+// Store puts the given data into the transposition table. The entry is
+// stored in the slot which already has the same position, or otherwise
+// in the slot with the lowest quality in the position's bucket. It reports
+// whether the entry was stored, and if it replaced a different position.
+func (tt *Table) Store(entry Entry) (stored, replaced bool) {
 	entry.epoch = tt.epoch
 
+	bucket := tt.fetch(entry.Hash)
+
+	target := &bucket[0]
+	targetEntry, targetFull := target.load()
+
+	for i := range bucket {
+		old, full := bucket[i].load()
+		if old.Hash == entry.Hash {
+			// same position, replace it
+			target, targetEntry, targetFull = &bucket[i], old, full
+			break
+		}
+
+		if old.quality() < targetEntry.quality() {
+			target, targetEntry, targetFull = &bucket[i], old, full
+		}
+	}
+
 	// replace only if the new data has an equal or higher quality.
-	if entry.quality() >= target.quality() {
-		*target = entry
+	if entry.quality() < targetEntry.quality() {
+		return false, false
+	}
+
+	target.store(entry)
+	return true, targetFull && targetEntry.Hash != entry.Hash
+}
+
+// Hashfull returns an estimate of the fraction of the table which is in
+// use by the current search, calculated by sampling a fixed number of the
+// table's first entries, so that it is cheap enough to call often.
+func (tt *Table) Hashfull() float64 {
+	const sampleSize = 1000 // entries
+
+	buckets := tt.table[:util.Min(sampleSize/bucketEntries, tt.size)]
+	if len(buckets) == 0 {
+		return 0
 	}
+
+	full := 0
+	for i := range buckets {
+		for j := range buckets[i] {
+			entry, _ := buckets[i][j].load()
+			if entry.Type != NoEntry && entry.epoch == tt.epoch {
+				full++
+			}
+		}
+	}
+
+	return float64(full) / float64(len(buckets)*bucketEntries)
 }
 
 // Probe fetches the data associated with the given zobrist key from the
@@ -92,12 +222,25 @@ func (tt *Table) Store(entry Entry) {
 // usable or not. It guards against hash collisions and empty entries.
 // If the bool value is false, the entry should not be use for anything.
 func (tt *Table) Probe(hash zobrist.Key) (Entry, bool) {
-	entry := *tt.fetch(hash)
-	return entry, entry.Type != NoEntry && entry.Hash == hash
+	bucket := tt.fetch(hash)
+	for i := range bucket {
+		if entry, ok := bucket[i].load(); ok && entry.Hash == hash {
+			return entry, entry.Type != NoEntry
+		}
+	}
+
+	return Entry{}, false
+}
+
+// Prefetch hints the cpu to load the bucket of the given zobrist key into
+// the cache. It is called with the key of a position some time before the
+// position is probed, so that the memory access latency is hidden.
+func (tt *Table) Prefetch(hash zobrist.Key) {
+	prefetch(unsafe.Pointer(tt.fetch(hash)))
 }
 
-// fetch returns a pointer pointing to the tt entry of the given hash.
-func (tt *Table) fetch(hash zobrist.Key) *Entry {
+// fetch returns a pointer pointing to the tt bucket of the given hash.
+func (tt *Table) fetch(hash zobrist.Key) *bucket {
 	return &tt.table[tt.indexOf(hash)]
 }
 
@@ -108,77 +251,3 @@ func (tt *Table) indexOf(hash zobrist.Key) uint {
 	index, _ := bits.Mul(uint(hash), uint(tt.size))
 	return index
 }
-
-// Entry represents a transposition table entry.
-type Entry struct {
-	// complete hash of the position; to guard against
-	// transposition table key collisions
-	Hash zobrist.Key
-
-	// best move in the position
-	// used during iterative deepening as pv move
-	Move move.Move
-
-	// evaluation info
-	Value Eval      // value of this position
-	Type  EntryType // bound type of the value
-
-	// entry metadata
-	Depth uint8 // depth the position was searched to
-	epoch uint8 // epoch/age of the entry from creation
-}
-
-// quality returns a quality measure of the given tt entry which will be
-// used to determine whether a tt entry should be overwritten or not.
-func (entry *Entry) quality() uint8 {
-	return entry.epoch + entry.Depth/3
-}
-
-// EntryType represents the type of a transposition table entry's
-// value, whether it exists, it is upper bound, lower bound, or exact.
-type EntryType uint8
-
-// constants representing various transposition table entry types
-const (
-	NoEntry EntryType = iota // no entry exists
-
-	ExactEntry // the value is an exact score
-	LowerBound // the value is a lower bound on the exact score
-	UpperBound // the value is an upper bound on the exact score
-)
-
-// EvalFrom converts a given mate score from "n plys till mate from root"
-// to "n plys till mate from current position" so that it is reusable in
-// other positions with greater or lesser depth.
-func EvalFrom(score eval.Eval, plys int) Eval {
-	switch {
-	case score > eval.WinInMaxPly:
-		score += eval.Eval(plys)
-	case score < eval.LoseInMaxPly:
-		score -= eval.Eval(plys)
-	}
-
-	return Eval(score)
-}
-
-// Eval represents the evaluation of a transposition table entry. For mate
-// scores, it stores "n plys till mate from current position" instead of the
-// standard "n plys till mate from root" used in search.
-type Eval eval.Eval
-
-// Eval converts transposition table entry scores from "n plys to mate
-// from current position" to "n plys till mate from root" which is the
-// format used during search.
-func (e Eval) Eval(plys int) eval.Eval {
-	score := eval.Eval(e)
-
-	// checkmate scores need to be changed from
-	switch {
-	case score > eval.WinInMaxPly:
-		score -= eval.Eval(plys)
-	case score < eval.LoseInMaxPly:
-		score += eval.Eval(plys)
-	}
-
-	return score
-}
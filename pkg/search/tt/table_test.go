@@ -0,0 +1,293 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tt_test
+
+import (
+	"math/rand"
+	"sync"
+	"sync/atomic"
+	"testing"
+
+	"laptudirm.com/x/mess/internal/bench"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/zobrist"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search/eval"
+	"laptudirm.com/x/mess/pkg/search/tt"
+)
+
+// bucketKey is a key whose bucket, like those of the keys which only
+// differ from it in their low bits, is the first one of any table.
+const bucketKey zobrist.Key = 1 << 40
+
+func TestRoundTrip(t *testing.T) {
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	entries := []tt.Entry{
+		{Hash: 0x9d39247e33776d41, Move: move.Move(0x1ab3c), Value: 35, Type: tt.ExactEntry, Depth: 12},
+		{Hash: 0x2af7398005aaa5c7, Move: move.Null, Value: -1200, Type: tt.LowerBound, Depth: 255},
+		{Hash: 0x44db015024623547, Move: move.Move(0x1fffff), Value: tt.EvalFrom(eval.MateIn(7), 3), Type: tt.UpperBound, Depth: 1},
+		{Hash: 0x9c15f73e62a76ae2, Move: move.Move(0x00101), Value: tt.EvalFrom(-eval.MateIn(4), 2), Type: tt.ExactEntry, Depth: 0},
+	}
+
+	for _, entry := range entries {
+		if stored, _ := table.Store(entry); !stored {
+			t.Fatalf("store %#x: entry not stored in an empty table", entry.Hash)
+		}
+	}
+
+	for _, want := range entries {
+		got, hit := table.Probe(want.Hash)
+		if !hit {
+			t.Errorf("probe %#x: miss, want hit", want.Hash)
+			continue
+		}
+
+		if got.Hash != want.Hash || got.Move != want.Move || got.Value != want.Value || got.Type != want.Type || got.Depth != want.Depth {
+			t.Errorf("probe %#x: got %+v, want %+v", want.Hash, got, want)
+		}
+	}
+}
+
+func TestCollision(t *testing.T) {
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	table.Store(tt.Entry{Hash: bucketKey, Value: 100, Type: tt.ExactEntry, Depth: 8})
+
+	// a different position in the same bucket shouldn't get the entry
+	if entry, hit := table.Probe(bucketKey ^ 1); hit {
+		t.Fatalf("probe %#x: hit entry %+v of a different position", bucketKey^1, entry)
+	}
+
+	if _, hit := table.Probe(bucketKey); !hit {
+		t.Fatalf("probe %#x: miss, want hit", bucketKey)
+	}
+}
+
+func TestReplaceShallow(t *testing.T) {
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	// fill the bucket, with one entry much shallower than the others
+	depths := [4]uint8{20, 2, 20, 20}
+	for i, depth := range depths {
+		table.Store(tt.Entry{Hash: bucketKey + zobrist.Key(i), Type: tt.ExactEntry, Depth: depth})
+	}
+
+	stored, replaced := table.Store(tt.Entry{Hash: bucketKey + 4, Type: tt.ExactEntry, Depth: 10})
+	if !stored || !replaced {
+		t.Fatalf("store: got stored %t replaced %t, want both", stored, replaced)
+	}
+
+	for i := range depths {
+		if _, hit := table.Probe(bucketKey + zobrist.Key(i)); hit != (i != 1) {
+			t.Errorf("probe depth %d entry: got hit %t, want %t", depths[i], hit, i != 1)
+		}
+	}
+
+	// a shallower entry shouldn't replace the deeper ones
+	if stored, _ := table.Store(tt.Entry{Hash: bucketKey + 5, Type: tt.ExactEntry, Depth: 0}); stored {
+		t.Error("store: depth 0 entry replaced a deeper entry of the same epoch")
+	}
+}
+
+func TestReplaceOld(t *testing.T) {
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	for i := 0; i < 4; i++ {
+		table.Store(tt.Entry{Hash: bucketKey + zobrist.Key(i), Type: tt.ExactEntry, Depth: 9})
+	}
+
+	// a few searches later, all but one of the entries are used again
+	for i := 0; i < 4; i++ {
+		table.NextEpoch()
+	}
+
+	for i := 1; i < 4; i++ {
+		table.Store(tt.Entry{Hash: bucketKey + zobrist.Key(i), Type: tt.ExactEntry, Depth: 9})
+	}
+
+	// the new entry should replace the old one, even though it's shallower
+	if stored, replaced := table.Store(tt.Entry{Hash: bucketKey + 4, Type: tt.ExactEntry, Depth: 1}); !stored || !replaced {
+		t.Fatalf("store: got stored %t replaced %t, want both", stored, replaced)
+	}
+
+	for i := 0; i < 5; i++ {
+		if _, hit := table.Probe(bucketKey + zobrist.Key(i)); hit != (i != 0) {
+			t.Errorf("probe entry %d: got hit %t, want %t", i, hit, i != 0)
+		}
+	}
+}
+
+func TestHashfull(t *testing.T) {
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	if hashfull := table.Hashfull(); hashfull != 0 {
+		t.Fatalf("hashfull: got %f for an empty table, want 0", hashfull)
+	}
+
+	// store many more entries than the table can hold
+	random := rand.New(rand.NewSource(1))
+	for i := 0; i < 8*(1024*1024/tt.BucketSize)*4; i++ {
+		table.Store(tt.Entry{Hash: zobrist.Key(random.Uint64()), Type: tt.ExactEntry, Depth: 4})
+	}
+
+	if hashfull := table.Hashfull(); hashfull < 0.95 {
+		t.Errorf("hashfull: got %f for a full table, want at least 0.95", hashfull)
+	}
+
+	// the entries of previous searches aren't counted
+	table.NextEpoch()
+	if hashfull := table.Hashfull(); hashfull != 0 {
+		t.Errorf("hashfull: got %f in a new epoch, want 0", hashfull)
+	}
+}
+
+func TestClear(t *testing.T) {
+	table, keys := benchTable()
+	table.NextEpoch()
+
+	for _, key := range keys {
+		table.Store(tt.Entry{Hash: key, Type: tt.ExactEntry, Depth: 1})
+	}
+
+	table.Clear()
+
+	for _, key := range keys {
+		if entry, hit := table.Probe(key); hit {
+			t.Fatalf("probe %#x: hit %+v after clear", key, entry)
+		}
+	}
+
+	if hashfull := table.Hashfull(); hashfull != 0 {
+		t.Errorf("hashfull: got %f after clear, want 0", hashfull)
+	}
+}
+
+// concurrentEntry returns the entry stored for the given key by
+// TestConcurrent, whose data is derived from the key.
+func concurrentEntry(key zobrist.Key) tt.Entry {
+	return tt.Entry{
+		Hash:  key,
+		Move:  move.Move(key >> 43),
+		Value: tt.Eval(int16(key>>16) % 10000),
+		Type:  tt.EntryType(key%3) + tt.ExactEntry,
+		Depth: uint8(key >> 8),
+	}
+}
+
+func TestConcurrent(t *testing.T) {
+	const threads = 8
+
+	table := tt.NewTable(1)
+	table.NextEpoch()
+
+	// keys in the first bucket, so that the threads keep writing to the
+	// same slots and tear each other's entries
+	keys := make([]zobrist.Key, 256)
+	random := rand.New(rand.NewSource(1))
+	for i := range keys {
+		keys[i] = bucketKey ^ zobrist.Key(random.Uint64()>>40)
+	}
+
+	var wg sync.WaitGroup
+	var hits atomic.Int64
+	errors := make(chan string, threads)
+
+	for thread := 0; thread < threads; thread++ {
+		wg.Add(1)
+		go func(thread int) {
+			defer wg.Done()
+
+			for i := 0; i < 20000; i++ {
+				key := keys[(i*7+thread*31)%len(keys)]
+				if thread%2 == 0 {
+					table.Store(concurrentEntry(key))
+					continue
+				}
+
+				// a probe should either miss or return a complete entry
+				entry, hit := table.Probe(key)
+				if want := concurrentEntry(key); hit &&
+					(entry.Move != want.Move || entry.Value != want.Value || entry.Type != want.Type || entry.Depth != want.Depth) {
+					errors <- "probe returned a torn entry"
+					return
+				}
+
+				if hit {
+					hits.Add(1)
+				}
+			}
+		}(thread)
+	}
+
+	wg.Wait()
+	close(errors)
+
+	for err := range errors {
+		t.Fatal(err)
+	}
+
+	if hits.Load() == 0 {
+		t.Fatal("probe: no hits while storing concurrently")
+	}
+}
+
+func BenchmarkProbe(b *testing.B) {
+	table, keys := benchTable()
+	for _, key := range keys {
+		table.Store(tt.Entry{Hash: key, Type: tt.ExactEntry})
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, key := range keys {
+			table.Probe(key)
+		}
+	}
+}
+
+func BenchmarkStore(b *testing.B) {
+	table, keys := benchTable()
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for _, key := range keys {
+			table.Store(tt.Entry{Hash: key, Depth: uint8(i), Type: tt.ExactEntry})
+		}
+	}
+}
+
+// benchTable returns a 16 MB table, and the keys of the bench positions
+// and of the positions after each of their moves.
+func benchTable() (*tt.Table, []zobrist.Key) {
+	var keys []zobrist.Key
+	for _, fenString := range bench.FENs {
+		b := board.New(board.FEN(fen.FromString(fenString)))
+
+		keys = append(keys, b.Hash)
+		for _, m := range b.GenerateMoves(false) {
+			keys = append(keys, b.KeyAfter(m))
+		}
+	}
+
+	return tt.NewTable(16), keys
+}
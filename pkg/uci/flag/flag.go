@@ -125,6 +125,22 @@ func (s Schema) Variadic(name string) {
 	}
 }
 
+// List adds a list flag with the given name to the schema. A list flag
+// is a flag which collects all the arguments up to the next flag of the
+// schema. Values of list flags are of type []string.
+func (s Schema) List(name string) {
+	s.flags[name] = func(args []string) (any, []string, error) {
+		n := 0
+		for ; n < len(args); n++ {
+			if _, isFlag := s.flags[args[n]]; isFlag {
+				break
+			}
+		}
+
+		return args[:n], args[n:], nil
+	}
+}
+
 // Flag represents a flag of an uci command. Flag is a collector function
 // which collects it's arguments from the provided list, and return's it's
 // value, the remaining arguments, and an error, if any.
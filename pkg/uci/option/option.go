@@ -233,3 +233,48 @@ func (option *String) Store(value []string) error {
 func (option *String) Initialize() error {
 	return option.Storage(option.Default)
 }
+
+// Combo represents an UCI option of type combo.
+// UCI Specification: a combo box that can have different predefined
+// strings as a value
+type Combo struct {
+	Default string
+	Vars    []string
+
+	// user defined storage function
+	Storage func(string) error
+}
+
+// compile time check that *Combo implements Option.
+var _ Option = (*Combo)(nil)
+
+// Type returns the type string of the given combo option.
+// Format: combo default <default value> [var <value>]...
+func (option *Combo) Type() string {
+	str := fmt.Sprintf("combo default %s", option.Default)
+	for _, value := range option.Vars {
+		str += " var " + value
+	}
+
+	return str
+}
+
+// Store implements the storage function for a combo option.
+func (option *Combo) Store(value []string) error {
+	str := strings.Join(value, " ")
+
+	// value should be one of the predefined strings
+	for _, predefined := range option.Vars {
+		if strings.EqualFold(str, predefined) {
+			// call user defined storage function
+			return option.Storage(predefined)
+		}
+	}
+
+	return fmt.Errorf("option combo: invalid value %q", str)
+}
+
+// Initialize stores the default value for the combo option.
+func (option *Combo) Initialize() error {
+	return option.Storage(option.Default)
+}
@@ -0,0 +1,71 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package option_test
+
+import (
+	"testing"
+
+	"laptudirm.com/x/mess/pkg/uci/option"
+)
+
+func TestComboType(t *testing.T) {
+	combo := option.Combo{
+		Default: "Classical",
+		Vars:    []string{"Classical", "NNUE", "Hybrid Eval"},
+	}
+
+	want := "combo default Classical var Classical var NNUE var Hybrid Eval"
+	if got := combo.Type(); got != want {
+		t.Errorf("type: got %q, want %q", got, want)
+	}
+}
+
+func TestComboStore(t *testing.T) {
+	var stored string
+	combo := option.Combo{
+		Default: "Classical",
+		Vars:    []string{"Classical", "NNUE", "Hybrid Eval"},
+		Storage: func(value string) error {
+			stored = value
+			return nil
+		},
+	}
+
+	tests := []struct {
+		value []string
+		want  string // empty if the value is invalid
+	}{
+		{[]string{"NNUE"}, "NNUE"},
+		{[]string{"nnue"}, "NNUE"},
+		{[]string{"cLaSsIcAl"}, "Classical"},
+		{[]string{"hybrid", "eval"}, "Hybrid Eval"},
+		{[]string{"Hybrid"}, ""},
+		{[]string{"Random"}, ""},
+		{[]string{}, ""},
+	}
+
+	for _, test := range tests {
+		stored = ""
+		err := combo.Store(test.value)
+
+		switch {
+		case test.want == "" && err == nil:
+			t.Errorf("store %q: stored %q, want error", test.value, stored)
+		case test.want != "" && err != nil:
+			t.Errorf("store %q: unexpected error %v", test.value, err)
+		case stored != test.want:
+			t.Errorf("store %q: stored %q, want %q", test.value, stored, test.want)
+		}
+	}
+}
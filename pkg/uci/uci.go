@@ -26,10 +26,13 @@ import (
 // NewClient creates a new uci.Client which is listening to the stdin for
 // commands and with the default isready and quit commands added.
 func NewClient() Client {
+	stdout := newAsyncWriter(os.Stdout)
+
 	client := Client{
 		// communication streams
 		stdin:  os.Stdin,
-		stdout: os.Stdout,
+		stdout: stdout,
+		output: stdout,
 	}
 
 	client.commands = cmd.NewSchema(client.stdout)
@@ -46,6 +49,9 @@ type Client struct {
 	stdin  io.Reader // GUI to Engine commands
 	stdout io.Writer // Engine to GUI commands
 
+	// the asynchronous writer behind stdout
+	output *asyncWriter
+
 	commands cmd.Schema // commands schema
 }
 
@@ -113,6 +119,13 @@ func (c *Client) RunWith(args []string, parallelize bool) error {
 	return cmd.RunWith(args, parallelize, c.commands)
 }
 
+// Flush blocks until all the output written to the client's stdout has
+// been flushed. The output is written asynchronously, so Flush should be
+// called before exiting to make sure that none of it is lost.
+func (c *Client) Flush() {
+	c.output.Flush()
+}
+
 // Print acts as fmt.Print on the client's stdout.
 func (c *Client) Print(a ...any) (int, error) {
 	return fmt.Fprint(c.stdout, a...)
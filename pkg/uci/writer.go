@@ -0,0 +1,99 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package uci
+
+import (
+	"bufio"
+	"io"
+)
+
+// queueSize is the maximum number of writes which can be queued in an
+// asyncWriter before further writes start blocking.
+const queueSize = 256
+
+// newAsyncWriter creates a new asyncWriter which writes to the given
+// writer, and starts it's writer goroutine.
+func newAsyncWriter(w io.Writer) *asyncWriter {
+	writer := &asyncWriter{
+		queue: make(chan writeRequest, queueSize),
+	}
+
+	go writer.run(bufio.NewWriter(w))
+	return writer
+}
+
+// asyncWriter is an io.Writer which queues the writes in a bounded queue,
+// which is drained by a separate goroutine. Therefore, writers like the
+// search threads aren't stalled by a slow reader of the output, unless the
+// queue is full. The order of the writes is preserved, and all the queued
+// writes are coalesced into a single flush of the underlying writer.
+type asyncWriter struct {
+	queue chan writeRequest
+}
+
+// writeRequest represents a request made to the writer goroutine. If done
+// is not nil, it is closed once the request's data has been flushed.
+type writeRequest struct {
+	data []byte
+	done chan struct{}
+}
+
+// compile time check that asyncWriter implements io.Writer
+var _ io.Writer = (*asyncWriter)(nil)
+
+// Write queues the given data to be written to the underlying writer. It
+// never fails, as errors from the underlying writer are discarded.
+func (w *asyncWriter) Write(p []byte) (int, error) {
+	// the callers are allowed to reuse p, so copy it
+	w.queue <- writeRequest{data: append([]byte(nil), p...)}
+	return len(p), nil
+}
+
+// Flush blocks until all the writes queued before it have been written
+// to and flushed from the underlying writer.
+func (w *asyncWriter) Flush() {
+	done := make(chan struct{})
+	w.queue <- writeRequest{done: done}
+	<-done
+}
+
+// run is the writer goroutine, which writes the queued data.
+func (w *asyncWriter) run(buffer *bufio.Writer) {
+	var flushed []chan struct{} // flush requests in the current batch
+
+	for request := range w.queue {
+		// write every queued request before flushing
+		for {
+			_, _ = buffer.Write(request.data)
+			if request.done != nil {
+				flushed = append(flushed, request.done)
+			}
+
+			if len(w.queue) == 0 {
+				break
+			}
+
+			request = <-w.queue
+		}
+
+		_ = buffer.Flush()
+
+		// notify the waiting flushers
+		for _, done := range flushed {
+			close(done)
+		}
+
+		flushed = flushed[:0]
+	}
+}
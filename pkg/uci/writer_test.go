@@ -0,0 +1,125 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package uci
+
+import (
+	"fmt"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+)
+
+// gatedWriter is an io.Writer which records the data written to it. Each
+// of it's writes signals entered and then blocks until gate is closed.
+type gatedWriter struct {
+	entered chan struct{}
+	gate    chan struct{}
+
+	mutex  sync.Mutex
+	data   strings.Builder
+	writes int
+}
+
+func newGatedWriter() *gatedWriter {
+	return &gatedWriter{
+		entered: make(chan struct{}, queueSize),
+		gate:    make(chan struct{}),
+	}
+}
+
+func (w *gatedWriter) Write(p []byte) (int, error) {
+	w.entered <- struct{}{}
+	<-w.gate
+
+	w.mutex.Lock()
+	defer w.mutex.Unlock()
+
+	w.writes++
+	return w.data.Write(p)
+}
+
+// written returns the data written so far and the number of writes.
+func (w *gatedWriter) written() (string, int) {
+	w.mutex.Lock()
+	defer w.mutex.Unlock()
+
+	return w.data.String(), w.writes
+}
+
+func TestWriterOrder(t *testing.T) {
+	underlying := newGatedWriter()
+	writer := newAsyncWriter(underlying)
+
+	// the first batch only contains the first write, since the writer
+	// goroutine is blocked writing it while the others are queued
+	fmt.Fprintln(writer, "line 0")
+	<-underlying.entered
+
+	var want strings.Builder
+	want.WriteString("line 0\n")
+	for i := 1; i < queueSize/2; i++ {
+		line := fmt.Sprintf("line %d\n", i)
+		want.WriteString(line)
+
+		// reuse the same buffer, which the writer must have copied
+		buffer := []byte(line)
+		_, _ = writer.Write(buffer)
+		copy(buffer, "xxxxxxxx")
+	}
+
+	close(underlying.gate)
+	writer.Flush()
+
+	got, writes := underlying.written()
+	if got != want.String() {
+		t.Errorf("output:\n%s\nwant:\n%s", got, want.String())
+	}
+
+	// the remaining writes should be coalesced into a second batch
+	if writes != 2 {
+		t.Errorf("underlying writes: got %d, want 2", writes)
+	}
+}
+
+func TestWriterFlush(t *testing.T) {
+	underlying := newGatedWriter()
+	writer := newAsyncWriter(underlying)
+
+	fmt.Fprint(writer, "info depth 1\n")
+
+	flushed := make(chan struct{})
+	go func() {
+		writer.Flush()
+		close(flushed)
+	}()
+
+	// the earlier write is stuck in the underlying writer
+	<-underlying.entered
+	select {
+	case <-flushed:
+		t.Fatal("flush returned before the earlier write was written")
+	case <-time.After(50 * time.Millisecond):
+	}
+
+	close(underlying.gate)
+	<-flushed
+
+	if got, _ := underlying.written(); got != "info depth 1\n" {
+		t.Errorf("output after flush: got %q, want %q", got, "info depth 1\n")
+	}
+
+	// a flush with nothing queued still returns
+	writer.Flush()
+}
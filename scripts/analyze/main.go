@@ -0,0 +1,293 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Command analyze searches a stream of positions in parallel, and writes
+// the results of the searches as json lines, in the order of the input.
+// The positions are read one on each line, either as fens or as epds. The
+// epd operations acd and acn override the depth and node limits of their
+// position's search, and the id operation is copied into the result.
+//
+// Each worker owns a search context, whose transposition table is reused
+// for all the positions searched by the worker.
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"flag"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"runtime"
+	"strconv"
+	"strings"
+	"time"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search"
+)
+
+func main() {
+	if err := Main(); err != nil {
+		_, _ = fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
+
+func Main() error {
+	// Command-Line Flags:
+	input := flag.String("input", "", "file containing the fens or epds to analyze (default stdin)")
+	output := flag.String("output", "", "file to write the json results to (default stdout)")
+	workers := flag.Int("workers", runtime.NumCPU(), "number of positions to search in parallel")
+	hash := flag.Int("hash", 16, "size of each worker's transposition table in megabytes")
+	depth := flag.Int("depth", 0, "depth limit for each search (default 12 if no limit is set)")
+	nodes := flag.Int("nodes", 0, "node limit for each search")
+	movetime := flag.Int("movetime", 0, "time limit for each search in milliseconds")
+	clear := flag.Bool("clear", false, "clear a worker's tables before each search, for reproducible results")
+
+	// Parse the CLI Flags.
+	flag.Parse()
+
+	limits := search.Limits{
+		Depth:    *depth,
+		Nodes:    *nodes,
+		MoveTime: *movetime,
+	}
+
+	if limits.Depth == 0 && limits.Nodes == 0 && limits.MoveTime == 0 {
+		limits.Depth = 12
+	}
+
+	// the limits which aren't set don't limit the search
+	limits.Depth = util.Ternary(limits.Depth == 0, search.MaxDepth, limits.Depth)
+	limits.Nodes = util.Ternary(limits.Nodes == 0, math.MaxInt, limits.Nodes)
+	limits.MoveTime = util.Ternary(limits.MoveTime == 0, math.MaxInt32, limits.MoveTime)
+
+	in, out := io.Reader(os.Stdin), io.Writer(os.Stdout)
+
+	if *input != "" {
+		f, err := os.Open(*input)
+		if err != nil {
+			return err
+		}
+
+		defer f.Close()
+		in = f
+	}
+
+	if *output != "" {
+		f, err := os.Create(*output)
+		if err != nil {
+			return err
+		}
+
+		defer f.Close()
+		out = f
+	}
+
+	return Analyze(in, out, *workers, *hash, limits, *clear)
+}
+
+// Job is a position to be analyzed by a worker.
+type Job struct {
+	Index  int           // index of the position in the input
+	ID     string        // epd id of the position, if any
+	FEN    fen.String    // the position to search
+	Limits search.Limits // limits of the position's search
+}
+
+// Result is the result of the analysis of a single position.
+type Result struct {
+	Index int    `json:"index"`
+	ID    string `json:"id,omitempty"`
+	FEN   string `json:"fen"`
+
+	BestMove string `json:"bestmove,omitempty"`
+	Score    string `json:"score,omitempty"`
+	PV       string `json:"pv,omitempty"`
+
+	Depth    int     `json:"depth"`
+	SelDepth int     `json:"seldepth"`
+	Nodes    int     `json:"nodes"`
+	TimeMs   float64 `json:"time_ms"`
+
+	Error string `json:"error,omitempty"`
+}
+
+// Analyze analyzes the positions read from in with the given number of
+// workers, and writes the results to out as json lines, in input order.
+func Analyze(in io.Reader, out io.Writer, workers, hash int, limits search.Limits, clear bool) error {
+	jobs := make(chan Job, workers)
+	results := make(chan Result, workers)
+
+	for i := 0; i < workers; i++ {
+		go Work(jobs, results, hash, clear)
+	}
+
+	// read the positions
+	readErr := make(chan error, 1)
+	go func() {
+		defer close(jobs)
+
+		index := 0
+		scanner := bufio.NewScanner(in)
+		for scanner.Scan() {
+			line := strings.TrimSpace(scanner.Text())
+			if line == "" {
+				continue
+			}
+
+			job, err := ParseJob(index, line, limits)
+			if err != nil {
+				readErr <- fmt.Errorf("line %d: %w", index+1, err)
+				return
+			}
+
+			jobs <- job
+			index++
+		}
+
+		// a read error or a line which is too long stops the scanner,
+		// which would otherwise silently truncate the positions
+		readErr <- scanner.Err()
+	}()
+
+	// the results arrive out of order, so they are buffered until all the
+	// results before them have been written
+	writer := bufio.NewWriter(out)
+	encoder := json.NewEncoder(writer)
+
+	pending := make(map[int]Result)
+	next, running := 0, workers
+	for running > 0 {
+		result := <-results
+		if result.Index < 0 {
+			// a worker has exited
+			running--
+			continue
+		}
+
+		pending[result.Index] = result
+		for result, found := pending[next]; found; result, found = pending[next] {
+			if err := encoder.Encode(result); err != nil {
+				return err
+			}
+
+			delete(pending, next)
+			next++
+		}
+
+		// push out the in-order results
+		if err := writer.Flush(); err != nil {
+			return err
+		}
+	}
+
+	return <-readErr
+}
+
+// Work searches the jobs with a search context owned by the worker, and
+// sends their results. A result with a negative index is sent on exit.
+func Work(jobs <-chan Job, results chan<- Result, hash int, clear bool) {
+	var report search.Report
+	context := search.NewContext(func(r search.Report) {
+		report = r
+	}, hash)
+
+	for job := range jobs {
+		if clear {
+			context.NewGame()
+		}
+
+		report = search.Report{}
+		context.UpdatePosition(job.FEN)
+
+		start := time.Now()
+		pv, score, err := context.Search(job.Limits)
+
+		result := Result{
+			Index: job.Index,
+			ID:    job.ID,
+			FEN:   job.FEN.String(),
+
+			Depth:    report.Depth,
+			SelDepth: report.SelDepth,
+			Nodes:    report.Nodes,
+			TimeMs:   float64(time.Since(start).Microseconds()) / 1000,
+		}
+
+		if err != nil {
+			result.Error = err.Error()
+		} else {
+			result.BestMove = pv.Move(0).String()
+			result.Score = score.String()
+			result.PV = pv.String()
+		}
+
+		results <- result
+	}
+
+	results <- Result{Index: -1}
+}
+
+// ParseJob parses a line containing a fen or an epd into a job, with the
+// given default limits. The epd operations acd and acn override the depth
+// and node limits, and the id operation is stored in the job.
+func ParseJob(index int, line string, limits search.Limits) (Job, error) {
+	fields := strings.Fields(line)
+	if len(fields) < 4 {
+		return Job{}, fmt.Errorf("parse position: %q has too few fields", line)
+	}
+
+	job := Job{Index: index, Limits: limits}
+
+	// a fen has the draw clock and move number after the first four
+	// fields, while the operations of an epd start right after them
+	if len(fields) >= 6 && isNumber(fields[4]) && isNumber(fields[5]) {
+		job.FEN = fen.FromSlice(fields[:6])
+		fields = fields[6:]
+	} else {
+		job.FEN = fen.FromSlice(fields[:4:4])
+		fields = fields[4:]
+	}
+
+	// parse the epd operations, which are of the form: opcode operands;
+	for _, operation := range strings.Split(strings.Join(fields, " "), ";") {
+		opcode, operand, _ := strings.Cut(strings.TrimSpace(operation), " ")
+		operand = strings.Trim(strings.TrimSpace(operand), `"`)
+
+		var err error
+		switch opcode {
+		case "id":
+			job.ID = operand
+		case "acd":
+			job.Limits.Depth, err = strconv.Atoi(operand)
+		case "acn":
+			job.Limits.Nodes, err = strconv.Atoi(operand)
+		}
+
+		if err != nil {
+			return Job{}, fmt.Errorf("parse position: bad %s operand %q", opcode, operand)
+		}
+	}
+
+	return job, nil
+}
+
+// isNumber reports whether the given string is a non-negative integer.
+func isNumber(str string) bool {
+	_, err := strconv.ParseUint(str, 10, 64)
+	return err == nil
+}
@@ -5,6 +5,7 @@ import (
 	"flag"
 	"fmt"
 	"log"
+	"math"
 	"os"
 	"time"
 
@@ -12,6 +13,7 @@ import (
 	"laptudirm.com/x/mess/pkg/board/move"
 	"laptudirm.com/x/mess/pkg/board/piece"
 	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/formats/packed"
 	"laptudirm.com/x/mess/pkg/search"
 	"laptudirm.com/x/mess/pkg/search/eval"
 )
@@ -27,7 +29,8 @@ func Main() error {
 	// Command-Line Flags:
 	openings := flag.String("openings", "", "shuffled opening book containing a list of fens")
 	offset := flag.Int("opening-offset", 0, "offset from which the books should be read")
-	output := flag.String("output", "data.legacy", "output file for the generated fens and other data")
+	output := flag.String("output", "", "output file for the generated fens and other data (default data.<format>)")
+	format := flag.String("format", "packed", "format of the output data, packed (binary records) or legacy (text)")
 	games := flag.Int("games", 100_000, "number of games to generate data for (actual might be less)")
 	threads := flag.Int("threads", 1, "number of threads to use for data generation work")
 	winAdjudicateEval := flag.Uint("win-adjudicate-eval", uint(eval.Mate), "search score for which game will be adjudicated as a win")
@@ -37,8 +40,16 @@ func Main() error {
 	// Parse the CLI Flags.
 	flag.Parse()
 
+	if *format != "packed" && *format != "legacy" {
+		return fmt.Errorf("unknown output format %q", *format)
+	}
+
+	if *output == "" {
+		*output = "data." + *format
+	}
+
 	// Create a new data generator.
-	g, err := NewGenerator(*openings, *output, *offset, *games, *threads, *nodes, *depth, eval.Eval(*winAdjudicateEval))
+	g, err := NewGenerator(*openings, *output, *format, *offset, *games, *threads, *nodes, *depth, eval.Eval(*winAdjudicateEval))
 	if err != nil {
 		return err
 	}
@@ -48,7 +59,7 @@ func Main() error {
 	return nil
 }
 
-func NewGenerator(from, to string, offset, games, threads, nodes, depth int, winThreshold eval.Eval) (*Generator, error) {
+func NewGenerator(from, to, format string, offset, games, threads, nodes, depth int, winThreshold eval.Eval) (*Generator, error) {
 	// Open the opening source epd file.
 	i, err := os.Open(from)
 	if err != nil {
@@ -69,11 +80,12 @@ func NewGenerator(from, to string, offset, games, threads, nodes, depth int, win
 	return &Generator{
 		Input:  bufio.NewScanner(i),
 		Output: bufio.NewWriterSize(o, 2000*100),
+		Format: format,
 
 		Offset: offset,
 
 		Openings: make(chan string),
-		Data:     make(chan DataPoint),
+		Batches:  make(chan []packed.Record),
 		Deaths:   make(chan int),
 
 		Games:   games,
@@ -92,13 +104,14 @@ type Generator struct {
 	// Input and Output files.
 	Input  *bufio.Scanner
 	Output *bufio.Writer
+	Format string // Format of the Output file.
 
 	// Opening Offset in Input.
 	Offset int
 
 	// Sync channels.
 	Openings chan string
-	Data     chan DataPoint
+	Batches  chan []packed.Record
 	Deaths   chan int
 
 	// Number of games done.
@@ -133,22 +146,20 @@ func (generator *Generator) GenerateData() {
 
 	for {
 		select {
-		case data := <-generator.Data:
-			_, _ = generator.Output.WriteString(data.String())
-			datapoints++
-
-			if datapoints&4095 == 0 {
-				delta := int(time.Since(start).Seconds()) + 1
-				log.Printf(
-					"%10d fens [%4d fens/second] %8d games [%2d games/second] [%3d fens/game]\n",
-					datapoints, datapoints/delta, generator.Done, generator.Done/delta, datapoints/generator.Done,
-				)
-			}
+		case batch := <-generator.Batches:
+			generator.Write(batch)
+			datapoints += len(batch)
+
+			delta := int(time.Since(start).Seconds()) + 1
+			log.Printf(
+				"%10d fens [%4d fens/second] %8d games [%2d games/second] [%3d fens/game]\n",
+				datapoints, datapoints/delta, generator.Done, generator.Done/delta, datapoints/util.Max(generator.Done, 1),
+			)
 
 		case <-generator.Deaths:
 			if deaths++; deaths == generator.Threads {
 				close(generator.Deaths)
-				close(generator.Data)
+				close(generator.Batches)
 
 				_ = generator.Output.Flush()
 
@@ -170,24 +181,32 @@ func (generator *Generator) ScheduleWork() {
 	close(generator.Openings)
 }
 
+// batchSize is the number of records in the batches sent by the workers.
+const batchSize = 4096
+
 func (generator *Generator) StartWorker(id int) {
-	data := make([]DataPoint, 0)
+	// Records of the current game, whose result isn't known yet.
+	game := make([]packed.Record, 0)
+
+	// Records are sent to be written in batches to reduce handoffs.
+	batch := make([]packed.Record, 0, batchSize)
 
 	limits := search.Limits{
 		Depth:    generator.Depth,
 		Nodes:    generator.Nodes,
-		Infinite: true,
+		MoveTime: math.MaxInt32, // effectively infinite
 	}
 
 	worker := search.NewContext(func(report search.Report) {}, generator.HashSize)
 
 	for opening := range generator.Openings {
+		worker.NewGame()
 		worker.UpdatePosition(fen.FromString(opening))
 
 		board := worker.Board()
 
-		data = data[:0]
-		var result = float32(0.5)
+		game = game[:0]
+		var result = packed.Draw
 
 		for {
 			if board.DrawClock >= 100 ||
@@ -201,7 +220,7 @@ func (generator *Generator) StartWorker(id int) {
 			bestMove := pv.Move(0)
 
 			if bestMove == move.Null || util.Abs(score) >= generator.WinThreshold {
-				result = util.Ternary[float32](score > eval.Draw, 1.0, 0.0)
+				result = util.Ternary(score > eval.Draw, packed.WhiteWin, packed.BlackWin)
 				break
 			}
 
@@ -210,32 +229,41 @@ func (generator *Generator) StartWorker(id int) {
 				goto nextMove
 			}
 
-			data = append(data, DataPoint{
-				FEN:   board.FEN().String(),
-				Score: score,
-			})
+			game = append(game, packed.NewRecord(board, int(score), packed.Draw))
 
 		nextMove:
 			worker.MakeMove(bestMove)
 		}
 
-		for i := 0; i < len(data); i++ {
-			data[i].Result = result
-			generator.Data <- data[i]
+		for i := range game {
+			game[i].SetResult(result)
+		}
+
+		batch = append(batch, game...)
+		if len(batch) >= batchSize {
+			generator.Batches <- batch
+			batch = make([]packed.Record, 0, batchSize)
 		}
 
 		generator.Done++
 	}
 
+	generator.Batches <- batch
 	generator.Deaths <- id
 }
 
-type DataPoint struct {
-	FEN    string
-	Score  eval.Eval
-	Result float32
-}
+// Write writes the given batch of records in the output format.
+func (generator *Generator) Write(batch []packed.Record) {
+	if generator.Format == "packed" {
+		_ = packed.Write(generator.Output, batch)
+		return
+	}
 
-func (data *DataPoint) String() string {
-	return fmt.Sprintf("%s | %d | %.1f\n", data.FEN, data.Score, data.Result)
+	for i := range batch {
+		record := &batch[i]
+		_, _ = fmt.Fprintf(
+			generator.Output, "%s | %d | %.1f\n",
+			record.FEN(), record.Score(), record.Result().Score(),
+		)
+	}
 }
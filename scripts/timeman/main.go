@@ -0,0 +1,185 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Command timeman replays games from a list of positions with simulated
+// clocks, to test the engine's time management without a gui. The engine
+// plays both sides, and the time it takes for each move is deducted from
+// the mover's clock, which is then incremented. The time usage stats and
+// the number of moves for which the clock ran out are reported.
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"log"
+	"math"
+	"os"
+	"time"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/board/move"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/search"
+)
+
+func main() {
+	if err := Main(); err != nil {
+		_, _ = fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
+
+func Main() error {
+	// Command-Line Flags:
+	positions := flag.String("positions", "", "file containing a list of fens to play from (default startpos)")
+	base := flag.Int("time", 10_000, "base time of each side's clock in milliseconds")
+	increment := flag.Int("inc", 100, "increment of each side's clock in milliseconds")
+	plies := flag.Int("plies", 80, "maximum number of plies to play from each position")
+	hash := flag.Int("hash", 16, "size of the transposition table in megabytes")
+
+	// Parse the CLI Flags.
+	flag.Parse()
+
+	fens, err := readPositions(*positions)
+	if err != nil {
+		return err
+	}
+
+	context := search.NewContext(func(search.Report) {}, *hash)
+
+	var total Clock
+	for i, fenString := range fens {
+		context.NewGame()
+		context.UpdatePosition(fen.FromString(fenString))
+
+		clock := Play(context, *base, *increment, *plies)
+		log.Printf("position %3d: %s\n", i+1, &clock)
+
+		total.Add(clock)
+	}
+
+	log.Printf("total       : %s\n", &total)
+	return nil
+}
+
+// readPositions reads the fens from the given file, one on each line. If
+// the file name is empty, only the starting position is returned.
+func readPositions(file string) ([]string, error) {
+	if file == "" {
+		return []string{board.StartFEN.String()}, nil
+	}
+
+	f, err := os.Open(file)
+	if err != nil {
+		return nil, err
+	}
+
+	defer f.Close()
+
+	var fens []string
+	scanner := bufio.NewScanner(f)
+	for scanner.Scan() {
+		if line := scanner.Text(); line != "" {
+			fens = append(fens, line)
+		}
+	}
+
+	return fens, scanner.Err()
+}
+
+// Play plays a game from the context's position, with both sides' clocks
+// starting at time and incremented by inc after every move, until the
+// game ends or the given number of plies are played. It returns the time
+// usage stats of the game.
+func Play(context *search.Context, base, inc, plies int) Clock {
+	clocks := [piece.ColorN]int{base, base}
+	stats := Clock{MinClock: math.MaxInt}
+
+	chessboard := context.Board()
+	for ply := 0; ply < plies; ply++ {
+		if chessboard.DrawClock >= 100 || chessboard.IsThreefoldRepetition() {
+			break
+		}
+
+		us := chessboard.SideToMove
+		limits := search.Limits{
+			Depth:     search.MaxDepth,
+			Nodes:     math.MaxInt,
+			Time:      clocks,
+			Increment: [piece.ColorN]int{inc, inc},
+		}
+
+		start := time.Now()
+		pv, _, err := context.Search(limits)
+		used := int(time.Since(start).Milliseconds())
+
+		bestMove := pv.Move(0)
+		if err != nil || bestMove == move.Null {
+			// game over
+			break
+		}
+
+		clocks[us] -= used
+		if clocks[us] < 0 {
+			// flagged, continue as if it hadn't happened
+			stats.Flags++
+			clocks[us] = 0
+		}
+
+		stats.Moves++
+		stats.Used += used
+		stats.MaxUsed = util.Max(stats.MaxUsed, used)
+		stats.MinClock = util.Min(stats.MinClock, clocks[us])
+
+		clocks[us] += inc
+		context.MakeMove(bestMove)
+	}
+
+	return stats
+}
+
+// Clock contains the time usage stats of one or more games.
+type Clock struct {
+	Moves int // number of moves played
+	Flags int // moves after which the clock ran out
+
+	Used     int // total time used, in milliseconds
+	MaxUsed  int // maximum time used on a move
+	MinClock int // minimum time left on a clock after a move
+}
+
+// Add adds the stats of the given games to the current ones.
+func (clock *Clock) Add(games Clock) {
+	if clock.Moves == 0 {
+		clock.MinClock = games.MinClock
+	}
+
+	clock.Moves += games.Moves
+	clock.Flags += games.Flags
+	clock.Used += games.Used
+	clock.MaxUsed = util.Max(clock.MaxUsed, games.MaxUsed)
+	clock.MinClock = util.Min(clock.MinClock, games.MinClock)
+}
+
+// String converts the stats into a human readable string.
+func (clock *Clock) String() string {
+	return fmt.Sprintf(
+		"%4d moves %2d flags, %6.f ms/move avg %6d ms max, %6d ms min clock",
+		clock.Moves, clock.Flags,
+		float64(clock.Used)/float64(util.Max(clock.Moves, 1)),
+		clock.MaxUsed, clock.MinClock,
+	)
+}
@@ -0,0 +1,195 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package main
+
+import (
+	"bufio"
+	"errors"
+	"flag"
+	"fmt"
+	"log"
+	"os"
+	"strconv"
+	"strings"
+
+	"laptudirm.com/x/mess/pkg/board"
+	"laptudirm.com/x/mess/pkg/formats/fen"
+	"laptudirm.com/x/mess/pkg/formats/packed"
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+// Extract runs the extract mode with the given arguments, which converts
+// a dataset into a feature file.
+func Extract(args []string) error {
+	flags := flag.NewFlagSet("extract", flag.ExitOnError)
+
+	input := flags.String("input", "", "dataset of scored positions to extract the features from")
+	output := flags.String("output", "features.bin", "output file for the extracted features")
+	format := flags.String("format", "packed", "format of the dataset, packed (binary records) or legacy (text)")
+
+	_ = flags.Parse(args)
+
+	if *format != "packed" && *format != "legacy" {
+		return fmt.Errorf("tune: unknown input format %q", *format)
+	}
+
+	f, err := os.Create(*output)
+	if err != nil {
+		return err
+	}
+
+	w := bufio.NewWriterSize(f, 1<<20)
+	if err := writeHeader(w); err != nil {
+		_ = f.Close()
+		return err
+	}
+
+	extractor := newExtractor(w)
+	if *format == "packed" {
+		err = extractor.extractPacked(*input)
+	} else {
+		err = extractor.extractLegacy(*input)
+	}
+
+	if err == nil {
+		err = w.Flush()
+	}
+
+	if closeErr := f.Close(); err == nil {
+		err = closeErr
+	}
+
+	if err != nil {
+		return err
+	}
+
+	log.Printf("extracted the features of %d positions\n", extractor.positions)
+	return nil
+}
+
+// extractor traces positions with a classical evaluator, and writes their
+// features to the underlying writer.
+type extractor struct {
+	board     *board.Board
+	evaluator *classical.EfficientlyUpdatable
+
+	w         *bufio.Writer
+	buffer    []byte // encoded features of the current position
+	positions int    // number of positions extracted
+}
+
+// newExtractor creates a new extractor which writes to the given writer.
+func newExtractor(w *bufio.Writer) *extractor {
+	chessboard := board.New()
+	evaluator := classical.New(chessboard).(*classical.EfficientlyUpdatable)
+	chessboard.SetEfficientlyUpdatable(evaluator)
+
+	return &extractor{
+		board:     chessboard,
+		evaluator: evaluator,
+		w:         w,
+	}
+}
+
+// extract writes the features of the given position, along with it's
+// white relative score and game result.
+func (extractor *extractor) extract(position fen.String, score int, result packed.Result) error {
+	extractor.board.UpdateWithFEN(position)
+	trace := extractor.evaluator.Trace()
+
+	var err error
+	extractor.buffer, err = appendPosition(extractor.buffer[:0], &trace, score, result)
+	if err != nil {
+		return err
+	}
+
+	if _, err := extractor.w.Write(extractor.buffer); err != nil {
+		return err
+	}
+
+	if extractor.positions++; extractor.positions%1_000_000 == 0 {
+		log.Printf("%10d positions\n", extractor.positions)
+	}
+
+	return nil
+}
+
+// extractPacked extracts the features of a dataset of packed records.
+func (extractor *extractor) extractPacked(input string) error {
+	file, err := packed.Open(input)
+	if err != nil {
+		return err
+	}
+
+	defer file.Close()
+
+	for i := range file.Records {
+		record := &file.Records[i]
+		if err := extractor.extract(record.FEN(), record.Score(), record.Result()); err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+// extractLegacy extracts the features of a text dataset, with a position
+// on each line in the form "fen | white relative score | result", where
+// the result is 1.0, 0.5, or 0.0 for a white win, draw, or black win.
+func (extractor *extractor) extractLegacy(input string) error {
+	f, err := os.Open(input)
+	if err != nil {
+		return err
+	}
+
+	defer f.Close()
+
+	scanner := bufio.NewScanner(f)
+	for line := 1; scanner.Scan(); line++ {
+		fields := strings.Split(scanner.Text(), " | ")
+		if len(fields) != 3 {
+			return fmt.Errorf("tune: line %d: expected 3 fields, found %d", line, len(fields))
+		}
+
+		score, err := strconv.Atoi(fields[1])
+		if err != nil {
+			return fmt.Errorf("tune: line %d: invalid score %q", line, fields[1])
+		}
+
+		result, err := parseResult(fields[2])
+		if err != nil {
+			return fmt.Errorf("tune: line %d: %w", line, err)
+		}
+
+		if err := extractor.extract(fen.FromString(fields[0]), score, result); err != nil {
+			return err
+		}
+	}
+
+	return scanner.Err()
+}
+
+// parseResult parses a white relative game result in the legacy format.
+func parseResult(s string) (packed.Result, error) {
+	switch s {
+	case "1.0":
+		return packed.WhiteWin, nil
+	case "0.5":
+		return packed.Draw, nil
+	case "0.0":
+		return packed.BlackWin, nil
+	default:
+		return packed.Draw, errors.New("invalid result " + strconv.Quote(s))
+	}
+}
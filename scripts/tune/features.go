@@ -0,0 +1,178 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+
+	"laptudirm.com/x/mess/internal/util"
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/formats/packed"
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+// A feature file starts with a header containing a magic and the number of
+// terms in the traces it was extracted with, so that it isn't used after
+// the evaluation has changed. The header is followed by the positions, each
+// of which is stored as follows:
+//
+//	score     int16  white relative score of the position
+//	result    uint8  result of the position's game, as a packed.Result
+//	phase     uint8  game phase of the position, at most MaxPhase
+//	count     uint16 number of non-zero coefficients
+//	nonlinear int16  white relative mg contribution of the non-linear terms
+//	nonlinear int16  white relative eg contribution of the non-linear terms
+//
+// and then count coefficients, each being the index of a term as an uint16
+// followed by the term's white minus black coefficient as an int8. All the
+// values are little-endian.
+const (
+	headerSize   = 8
+	positionSize = 10
+	featureSize  = 3
+)
+
+// featureMagic is the magic at the start of every feature file.
+var featureMagic = [4]byte{'m', 't', 'f', '1'}
+
+// writeHeader writes the header of a feature file to the given writer.
+func writeHeader(w io.Writer) error {
+	var header [headerSize]byte
+	copy(header[:], featureMagic[:])
+	binary.LittleEndian.PutUint32(header[4:], uint32(classical.TraceN))
+
+	_, err := w.Write(header[:])
+	return err
+}
+
+// checkHeader checks the header of the given feature file's data.
+func checkHeader(data []byte) error {
+	if len(data) < headerSize || [4]byte(data[:4]) != featureMagic {
+		return errors.New("tune: input is not a feature file")
+	}
+
+	if terms := binary.LittleEndian.Uint32(data[4:]); terms != uint32(classical.TraceN) {
+		return fmt.Errorf("tune: features have %d terms, evaluation has %d, extract them again", terms, classical.TraceN)
+	}
+
+	return nil
+}
+
+// appendPosition appends the encoded features of a position with the given
+// trace, white relative score, and game result to the given buffer.
+func appendPosition(buffer []byte, trace *classical.Trace, score int, result packed.Result) ([]byte, error) {
+	nonlinear := trace.Nonlinear[piece.White] - trace.Nonlinear[piece.Black]
+
+	start := len(buffer)
+	buffer = binary.LittleEndian.AppendUint16(buffer, uint16(clamp16(score)))
+	buffer = append(buffer, byte(result), byte(trace.Phase))
+	buffer = binary.LittleEndian.AppendUint16(buffer, 0) // count, set later
+	buffer = binary.LittleEndian.AppendUint16(buffer, uint16(clamp16(int(nonlinear.MG()))))
+	buffer = binary.LittleEndian.AppendUint16(buffer, uint16(clamp16(int(nonlinear.EG()))))
+
+	count := 0
+	for term := range trace.Coefficients {
+		coefficient := trace.Coefficients[term][piece.White] - trace.Coefficients[term][piece.Black]
+		if coefficient == 0 {
+			continue
+		}
+
+		if coefficient < math.MinInt8 || coefficient > math.MaxInt8 {
+			return buffer[:start], fmt.Errorf("tune: coefficient %d of term %d out of range", coefficient, term)
+		}
+
+		buffer = binary.LittleEndian.AppendUint16(buffer, uint16(term))
+		buffer = append(buffer, byte(int8(coefficient)))
+		count++
+	}
+
+	binary.LittleEndian.PutUint16(buffer[start+4:], uint16(count))
+	return buffer, nil
+}
+
+// clamp16 clamps the given value to the range of an int16.
+func clamp16(value int) int16 {
+	return int16(util.Clamp(value, math.MinInt16, math.MaxInt16))
+}
+
+// position is a view of an encoded position in a feature file.
+type position []byte
+
+// indexPositions returns the offsets of each position in the given feature
+// file's data, after checking it's header and the size of the positions.
+func indexPositions(data []byte) ([]int, error) {
+	if err := checkHeader(data); err != nil {
+		return nil, err
+	}
+
+	var offsets []int
+	for offset := headerSize; offset < len(data); {
+		if offset+positionSize > len(data) {
+			return nil, errors.New("tune: truncated feature file")
+		}
+
+		offsets = append(offsets, offset)
+		offset += position(data[offset:]).size()
+
+		if offset > len(data) {
+			return nil, errors.New("tune: truncated feature file")
+		}
+	}
+
+	return offsets, nil
+}
+
+// size returns the encoded size of the position.
+func (p position) size() int {
+	return positionSize + p.count()*featureSize
+}
+
+// score returns the position's white relative score.
+func (p position) score() float64 {
+	return float64(int16(binary.LittleEndian.Uint16(p[0:])))
+}
+
+// result returns the result of the position's game, from white's
+// perspective, where a win is 1, a draw is 0.5, and a loss is 0.
+func (p position) result() float64 {
+	return float64(packed.Result(p[2]).Score())
+}
+
+// phase returns the position's game phase.
+func (p position) phase() float64 {
+	return float64(p[3])
+}
+
+// count returns the number of non-zero coefficients of the position.
+func (p position) count() int {
+	return int(binary.LittleEndian.Uint16(p[4:]))
+}
+
+// nonlinear returns the white relative mg and eg contributions of the
+// position's non-linear terms.
+func (p position) nonlinear() (float64, float64) {
+	return float64(int16(binary.LittleEndian.Uint16(p[6:]))),
+		float64(int16(binary.LittleEndian.Uint16(p[8:])))
+}
+
+// feature returns the index and the coefficient of the position's n-th
+// non-zero coefficient.
+func (p position) feature(n int) (int, float64) {
+	feature := p[positionSize+n*featureSize:]
+	return int(binary.LittleEndian.Uint16(feature)), float64(int8(feature[2]))
+}
@@ -0,0 +1,63 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Command tune tunes the weights of the classical evaluation function on a
+// dataset of scored positions, like the ones generated by datagen. It has
+// two modes, which are run one after the other:
+//
+//	tune extract -input data.packed -output features.bin
+//	tune train -input features.bin -output tuned.go
+//
+// The extract mode traces the evaluation of each position once, and stores
+// it's linear features as a sparse coefficient vector in a compact binary
+// file. The train mode then loads that file and runs mini-batch gradient
+// descent with Adam on it, with the gradients being calculated in parallel,
+// and periodically writes the tuned weights as go source code.
+//
+// Tracing the evaluation requires the tune build tag, so the command has to
+// be built or run with it: go run -tags tune ./scripts/tune.
+package main
+
+import (
+	"errors"
+	"fmt"
+	"os"
+
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+func main() {
+	if err := Main(); err != nil {
+		_, _ = fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
+
+func Main() error {
+	if !classical.TracingEnabled {
+		return errors.New("tune: evaluation tracing is disabled, build with -tags tune")
+	}
+
+	if len(os.Args) < 2 {
+		return errors.New("usage: tune extract|train [flags]")
+	}
+
+	switch mode, args := os.Args[1], os.Args[2:]; mode {
+	case "extract":
+		return Extract(args)
+	case "train":
+		return Train(args)
+	default:
+		return fmt.Errorf("tune: unknown mode %q", mode)
+	}
+}
@@ -0,0 +1,214 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package main
+
+import (
+	"bytes"
+	"fmt"
+	"math"
+	"os"
+
+	"laptudirm.com/x/mess/pkg/board/piece"
+	"laptudirm.com/x/mess/pkg/board/square"
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+// threatNames contains the names of the threat terms, in ThreatTerms order.
+var threatNames = [len(classical.ThreatTerms)]string{
+	"ThreatWeakPawn",
+	"ThreatMinorAttackedByPawn",
+	"ThreatMinorAttackedByMinor",
+	"ThreatMinorAttackedByMajor",
+	"ThreatRookAttackedByLesser",
+	"ThreatMinorAttackedByKing",
+	"ThreatRookAttackedByKing",
+	"ThreatQueenAttackedByOne",
+	"ThreatOverloadedPieces",
+	"ThreatByPawnPush",
+}
+
+// tableNames contains the names of each piece type's tables in the
+// classical evaluation's generator.
+var tableNames = [piece.TypeN]string{
+	piece.Pawn:   "Pawn",
+	piece.Knight: "Knight",
+	piece.Bishop: "Bishop",
+	piece.Rook:   "Rook",
+	piece.Queen:  "Queen",
+	piece.King:   "King",
+}
+
+// writeWeights writes the given weights to the given file, as the go
+// declarations of the evaluation variables they are the weights of. The
+// psqt weights are split into the piece values and tables used by the
+// classical evaluation's generator.
+func writeWeights(name string, w *weights) error {
+	var buffer bytes.Buffer
+
+	fmt.Fprintln(&buffer, "// tuned weights of the classical evaluation, generated by scripts/tune")
+	fmt.Fprintln(&buffer)
+	fmt.Fprintln(&buffer, "// pkg/search/eval/classical/classical.go")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintln(&buffer, "var PawnStacked = [2][square.FileN]Score{")
+	for unstack := 0; unstack < 2; unstack++ {
+		fmt.Fprintln(&buffer, "\t{")
+		writeScores(&buffer, w[classical.TracePawnStacked+unstack*square.FileN:][:square.FileN], "\t\t")
+		fmt.Fprintln(&buffer, "\t},")
+	}
+	fmt.Fprintln(&buffer, "}")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintln(&buffer, "var Mobility = [piece.TypeN][]Score{")
+	for t := piece.Knight; t <= piece.Queen; t++ {
+		fmt.Fprintf(&buffer, "\tpiece.%s: {\n", tableNames[t])
+		writeScores(&buffer, w[mobilityIndex(t):][:len(classical.Mobility[t])], "\t\t")
+		fmt.Fprintln(&buffer, "\t},")
+	}
+	fmt.Fprintln(&buffer, "}")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintln(&buffer, "var (")
+	fmt.Fprintf(&buffer, "\tRookSemiOpenFile = %s\n", score(w[classical.TraceRookOpen]))
+	fmt.Fprintf(&buffer, "\tRookFullOpenFile = %s\n", score(w[classical.TraceRookOpen+1]))
+	fmt.Fprintln(&buffer, ")")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintf(&buffer, "var KingDefenders = [%d]Score{\n", len(classical.KingDefenders))
+	writeScores(&buffer, w[classical.TraceDefenders:][:len(classical.KingDefenders)], "\t")
+	fmt.Fprintln(&buffer, "}")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintln(&buffer, "var (")
+	for i, name := range threatNames {
+		fmt.Fprintf(&buffer, "\t%s = %s\n", name, score(w[classical.TraceThreats+i]))
+	}
+	fmt.Fprintln(&buffer, ")")
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintf(&buffer, "var Tempo eval.Eval = %d\n", round(w[classical.TraceTempo][0]))
+	fmt.Fprintln(&buffer)
+
+	fmt.Fprintln(&buffer, "// internal/generator/classical/tables.go")
+	fmt.Fprintln(&buffer)
+
+	var values [piece.TypeN][2]int
+	for t := piece.Pawn; t < piece.King; t++ {
+		values[t] = pieceValue(w, t)
+	}
+
+	for i, phase := range [2]string{"mg", "eg"} {
+		fmt.Fprintf(&buffer, "var %sPieceValues = [piece.TypeN]eval.Eval{0", phase)
+		for t := piece.Pawn; t <= piece.King; t++ {
+			fmt.Fprintf(&buffer, ", %d", values[t][i])
+		}
+		fmt.Fprintln(&buffer, "}")
+	}
+	fmt.Fprintln(&buffer)
+
+	for t := piece.Pawn; t <= piece.King; t++ {
+		for i, phase := range [2]string{"mg", "eg"} {
+			fmt.Fprintf(&buffer, "var %s%s = [square.N]eval.Eval{\n", phase, tableNames[t])
+			for s := square.A8; s < square.N; s++ {
+				if s%8 == 0 {
+					buffer.WriteString("\t")
+				}
+
+				value := 0
+				if t != piece.Pawn || !isBackRank(s) {
+					// the pawn tables are zero on the back ranks
+					value = round(w[psqtIndex(t, s)][i]) - values[t][i]
+				}
+
+				fmt.Fprintf(&buffer, "%d,", value)
+				if s%8 == 7 {
+					buffer.WriteString("\n")
+				} else {
+					buffer.WriteString(" ")
+				}
+			}
+			fmt.Fprintln(&buffer, "}")
+			fmt.Fprintln(&buffer)
+		}
+	}
+
+	return os.WriteFile(name, buffer.Bytes(), 0644)
+}
+
+// writeScores writes the given weights as scores, four on each line.
+func writeScores(buffer *bytes.Buffer, w [][2]float64, indent string) {
+	for i, weight := range w {
+		if i%4 == 0 {
+			buffer.WriteString(indent)
+		}
+
+		buffer.WriteString(score(weight) + ",")
+		if i%4 == 3 || i == len(w)-1 {
+			buffer.WriteString("\n")
+		} else {
+			buffer.WriteString(" ")
+		}
+	}
+}
+
+// pieceValue returns the mg and eg value of the given piece type, which is
+// the mean of it's psqt weights, excluding the back ranks for pawns.
+func pieceValue(w *weights, t piece.Type) [2]int {
+	var sum [2]float64
+	squares := 0
+
+	for s := square.A8; s < square.N; s++ {
+		if t == piece.Pawn && isBackRank(s) {
+			continue
+		}
+
+		sum[0] += w[psqtIndex(t, s)][0]
+		sum[1] += w[psqtIndex(t, s)][1]
+		squares++
+	}
+
+	return [2]int{round(sum[0] / float64(squares)), round(sum[1] / float64(squares))}
+}
+
+// isBackRank reports whether the given square is on the first or last rank.
+func isBackRank(s square.Square) bool {
+	return s < 8 || s >= square.N-8
+}
+
+// psqtIndex returns the index of the psqt term of the given piece type and
+// white relative square.
+func psqtIndex(t piece.Type, s square.Square) int {
+	return classical.TracePSQT + int(t-piece.Pawn)*square.N + int(s)
+}
+
+// mobilityIndex returns the index of the first mobility term of the given
+// piece type.
+func mobilityIndex(t piece.Type) int {
+	index := classical.TraceMobility
+	for pt := piece.Knight; pt < t; pt++ {
+		index += len(classical.Mobility[pt])
+	}
+
+	return index
+}
+
+// score formats the given weight as a Score.
+func score(weight [2]float64) string {
+	return fmt.Sprintf("S(%d, %d)", round(weight[0]), round(weight[1]))
+}
+
+// round rounds the given weight to the nearest integer.
+func round(weight float64) int {
+	return int(math.Round(weight))
+}
@@ -0,0 +1,314 @@
+// Copyright © 2023 Rak Laptudirm <rak@laptudirm.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package main
+
+import (
+	"errors"
+	"flag"
+	"log"
+	"math"
+	"math/rand"
+	"os"
+	"runtime"
+	"sync"
+	"time"
+
+	"laptudirm.com/x/mess/pkg/search/eval/classical"
+)
+
+// Train runs the train mode with the given arguments, which tunes the
+// evaluation weights on a feature file.
+func Train(args []string) error {
+	flags := flag.NewFlagSet("train", flag.ExitOnError)
+
+	input := flags.String("input", "features.bin", "feature file to train the weights on")
+	output := flags.String("output", "tuned.go", "output file for the tuned weights")
+	threads := flags.Int("threads", runtime.NumCPU(), "number of threads to calculate the gradients with")
+	epochs := flags.Int("epochs", 100, "number of passes over the dataset")
+	batchSize := flags.Int("batch", 16384, "number of positions in each mini-batch")
+	rate := flags.Float64("lr", 1, "learning rate of the optimizer, in centipawns")
+	lambda := flags.Float64("lambda", 1, "weight of the game results in the targets, the rest being the scores")
+	k := flags.Float64("k", 0, "scaling of the evaluation's sigmoid (default calculated)")
+	save := flags.Int("save", 10, "number of epochs after which the weights are written")
+	seed := flags.Int64("seed", 1, "seed for shuffling the positions")
+
+	_ = flags.Parse(args)
+
+	if *threads < 1 || *epochs < 1 || *batchSize < 1 || *save < 1 {
+		return errors.New("tune: threads, epochs, batch, and save should be positive")
+	}
+
+	if *lambda < 0 || *lambda > 1 {
+		return errors.New("tune: lambda should be between 0 and 1")
+	}
+
+	data, err := os.ReadFile(*input)
+	if err != nil {
+		return err
+	}
+
+	offsets, err := indexPositions(data)
+	if err != nil {
+		return err
+	}
+
+	if len(offsets) == 0 {
+		return errors.New("tune: no positions to train on")
+	}
+
+	log.Printf("loaded %d positions\n", len(offsets))
+
+	tuner := newTuner(data, offsets, *threads)
+	tuner.lambda = *lambda
+
+	tuner.k = *k
+	if tuner.k == 0 {
+		tuner.k = tuner.computeK()
+	}
+
+	log.Printf("using k %.6f, initial error %.8f\n", tuner.k, tuner.error())
+
+	random := rand.New(rand.NewSource(*seed))
+	for epoch := 1; epoch <= *epochs; epoch++ {
+		start := time.Now()
+
+		// shuffle the positions so that the mini-batches
+		// aren't made up of positions from the same games
+		random.Shuffle(len(offsets), func(i, j int) {
+			offsets[i], offsets[j] = offsets[j], offsets[i]
+		})
+
+		for batch := 0; batch < len(offsets); batch += *batchSize {
+			tuner.step(offsets[batch:min(batch+*batchSize, len(offsets))], *rate)
+		}
+
+		log.Printf("epoch %4d: error %.8f [%s]\n", epoch, tuner.error(), time.Since(start).Round(time.Millisecond))
+
+		if epoch%*save == 0 || epoch == *epochs {
+			if err := writeWeights(*output, &tuner.weights); err != nil {
+				return err
+			}
+		}
+	}
+
+	return nil
+}
+
+// weights contains the mg and eg weight of every tuned term.
+type weights [classical.TraceN][2]float64
+
+// maxPhase is the game phase where only the mg weights are used.
+const maxPhase = float64(classical.MaxPhase)
+
+// Adam optimizer hyperparameters.
+const (
+	beta1   = 0.9
+	beta2   = 0.999
+	epsilon = 1e-8
+)
+
+// tuner tunes the evaluation's weights on a set of positions.
+type tuner struct {
+	data    []byte // feature file data
+	offsets []int  // offsets of the positions in the data
+
+	threads   int
+	gradients []weights // gradient of each thread
+
+	k      float64 // scaling of the evaluation's sigmoid
+	lambda float64 // weight of the results in the targets
+
+	weights weights
+
+	// adam state
+	moment   weights // first moment estimates
+	velocity weights // second moment estimates
+	steps    int
+}
+
+// newTuner creates a new tuner for the given positions, whose weights are
+// initialized with the current ones.
+func newTuner(data []byte, offsets []int, threads int) *tuner {
+	tuner := &tuner{
+		data:    data,
+		offsets: offsets,
+
+		threads:   threads,
+		gradients: make([]weights, threads),
+	}
+
+	for term, weight := range classical.Weights() {
+		tuner.weights[term] = [2]float64{float64(weight.MG()), float64(weight.EG())}
+	}
+
+	return tuner
+}
+
+// position returns the position at the given offset.
+func (tuner *tuner) position(offset int) position {
+	return position(tuner.data[offset:])
+}
+
+// evaluate returns the white relative evaluation of the given position
+// with the current weights.
+func (tuner *tuner) evaluate(p position) float64 {
+	mg, eg := p.nonlinear()
+	for n := 0; n < p.count(); n++ {
+		term, coefficient := p.feature(n)
+		mg += tuner.weights[term][0] * coefficient
+		eg += tuner.weights[term][1] * coefficient
+	}
+
+	phase := p.phase()
+	return (mg*phase + eg*(maxPhase-phase)) / maxPhase
+}
+
+// sigmoid converts the given evaluation into a win probability.
+func (tuner *tuner) sigmoid(evaluation float64) float64 {
+	return 1 / (1 + math.Exp(-tuner.k*evaluation/400))
+}
+
+// target returns the win probability the given position is trained on.
+func (tuner *tuner) target(p position) float64 {
+	return tuner.lambda*p.result() + (1-tuner.lambda)*tuner.sigmoid(p.score())
+}
+
+// parallel calls the given function for every thread, with the range of
+// the given positions it is responsible for, and waits for them.
+func (tuner *tuner) parallel(offsets []int, fn func(thread int, offsets []int)) {
+	var wg sync.WaitGroup
+
+	chunk := (len(offsets) + tuner.threads - 1) / tuner.threads
+	for thread := 0; thread < tuner.threads; thread++ {
+		start, end := min(thread*chunk, len(offsets)), min((thread+1)*chunk, len(offsets))
+
+		wg.Add(1)
+		go func(thread int) {
+			defer wg.Done()
+			fn(thread, offsets[start:end])
+		}(thread)
+	}
+
+	wg.Wait()
+}
+
+// error returns the mean squared error of the current weights.
+func (tuner *tuner) error() float64 {
+	sums := make([]float64, tuner.threads)
+
+	tuner.parallel(tuner.offsets, func(thread int, offsets []int) {
+		for _, offset := range offsets {
+			p := tuner.position(offset)
+			delta := tuner.sigmoid(tuner.evaluate(p)) - tuner.target(p)
+			sums[thread] += delta * delta
+		}
+	})
+
+	total := 0.0
+	for _, sum := range sums {
+		total += sum
+	}
+
+	return total / float64(len(tuner.offsets))
+}
+
+// computeK finds the sigmoid scaling which minimizes the error of the
+// current weights, with a golden section search. The targets depend on
+// the scaling too, so it's searched with the results as the targets.
+func (tuner *tuner) computeK() float64 {
+	lambda := tuner.lambda
+	defer func() { tuner.lambda = lambda }()
+	tuner.lambda = 1
+
+	errorAt := func(k float64) float64 {
+		tuner.k = k
+		return tuner.error()
+	}
+
+	ratio := (math.Sqrt(5) - 1) / 2
+
+	low, high := 0.0, 10.0
+	a, b := high-ratio*(high-low), low+ratio*(high-low)
+	errA, errB := errorAt(a), errorAt(b)
+
+	for high-low > 1e-4 {
+		if errA < errB {
+			high, b, errB = b, a, errA
+			a = high - ratio*(high-low)
+			errA = errorAt(a)
+		} else {
+			low, a, errA = a, b, errB
+			b = low + ratio*(high-low)
+			errB = errorAt(b)
+		}
+	}
+
+	return (low + high) / 2
+}
+
+// step performs a single step of the optimizer on the given batch.
+func (tuner *tuner) step(batch []int, rate float64) {
+	tuner.parallel(batch, func(thread int, offsets []int) {
+		gradient := &tuner.gradients[thread]
+		*gradient = weights{}
+
+		for _, offset := range offsets {
+			p := tuner.position(offset)
+
+			// derivative of the squared error wrt the evaluation
+			s := tuner.sigmoid(tuner.evaluate(p))
+			delta := 2 * (s - tuner.target(p)) * s * (1 - s) * tuner.k / 400
+
+			phase := p.phase()
+			mg := delta * phase / maxPhase
+			eg := delta * (maxPhase - phase) / maxPhase
+
+			for n := 0; n < p.count(); n++ {
+				term, coefficient := p.feature(n)
+				gradient[term][0] += mg * coefficient
+				gradient[term][1] += eg * coefficient
+			}
+		}
+	})
+
+	var gradient weights
+	for thread := range tuner.gradients {
+		for term := range gradient {
+			gradient[term][0] += tuner.gradients[thread][term][0]
+			gradient[term][1] += tuner.gradients[thread][term][1]
+		}
+	}
+
+	// tempo isn't tapered, so it's mg and eg weights are tied
+	tempo := gradient[classical.TraceTempo][0] + gradient[classical.TraceTempo][1]
+	gradient[classical.TraceTempo] = [2]float64{tempo, tempo}
+
+	tuner.steps++
+	correction1 := 1 - math.Pow(beta1, float64(tuner.steps))
+	correction2 := 1 - math.Pow(beta2, float64(tuner.steps))
+
+	scale := 1 / float64(len(batch))
+	for term := range gradient {
+		for i := range gradient[term] {
+			g := gradient[term][i] * scale
+
+			tuner.moment[term][i] = beta1*tuner.moment[term][i] + (1-beta1)*g
+			tuner.velocity[term][i] = beta2*tuner.velocity[term][i] + (1-beta2)*g*g
+
+			moment := tuner.moment[term][i] / correction1
+			velocity := tuner.velocity[term][i] / correction2
+			tuner.weights[term][i] -= rate * moment / (math.Sqrt(velocity) + epsilon)
+		}
+	}
+}